@@ -8,10 +8,27 @@
 // Parameterized by the number of points per side N of a cubic N³ mesh.
 // Number of teams = N², points per line = N, stride = N² (slowest axis).
 // Reports time/iteration and effective memory bandwidth.
+//
+// BM_block_matvec_batched runs the same operator with the line-batched kernel
+// (range(1) = lines per batch), where each vector lane evaluates one line.
+//
+// BM_block_matvec_dir compares the two kernels per direction: range(1) is the
+// direction (0 = x, stride N²; 1 = y, stride N; 2 = z, stride 1) and range(2) the
+// lines per batch, with 0 meaning the line kernel.  block_kernel::batched stays
+// opt-in until it wins here on the machine in question.
+//
+// BM_block_graph_node_interior runs the x-axis block as a graph node on a large
+// mesh, the way the derivative submits it.  range(1) = 1 uses the fixed width
+// interior kernels and 0 rewrites every line's kernel id to the generic loop,
+// which is the code path before the fixed width kernels existed.
+//
+// BM_block_matvec_width swaps in a synthetic interior stencil of width range(1).
+// Widths 3/5/7/9 use the fixed width kernels and 11 the generic fallback.
 
 #include <benchmark/benchmark.h>
 
 #include <Kokkos_Core.hpp>
+#include <Kokkos_Graph.hpp>
 
 #include "matrices/block.hpp"
 #include "matrices/circulant.hpp"
@@ -19,6 +36,7 @@
 #include "matrices/inner_block.hpp"
 #include "types.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -31,16 +49,48 @@ namespace
 constexpr int stencil_width = 5;
 constexpr int boundary_rows = 2; // dense rows per boundary
 
-// Build a block matrix that mimics one axis of a 3D derivative operator
-// on an N x N x N mesh with stride = N² (differencing along the slowest axis).
-matrix::block build_block(int N)
+matrix::block build_block(int N,
+                          int bnd_rows,
+                          const std::vector<real>& int_c,
+                          const std::vector<real>& left_c,
+                          const std::vector<real>& right_c,
+                          int dir = 0)
 {
     const int N2 = N * N;
     const int n_lines = N2;
     const int pts_per_line = N;
-    const int interior_rows = pts_per_line - 2 * boundary_rows;
-    const int stride = N2;
+    const int interior_rows = pts_per_line - 2 * bnd_rows;
+    // z is the contiguous axis of an (x, y, z) field
+    const int stride = dir == 0 ? N2 : dir == 1 ? N : 1;
+    const int bnd_cols = static_cast<int>(left_c.size()) / bnd_rows;
+
+    std::vector<matrix::inner_block> blocks;
+    blocks.reserve(n_lines);
+
+    for (int line = 0; line < n_lines; ++line) {
+        // first element of this line in the flat array, lines ordered with the
+        // remaining fast index innermost so neighbouring lines can be batched
+        const int a = line / N, c = line % N;
+        const int row_offset = dir == 0 ? line : dir == 1 ? a * N2 + c : line * N;
+        const int col_offset = row_offset;
+
+        blocks.emplace_back(
+            static_cast<integer>(pts_per_line),
+            static_cast<integer>(row_offset),
+            static_cast<integer>(col_offset),
+            static_cast<integer>(stride),
+            matrix::dense{bnd_rows, bnd_cols, left_c},
+            matrix::circulant{interior_rows, int_c},
+            matrix::dense{bnd_rows, bnd_cols, right_c});
+    }
+
+    return matrix::block{std::move(blocks)};
+}
 
+// Build a block matrix that mimics axis `dir` of a 3D derivative operator on an
+// N x N x N mesh.
+matrix::block build_axis_block(int N, int dir)
+{
     // 4th-order interior stencil coefficients
     const std::vector<real> int_c{
         1.0 / 12.0, -2.0 / 3.0, 0.0, 2.0 / 3.0, -1.0 / 12.0};
@@ -55,33 +105,29 @@ matrix::block build_block(int N)
         -1.0 / 12.0, 1.0 / 2.0, -3.0 / 2.0, 5.0 / 6.0, 1.0 / 4.0,
         1.0 / 4.0, -4.0 / 3.0, 3.0, -4.0, 25.0 / 12.0};
 
-    std::vector<matrix::inner_block> blocks;
-    blocks.reserve(n_lines);
+    return build_block(N, boundary_rows, int_c, left_c, right_c, dir);
+}
 
-    for (int line = 0; line < n_lines; ++line) {
-        const int row_offset = line; // first element of this line in the flat array
-        const int col_offset = row_offset;
+// The x axis: stride = N² (differencing along the slowest axis).
+matrix::block build_block(int N) { return build_axis_block(N, 0); }
 
-        blocks.emplace_back(
-            static_cast<integer>(pts_per_line),
-            static_cast<integer>(row_offset),
-            static_cast<integer>(col_offset),
-            static_cast<integer>(stride),
-            matrix::dense{boundary_rows, stencil_width, left_c},
-            matrix::circulant{interior_rows, int_c},
-            matrix::dense{boundary_rows, stencil_width, right_c});
-    }
+// Same layout with a synthetic interior stencil of the given width.  Only the
+// shape matters for timing, so the coefficients are arbitrary.
+matrix::block build_block(int N, int width)
+{
+    const int rows = std::max(boundary_rows, width / 2);
+    std::vector<real> int_c(width), left_c(rows * width), right_c(rows * width);
+    for (int j = 0; j < width; ++j) int_c[j] = (j - width / 2) / real(width);
+    for (int j = 0; j < rows * width; ++j) left_c[j] = right_c[j] = 1.0 / (1 + j);
 
-    return matrix::block{std::move(blocks)};
+    return build_block(N, rows, int_c, left_c, right_c);
 }
 
-void BM_block_matvec(benchmark::State& state)
+void run_block_matvec(benchmark::State& state, const matrix::block& A)
 {
     const auto N = static_cast<int>(state.range(0));
     const auto total = static_cast<std::size_t>(N) * N * N;
 
-    const auto A = build_block(N);
-
     std::vector<real> x(total);
     std::vector<real> b(total, 0.0);
 
@@ -111,6 +157,21 @@ void BM_block_matvec(benchmark::State& state)
         benchmark::Counter::kIs1024);
     state.counters["points"] = n_points;
     state.counters["lines"] = static_cast<double>(N) * N;
+    state.counters["coeff_bytes"] = static_cast<double>(A.coefficient_report().bytes());
+}
+
+void BM_block_matvec(benchmark::State& state)
+{
+    const auto A = build_block(static_cast<int>(state.range(0)));
+    run_block_matvec(state, A);
+}
+
+void BM_block_matvec_batched(benchmark::State& state)
+{
+    auto A = build_block(static_cast<int>(state.range(0)));
+    A.kernel(matrix::block_kernel::batched, static_cast<int>(state.range(1)));
+    run_block_matvec(state, A);
+    state.counters["batches"] = A.num_batches();
 }
 
 BENCHMARK(BM_block_matvec)
@@ -119,6 +180,80 @@ BENCHMARK(BM_block_matvec)
     ->Arg(64)
     ->Unit(benchmark::kMillisecond);
 
+void BM_block_matvec_width(benchmark::State& state)
+{
+    const auto A = build_block(static_cast<int>(state.range(0)),
+                               static_cast<int>(state.range(1)));
+    run_block_matvec(state, A);
+    state.counters["width"] = static_cast<double>(state.range(1));
+}
+
+BENCHMARK(BM_block_matvec_batched)
+    ->ArgsProduct({{16, 32, 64}, {4, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_block_matvec_width)
+    ->ArgsProduct({{32, 64}, {3, 5, 7, 9, 11}})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_block_matvec_dir(benchmark::State& state)
+{
+    const auto lanes = static_cast<int>(state.range(2));
+    auto A = build_axis_block(static_cast<int>(state.range(0)),
+                              static_cast<int>(state.range(1)));
+    if (lanes > 0) A.kernel(matrix::block_kernel::batched, lanes);
+    run_block_matvec(state, A);
+    state.counters["dir"] = static_cast<double>(state.range(1));
+    state.counters["batches"] = lanes > 0 ? A.num_batches() : 0;
+}
+
+BENCHMARK(BM_block_matvec_dir)
+    ->ArgsProduct({{32, 64, 128}, {0, 1, 2}, {0, 4, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_block_graph_node_interior(benchmark::State& state)
+{
+    const auto N = static_cast<int>(state.range(0));
+    const bool fixed = state.range(1) != 0;
+    const auto total = static_cast<std::size_t>(N) * N * N;
+
+    const auto A = build_block(N);
+    if (!fixed) {
+        // meta_d lives in host-accessible memory_space
+        const auto meta = A.metadata_view();
+        for (std::size_t i = 0; i < meta.extent(0); ++i)
+            meta(i).interior_kernel = matrix::stencil_kernel::generic;
+    }
+
+    std::vector<real> x(total);
+    std::vector<real> b(total, 0.0);
+    for (std::size_t i = 0; i < total; ++i)
+        x[i] = std::sin(2.0 * M_PI * static_cast<real>(i) / static_cast<real>(total));
+
+    auto graph = Kokkos::Experimental::create_graph<execution_space>(
+        [&](auto root) { A.graph_node(root, x.data(), b.data()); });
+    graph.instantiate();
+    graph.submit();
+    Kokkos::fence();
+
+    for (auto _ : state) {
+        graph.submit();
+        Kokkos::fence();
+    }
+
+    const auto n_points = static_cast<double>(total);
+    state.counters["BW(GB/s)"] = benchmark::Counter(
+        n_points * (stencil_width + 1) * sizeof(real),
+        benchmark::Counter::kIsIterationInvariantRate,
+        benchmark::Counter::kIs1024);
+    state.counters["points"] = n_points;
+    state.counters["fixed_width"] = fixed;
+}
+
+BENCHMARK(BM_block_graph_node_interior)
+    ->ArgsProduct({{128, 192}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace
 
 // Custom main: Kokkos must be initialized before any Kokkos calls.
@@ -7,6 +7,9 @@
 // Parameterized by mesh size (N³ cubic grid) and stencil order (E2, E4).
 // No embedded objects — pure Cartesian grid with Floating BCs on all faces.
 // Reports time/iteration and effective memory bandwidth.
+//
+// BM_derivative_modes compares the strided and pencil-transposed block matvec
+// (derivative_mode) along the strided axes.
 
 #include <benchmark/benchmark.h>
 
@@ -115,6 +118,49 @@ BENCHMARK(BM_derivative_apply)
     ->Args({64, 4})
     ->Unit(benchmark::kMillisecond);
 
+// Strided vs pencil-transposed block matvec along one axis.
+// range(0) = mesh size, range(1) = axis, range(2) = 0 strided / 1 pencil.
+void BM_derivative_modes(benchmark::State& state)
+{
+    const auto N = static_cast<int>(state.range(0));
+    const auto dir = static_cast<int>(state.range(1));
+    const auto mode = state.range(2) ? derivative_mode::pencil : derivative_mode::strided;
+    const auto total = static_cast<std::size_t>(N) * N * N;
+
+    auto m = mesh{index_extents{int3{N, N, N}},
+                  domain_extents{.min = {0.0, 0.0, 0.0}, .max = {1.0, 1.0, 1.0}}};
+
+    const auto gridBcs = bcs::Grid{bcs::ff, bcs::ff, bcs::ff};
+    const auto objectBcs = bcs::Object{};
+
+    auto d = derivative{dir, m, stencils::second::E4, gridBcs, objectBcs};
+    d.mode(mode);
+
+    auto u = make_scalar(m);
+    auto du = make_scalar(m);
+    for (std::size_t i = 0; i < total; ++i)
+        u.d_vec[i] = std::sin(2.0 * M_PI * static_cast<real>(i) /
+                               static_cast<real>(total));
+
+    d(u, du);
+    Kokkos::fence();
+
+    for (auto _ : state) {
+        d(u, du);
+        Kokkos::fence();
+    }
+
+    state.counters["points"] = static_cast<double>(total);
+    state.counters["pencil"] = static_cast<double>(d.mode() == derivative_mode::pencil);
+    state.counters["preferred"] = static_cast<double>(
+        derivative::preferred_mode(dir, m.extents()) == derivative_mode::pencil);
+}
+
+// Parameterize: {mesh_size, axis, mode}.
+BENCHMARK(BM_derivative_modes)
+    ->ArgsProduct({{32, 64, 128}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace
 
 // Custom main: Kokkos must be initialized before any Kokkos calls.
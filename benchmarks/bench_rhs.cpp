@@ -6,6 +6,7 @@
 // relevant for regression tracking.
 //
 // Parameterized by mesh size (N³ cubic grid) with E2 stencil and Dirichlet BCs.
+// BM_heat_rhs_fused repeats it with simulation.laplacian.kernel = "fused".
 // Uses Gaussian MMS (thread-safe, pre-evaluated into member buffers before the
 // timed loop, so MMS cost is setup-only).
 
@@ -28,8 +29,8 @@ namespace
 
 // Build a heat system from Lua for a cubic N³ mesh with Gaussian MMS.
 // Dirichlet BCs on xmin/xmax, Floating on the rest — exercises the full
-// graph path including source scatter and BC fill.
-systems::heat build_heat(int N)
+// graph path including source scatter and BC fill.  `kernel` is the laplacian kernel.
+systems::heat build_heat(int N, const std::string& kernel)
 {
     sol::state lua;
     lua.open_libraries(sol::lib::base, sol::lib::math);
@@ -58,6 +59,9 @@ systems::heat build_heat(int N)
                 type = "heat",
                 diffusivity = 0.1
             },
+            laplacian = {
+                kernel = ")" + kernel + R"("
+            },
             manufactured_solution = {
                 type = "gaussian",
                 {
@@ -77,12 +81,12 @@ systems::heat build_heat(int N)
     return std::move(*opt);
 }
 
-void BM_heat_rhs(benchmark::State& state)
+void run_heat_rhs(benchmark::State& state, const std::string& kernel)
 {
     const auto N = static_cast<int>(state.range(0));
     const auto total = static_cast<std::size_t>(N) * N * N;
 
-    auto heat = build_heat(N);
+    auto heat = build_heat(N, kernel);
     auto sz = heat.size();
 
     // Allocate registry with 2 slots: u0 (input) and du (output).
@@ -108,10 +112,10 @@ void BM_heat_rhs(benchmark::State& state)
     heat.build_rhs_graph(u, du);
 
     // Warm up.
-    heat.submit_rhs_graph();
+    heat.submit_rhs_graph(u, du);
 
     for (auto _ : state) {
-        heat.submit_rhs_graph();
+        heat.submit_rhs_graph(u, du);
     }
 
     // Effective bandwidth estimate.
@@ -132,12 +136,23 @@ void BM_heat_rhs(benchmark::State& state)
     state.counters["points"] = n_points;
 }
 
+void BM_heat_rhs(benchmark::State& state) { run_heat_rhs(state, "sweep"); }
+
+// Same RHS with the laplacian evaluated by two fused kernels
+void BM_heat_rhs_fused(benchmark::State& state) { run_heat_rhs(state, "fused"); }
+
 BENCHMARK(BM_heat_rhs)
     ->Arg(16)
     ->Arg(32)
     ->Arg(64)
     ->Unit(benchmark::kMillisecond);
 
+BENCHMARK(BM_heat_rhs_fused)
+    ->Arg(16)
+    ->Arg(32)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace
 
 // Custom main: Kokkos must be initialized before any Kokkos calls.
@@ -0,0 +1,182 @@
+// Benchmark: operator construction
+//
+// Times the assembly of the x, y and z derivatives on a cut-cell mesh, the startup
+// cost paid before the first step.  The derivatives are built one at a time
+// (derivative{dir, ...}) or together with derivative::xyz, which discretizes the
+// lines and cut points of all three directions in one parallel pass, or with xyz
+// reading a warm operator_cache, which skips the discretization.  A full
+// laplacian construction (three derivatives plus the tiled kernel setup) is timed
+// as well.
+//
+// Parameterized by mesh size (N³ cubic grid), the number of spheres and the mode
+// (0 = one at a time, 1 = xyz, 2 = xyz from a warm operator cache).
+//
+// BM_csr_to_csr isolates csr::builder::to_csr on random points, about 8 per row,
+// against the comparison sort of the whole point list it replaced (mode 0 = sort,
+// 1 = counting sort), for builders with 1 or 16 parts.
+
+#include <benchmark/benchmark.h>
+
+#include <Kokkos_Core.hpp>
+
+#include "mesh/mesh.hpp"
+#include "mesh/shapes.hpp"
+#include "operators/derivative.hpp"
+#include "operators/laplacian.hpp"
+#include "matrices/csr.hpp"
+#include "operators/operator_cache.hpp"
+#include "stencils/stencil.hpp"
+#include "types.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace ccs;
+
+namespace
+{
+
+// Up to 8 non-overlapping spheres, one per octant of the unit cube.
+std::vector<shape> make_spheres(int n)
+{
+    std::vector<shape> shapes;
+    for (int i = 0; i < n; ++i) {
+        const real3 center{
+            (i & 1) ? 0.72 : 0.28, (i & 2) ? 0.71 : 0.29, (i & 4) ? 0.73 : 0.27};
+        shapes.push_back(make_sphere(i, center, 0.17));
+    }
+    return shapes;
+}
+
+mesh make_mesh(int N, int n_spheres)
+{
+    return mesh{index_extents{int3{N, N, N}},
+                domain_extents{.min = {0.0, 0.0, 0.0}, .max = {1.0, 1.0, 1.0}},
+                make_spheres(n_spheres)};
+}
+
+void BM_derivative_assembly(benchmark::State& state)
+{
+    const auto N = static_cast<int>(state.range(0));
+    const auto n_spheres = static_cast<int>(state.range(1));
+    const auto mode = state.range(2);
+
+    const auto m = make_mesh(N, n_spheres);
+    const auto gridBcs = bcs::Grid{bcs::dd, bcs::dd, bcs::dd};
+    const auto objectBcs = bcs::Object(n_spheres, bcs::Floating);
+
+    const auto dir = std::filesystem::temp_directory_path() / "shoccs_bench_startup";
+    const auto cache = mode == 2 ? operator_cache{dir.string()} : operator_cache{};
+    if (cache) derivative::xyz(m, stencils::second::E4, gridBcs, objectBcs, {}, cache);
+
+    for (auto _ : state) {
+        if (mode > 0) {
+            auto d =
+                derivative::xyz(m, stencils::second::E4, gridBcs, objectBcs, {}, cache);
+            benchmark::DoNotOptimize(d);
+        } else {
+            for (int dir = 0; dir < 3; ++dir) {
+                auto d = derivative{dir, m, stencils::second::E4, gridBcs, objectBcs};
+                benchmark::DoNotOptimize(d);
+            }
+        }
+    }
+
+    state.counters["points"] = static_cast<double>(m.size());
+    state.counters["boundary_points"] =
+        static_cast<double>(m.Rx().size() + m.Ry().size() + m.Rz().size());
+
+    if (cache) std::filesystem::remove_all(dir);
+}
+
+void BM_laplacian_construction(benchmark::State& state)
+{
+    const auto N = static_cast<int>(state.range(0));
+    const auto n_spheres = static_cast<int>(state.range(1));
+
+    const auto m = make_mesh(N, n_spheres);
+    const auto gridBcs = bcs::Grid{bcs::dd, bcs::dd, bcs::dd};
+    const auto objectBcs = bcs::Object(n_spheres, bcs::Floating);
+
+    for (auto _ : state) {
+        auto lap = laplacian{m, stencils::second::E4, gridBcs, objectBcs};
+        benchmark::DoNotOptimize(lap);
+    }
+
+    state.counters["points"] = static_cast<double>(m.size());
+}
+
+// The former to_csr: one comparison sort of every point, then the row offsets.
+matrix::csr sort_to_csr(std::span<const matrix::csr::builder> parts, integer nrows)
+{
+    std::vector<matrix::csr::builder::pts> p;
+    for (const auto& b : parts) p.insert(p.end(), b.p.begin(), b.p.end());
+    std::ranges::sort(p);
+
+    std::vector<integer> u(nrows + 1);
+    std::vector<real> w;
+    std::vector<integer> v;
+    w.reserve(p.size());
+    v.reserve(p.size());
+    for (const auto& pt : p) {
+        ++u[pt.row + 1];
+        w.push_back(pt.v);
+        v.push_back(pt.col);
+    }
+    std::partial_sum(u.begin(), u.end(), u.begin());
+    return matrix::csr{w, v, u};
+}
+
+void BM_csr_to_csr(benchmark::State& state)
+{
+    const auto n = state.range(0);
+    const auto n_parts = static_cast<int>(state.range(1));
+    const bool counting = state.range(2);
+    const integer nrows = n / 8;
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<integer> row(0, nrows - 1);
+    std::uniform_int_distribution<integer> col(0, 64 * nrows);
+    std::uniform_real_distribution<real> val(-1, 1);
+    auto b = matrix::csr::parallel_builder{n_parts};
+    for (integer i = 0; i < n; ++i)
+        b.add_point(static_cast<int>(i % n_parts), row(rng), col(rng), val(rng));
+
+    for (auto _ : state) {
+        auto A = counting ? b.to_csr(nrows) : sort_to_csr(b.parts, nrows);
+        benchmark::DoNotOptimize(A);
+    }
+
+    state.counters["points/s"] = benchmark::Counter(
+        static_cast<double>(n), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Parameterize: {mesh_size, spheres, mode}.
+BENCHMARK(BM_derivative_assembly)
+    ->ArgsProduct({{32, 64, 96}, {1, 8}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+// Parameterize: {mesh_size, spheres}.
+BENCHMARK(BM_laplacian_construction)
+    ->ArgsProduct({{32, 64, 96}, {1, 8}})
+    ->Unit(benchmark::kMillisecond);
+
+// Parameterize: {points, parts, mode}.
+BENCHMARK(BM_csr_to_csr)
+    ->ArgsProduct({{1 << 16, 1 << 20, 1 << 22}, {1, 16}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+// Custom main: Kokkos must be initialized before any Kokkos calls.
+int main(int argc, char** argv)
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -6,6 +6,8 @@
 // Owns a flat array of Kokkos::View<real*> organized by slot and buffer index.
 // Each slot holds up to MaxS scalar fields (4 buffers each) and MaxV vector
 // fields (12 buffers each), following the layout defined by field_layout<MaxS,MaxV>.
+// Buffers are either allocated one at a time (allocate_scalar/allocate_vector) or
+// carved from a single arena shared by one or more slots (allocate_arena).
 //
 // Handles (scalar_handle, vector_handle, buf_handle) index into this storage.
 // field_ref is a lightweight 12-byte token that identifies a slot and its
@@ -20,10 +22,16 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <span>
 #include <string>
 #include <utility>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 namespace ccs
 {
 
@@ -54,6 +62,15 @@ struct field_ref {
 static_assert(std::is_trivially_copyable_v<field_ref>);
 static_assert(sizeof(field_ref) == 12);
 
+// ---------------------------------------------------------------------------
+// arena_options: how allocate_arena backs its allocation.
+// ---------------------------------------------------------------------------
+
+struct arena_options {
+    // Ask for transparent huge pages (madvise; ignored outside Linux).
+    bool huge_pages = false;
+};
+
 // ---------------------------------------------------------------------------
 // field_registry: flat Kokkos::View storage indexed by handles.
 // ---------------------------------------------------------------------------
@@ -75,6 +92,7 @@ public:
         assert(slot >= 0 && slot < MaxSlots);
         assert(scalar_index >= 0 && scalar_index < MaxS);
         assert(scalar_index == metadata_[slot].n_scalars);
+        assert(arenas_[slot].extent(0) == 0 && "arena slots are allocated whole");
 
         // Construct handle via direct arithmetic (cannot use consteval factory
         // with runtime index).
@@ -102,6 +120,7 @@ public:
         assert(slot >= 0 && slot < MaxSlots);
         assert(vector_index >= 0 && vector_index < MaxV);
         assert(vector_index == metadata_[slot].n_vectors);
+        assert(arenas_[slot].extent(0) == 0 && "arena slots are allocated whole");
 
         vector_handle vh{layout_type::vector_base +
                          vector_index * layout_type::vector_stride};
@@ -130,8 +149,101 @@ public:
         return metadata_[slot];
     }
 
+    // Allocate nscalars scalars and nvectors vectors of the given sizes in each of
+    // `slots` from one allocation.  Every buffer starts on an arena_alignment
+    // boundary and is padded to a multiple of it, the buffers of a slot follow each
+    // other in handle order and the slots follow each other in the order given, so a
+    // slot is one contiguous range (see slot_arena).  The memory is first touched in
+    // parallel with the RangePolicy of the slot kernels, one launch over each slot's
+    // range, so on a NUMA node each page lands next to the thread that later works
+    // on it.  The slots must be empty.  Returns the refs in the order of `slots`.
+    template <std::size_t N>
+    std::array<field_ref, N> allocate_arena(const std::array<int, N>& slots,
+                                            const system_size& sz,
+                                            arena_options opts = {})
+    {
+        allocate_arena(std::span<const int>{slots}, sz, opts);
+        std::array<field_ref, N> refs{};
+        for (std::size_t k = 0; k < N; ++k) refs[k] = metadata_[slots[k]];
+        return refs;
+    }
+
+    // As above, for a number of slots known at run time; the refs are then available
+    // through ref().
+    void allocate_arena(std::span<const int> slots,
+                        const system_size& sz,
+                        arena_options opts = {})
+    {
+        const auto N = slots.size();
+        assert(sz.nscalars <= MaxS && sz.nvectors <= MaxV);
+        constexpr integer align = arena_alignment / sizeof(real);
+        auto padded = [](integer n) { return (n + align - 1) / align * align; };
+
+        const std::array<integer, 4> sizes{sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size};
+        integer field_size = 0;
+        for (auto n : sizes) field_size += padded(n);
+        const integer slot_size = (sz.nscalars + 3 * sz.nvectors) * field_size;
+
+        // over-allocate so the first buffer can start on an aligned address
+        const integer lead =
+            (opts.huge_pages ? huge_page_size : arena_alignment) / sizeof(real);
+        Kokkos::View<real*> arena(
+            Kokkos::view_alloc("arena", Kokkos::WithoutInitializing),
+            N * slot_size + lead);
+        integer offset = aligned_offset(arena.data(), lead * sizeof(real));
+        if (opts.huge_pages) advise_huge_pages(arena.data() + offset, N * slot_size);
+
+        for (std::size_t k = 0; k < N; ++k) {
+            const int slot = slots[k];
+            assert(slot >= 0 && slot < MaxSlots);
+            assert(metadata_[slot].n_scalars == 0 && metadata_[slot].n_vectors == 0);
+
+            const int base = slot * buffers_per_slot;
+            arenas_[slot] =
+                Kokkos::subview(arena, Kokkos::make_pair(offset, offset + slot_size));
+
+            // the same flat range detail::for_each_slot_element sweeps
+            real* p = arena.data() + offset;
+            Kokkos::parallel_for("field_registry::first_touch",
+                                 Kokkos::RangePolicy<execution_space>(0, slot_size),
+                                 KOKKOS_LAMBDA(integer i) { p[i] = 0.0; });
+
+            auto carve = [&](buf_handle bh, int b) {
+                const integer n = sizes[b];
+                buffers_[base + bh.id] =
+                    Kokkos::subview(arena, Kokkos::make_pair(offset, offset + n));
+                offset += padded(n);
+            };
+
+            for (int s = 0; s < sz.nscalars; ++s) {
+                scalar_handle sh{s * layout_type::scalar_stride};
+                auto bufs = sh.all();
+                for (int b = 0; b < 4; ++b) carve(bufs[b], b);
+            }
+            for (int v = 0; v < sz.nvectors; ++v) {
+                vector_handle vh{layout_type::vector_base +
+                                 v * layout_type::vector_stride};
+                for (auto c : vh.components()) {
+                    auto bufs = c.all();
+                    for (int b = 0; b < 4; ++b) carve(bufs[b], b);
+                }
+            }
+
+            metadata_[slot] = field_ref{
+                slot, static_cast<int>(sz.nscalars), static_cast<int>(sz.nvectors)};
+        }
+        Kokkos::fence("field_registry::allocate_arena first touch");
+    }
+
     // -- Access --------------------------------------------------------------
 
+    // the current ref of a slot ({slot, 0, 0} if nothing is allocated in it)
+    field_ref ref(int slot) const
+    {
+        assert(slot >= 0 && slot < MaxSlots);
+        return {slot, metadata_[slot].n_scalars, metadata_[slot].n_vectors};
+    }
+
     Kokkos::View<real*>& view(field_ref ref, buf_handle h)
     {
         assert(ref.slot >= 0 && ref.slot < MaxSlots);
@@ -167,6 +279,16 @@ public:
         return static_cast<int>(view(ref, h).extent(0));
     }
 
+    // The contiguous range holding every buffer of an arena-allocated slot, padding
+    // included, or an empty View for slots allocated buffer by buffer.  Slots
+    // allocated with the same system_size share a layout, so an element-wise
+    // operation over several of them can run as one sweep of these ranges.
+    const Kokkos::View<real*>& slot_arena(field_ref ref) const
+    {
+        assert(ref.slot >= 0 && ref.slot < MaxSlots);
+        return arenas_[ref.slot];
+    }
+
     // -- Bulk operations -----------------------------------------------------
 
     void deep_copy_slot(int dst, int src)
@@ -199,6 +321,7 @@ public:
         for (int i = 0; i < buffers_per_slot; ++i) {
             std::swap(buffers_[a_base + i], buffers_[b_base + i]);
         }
+        std::swap(arenas_[a], arenas_[b]);
 
         // Swap metadata and fix slot indices.
         std::swap(metadata_[a], metadata_[b]);
@@ -206,9 +329,39 @@ public:
         metadata_[b].slot = b;
     }
 
+    // alignment of arena buffers in bytes: a cache line, and a full AVX-512 vector
+    static constexpr std::size_t arena_alignment = 64;
+    // transparent huge page size on x86-64 and most aarch64 kernels
+    static constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
 private:
+    // number of reals to skip from p to the next multiple of `alignment` bytes
+    static integer aligned_offset(const real* p, std::size_t alignment)
+    {
+        const auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return static_cast<integer>(((alignment - addr % alignment) % alignment) /
+                                    sizeof(real));
+    }
+
+    // Best effort: the kernel may ignore the advice or have THP disabled.  Only the
+    // whole huge pages inside [p, p + n) are advised.
+    static void advise_huge_pages([[maybe_unused]] real* p, [[maybe_unused]] integer n)
+    {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        auto* first = reinterpret_cast<char*>(p);
+        auto* last = first + n * sizeof(real);
+        const auto begin = reinterpret_cast<std::uintptr_t>(first);
+        auto* start = first + (huge_page_size - begin % huge_page_size) % huge_page_size;
+        if (last - start >= static_cast<std::ptrdiff_t>(huge_page_size)) {
+            const auto len = (last - start) / huge_page_size * huge_page_size;
+            madvise(start, len, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
     static constexpr int total_views_ = MaxSlots * buffers_per_slot;
     std::array<Kokkos::View<real*>, total_views_> buffers_{};
+    std::array<Kokkos::View<real*>, MaxSlots> arenas_{};
     std::array<field_ref, MaxSlots> metadata_{};
 };
 
@@ -238,6 +391,17 @@ scalar_view extract_scalar_view(const field_registry<MaxSlots, MaxS, MaxV>& reg,
     return scalar_view{sp(h.D()), sp(h.Rx()), sp(h.Ry()), sp(h.Rz())};
 }
 
+// The x, y and z components of a vector field, in that order.
+template <int MaxSlots, int MaxS, int MaxV>
+std::array<scalar_view, 3>
+extract_vector_view(const field_registry<MaxSlots, MaxS, MaxV>& reg,
+                    field_ref ref, vector_handle h)
+{
+    return {extract_scalar_view(reg, ref, h.x()),
+            extract_scalar_view(reg, ref, h.y()),
+            extract_scalar_view(reg, ref, h.z())};
+}
+
 // ---------------------------------------------------------------------------
 // Simulation-chain registry: the single concrete type used by systems,
 // integrators, and simulation_cycle.
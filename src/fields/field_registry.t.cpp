@@ -2,7 +2,11 @@
 #include "handle.hpp"
 #include "scalar.hpp"
 
+#include <array>
+#include <cstdint>
 #include <functional>
+#include <span>
+#include <vector>
 
 #include <Kokkos_Core.hpp>
 #include <catch2/catch_session.hpp>
@@ -312,6 +316,111 @@ TEST_CASE("swap_slots swaps extents and data")
     }
 }
 
+// ---------------------------------------------------------------------------
+// allocate_arena
+// ---------------------------------------------------------------------------
+
+TEST_CASE("allocate_arena carves aligned buffers from one allocation")
+{
+    using reg_type = field_registry<4, 2, 1>;
+    reg_type reg;
+    constexpr auto layout = field_layout<2, 1>{};
+    const auto sz = system_size{.nscalars = 2,
+                                .nvectors = 1,
+                                .d_size = 100,
+                                .rx_size = 5,
+                                .ry_size = 3,
+                                .rz_size = 0};
+
+    auto [a, b] = reg.allocate_arena(std::array{2, 0}, sz);
+
+    auto aligned = [](const real* p) {
+        return reinterpret_cast<std::uintptr_t>(p) % reg_type::arena_alignment == 0;
+    };
+
+    // every allocated buffer of a slot, in handle order
+    auto buffers = [&](field_ref ref) {
+        std::vector<buf_handle> h;
+        for (int s = 0; s < ref.n_scalars; ++s)
+            for (auto bh : scalar_handle{s * layout.scalar_stride}.all()) h.push_back(bh);
+        for (int v = 0; v < ref.n_vectors; ++v)
+            for (auto c : vector_handle{layout.vector_base + v * layout.vector_stride}
+                              .components())
+                for (auto bh : c.all()) h.push_back(bh);
+        return h;
+    };
+
+    SECTION("refs follow the order of the slots")
+    {
+        REQUIRE(a == field_ref{.slot = 2, .n_scalars = 2, .n_vectors = 1});
+        REQUIRE(b == field_ref{.slot = 0, .n_scalars = 2, .n_vectors = 1});
+    }
+
+    SECTION("buffers are sized, aligned, zeroed and packed in handle order")
+    {
+        for (auto ref : {a, b}) {
+            const auto& arena = reg.slot_arena(ref);
+            REQUIRE(aligned(arena.data()));
+
+            const real* next = arena.data();
+            for (auto bh : buffers(ref)) {
+                const int n = reg.size(ref, bh);
+                REQUIRE(n == std::array{100, 5, 3, 0}[bh.id % 4]);
+                REQUIRE(reg.data(ref, bh) == next);
+                REQUIRE(aligned(reg.data(ref, bh)));
+                for (int i = 0; i < n; ++i) REQUIRE(reg.data(ref, bh)[i] == 0.0);
+                next += (n + 7) / 8 * 8;
+            }
+            REQUIRE(next == arena.data() + arena.extent(0));
+        }
+    }
+
+    SECTION("slots are contiguous in the order given")
+    {
+        REQUIRE(reg.slot_arena(b).data() ==
+                reg.slot_arena(a).data() + reg.slot_arena(a).extent(0));
+        REQUIRE(reg.slot_arena(field_ref{.slot = 1}).extent(0) == 0);
+    }
+
+    SECTION("swap_slots and deep_copy_slot work on arena slots")
+    {
+        auto sh = scalar_handle{layout.scalar_stride};
+        reg.view(a, sh.D())(7) = 3.0;
+        const real* arena_a = reg.slot_arena(a).data();
+
+        reg.deep_copy_slot(0, 2);
+        REQUIRE(reg.view(b, sh.D())(7) == 3.0);
+
+        reg.view(b, sh.D())(7) = 4.0;
+        reg.swap_slots(0, 2);
+        REQUIRE(reg.view(a, sh.D())(7) == 4.0);
+        REQUIRE(reg.view(b, sh.D())(7) == 3.0);
+        REQUIRE(reg.slot_arena(b).data() == arena_a);
+    }
+
+    SECTION("the span overload fills the refs read back through ref")
+    {
+        reg_type r;
+        const std::vector<int> slots{3, 1};
+        r.allocate_arena(std::span<const int>{slots}, sz);
+        REQUIRE(r.ref(3) == field_ref{.slot = 3, .n_scalars = 2, .n_vectors = 1});
+        REQUIRE(r.ref(1) == field_ref{.slot = 1, .n_scalars = 2, .n_vectors = 1});
+        REQUIRE(r.ref(0) == field_ref{.slot = 0});
+        REQUIRE(r.slot_arena(r.ref(1)).data() ==
+                r.slot_arena(r.ref(3)).data() + r.slot_arena(r.ref(3)).extent(0));
+    }
+
+    SECTION("huge pages only change the placement")
+    {
+        reg_type h;
+        auto [c] = h.allocate_arena(std::array{1}, sz, arena_options{.huge_pages = true});
+        REQUIRE(reinterpret_cast<std::uintptr_t>(h.slot_arena(c).data()) %
+                    reg_type::huge_page_size ==
+                0);
+        REQUIRE(h.slot_arena(c).extent(0) == reg.slot_arena(a).extent(0));
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Span bridge: extract_scalar_span
 // ---------------------------------------------------------------------------
@@ -378,6 +487,27 @@ TEST_CASE("extract_scalar_view returns const spans from const registry")
     }
 }
 
+TEST_CASE("extract_vector_view returns the x, y and z components")
+{
+    field_registry<4, 2, 1> reg;
+    constexpr auto layout = field_layout<2, 1>{};
+    auto vh = vector_handle{layout.vector_base + 0 * layout.vector_stride};
+
+    auto ref = reg.allocate_vector(0, 0, 100, 5, 3, 2);
+
+    const auto& creg = reg;
+    auto vv = extract_vector_view(creg, ref, vh);
+
+    auto comps = vh.components();
+    for (int c = 0; c < 3; ++c) {
+        REQUIRE(vv[c].D.data() == creg.data(ref, comps[c].D()));
+        REQUIRE(vv[c].Rx.data() == creg.data(ref, comps[c].Rx()));
+        REQUIRE(vv[c].Ry.data() == creg.data(ref, comps[c].Ry()));
+        REQUIRE(vv[c].Rz.data() == creg.data(ref, comps[c].Rz()));
+        REQUIRE(static_cast<int>(vv[c].Rz.size()) == 2);
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Span bridge: write-through
 // ---------------------------------------------------------------------------
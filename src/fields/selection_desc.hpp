@@ -196,6 +196,18 @@ void plus_assign_selected(real* dst, Desc desc, Expr expr)
         });
 }
 
+// Scatter a compact buffer: dst[desc.element(i)] = src[i].  Pairs with evaluations
+// that produce values for the selected elements only.  Fences before returning:
+// src is typically a temporary the caller reuses or frees right after the call.
+template <typename Desc>
+void scatter_selected(real* dst, Desc desc, const real* src)
+{
+    Kokkos::parallel_for(
+        Kokkos::RangePolicy<execution_space>(0, desc.count()),
+        KOKKOS_LAMBDA(int i) { dst[desc.element(i)] = src[i]; });
+    Kokkos::fence("scatter_selected complete");
+}
+
 // ---------------------------------------------------------------------------
 // Grid BC descriptor helper: iterates over 6 mesh faces, calling fn(desc)
 // for each face whose BC type matches B.
@@ -438,6 +438,68 @@ TEST_CASE("plus_assign_selected with gather_selection")
     REQUIRE(h(9) == 100.0);
 }
 
+TEST_CASE("scatter_selected with strided_selection")
+{
+    // Elements 1,2, 7,8, 13,14 receive the compact buffer in order
+    constexpr int N = 20;
+    Kokkos::View<real*, memory_space> dst("dst", N);
+    Kokkos::View<real*, memory_space> src("src", 6);
+
+    Kokkos::deep_copy(dst, -1.0);
+    Kokkos::parallel_for(
+        Kokkos::RangePolicy<execution_space>(0, 6),
+        KOKKOS_LAMBDA(int i) { src(i) = 400.0 + i; });
+
+    strided_selection sel{1, 2, 3, 6};
+    scatter_selected(dst.data(), sel, src.data());
+
+    auto h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, dst);
+    REQUIRE(h(1) == 400.0);
+    REQUIRE(h(2) == 401.0);
+    REQUIRE(h(7) == 402.0);
+    REQUIRE(h(8) == 403.0);
+    REQUIRE(h(13) == 404.0);
+    REQUIRE(h(14) == 405.0);
+    // Untouched
+    REQUIRE(h(0) == -1.0);
+    REQUIRE(h(3) == -1.0);
+    REQUIRE(h(12) == -1.0);
+    REQUIRE(h(15) == -1.0);
+}
+
+TEST_CASE("scatter_selected with gather_selection")
+{
+    constexpr int N = 10;
+    Kokkos::View<real*, memory_space> dst("dst", N);
+    Kokkos::View<real*, memory_space> src("src", 3);
+
+    Kokkos::deep_copy(dst, -1.0);
+    auto hsrc = Kokkos::create_mirror_view(src);
+    hsrc(0) = 10.0;
+    hsrc(1) = 20.0;
+    hsrc(2) = 30.0;
+    Kokkos::deep_copy(src, hsrc);
+
+    Kokkos::View<int*, memory_space> idx("idx", 3);
+    auto hidx = Kokkos::create_mirror_view(idx);
+    hidx(0) = 8;
+    hidx(1) = 2;
+    hidx(2) = 5;
+    Kokkos::deep_copy(idx, hidx);
+
+    gather_selection sel{idx};
+    scatter_selected(dst.data(), sel, src.data());
+
+    auto h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, dst);
+    REQUIRE(h(8) == 10.0);
+    REQUIRE(h(2) == 20.0);
+    REQUIRE(h(5) == 30.0);
+    // Untouched
+    REQUIRE(h(0) == -1.0);
+    REQUIRE(h(3) == -1.0);
+    REQUIRE(h(9) == -1.0);
+}
+
 // ---------------------------------------------------------------------------
 // 11.2a — scalar_literal_expr as expression argument
 // ---------------------------------------------------------------------------
@@ -1,18 +1,53 @@
 #pragma once
 
+#include "coefficient_pool.hpp"
 #include "inner_block.hpp"
 #include "inner_block_meta.hpp"
+#include "multi_vector.hpp"
+#include "precision.hpp"
 
 #include "kokkos_types.hpp"
 
 #include <Kokkos_Graph.hpp>
 #include <Kokkos_Profiling_ScopedRegion.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <concepts>
 
 namespace ccs::matrix
 {
+// Kernel used by block::operator() and block::graph_node.
+//   line    - one team per line, stencil reduction over the vector lanes
+//   batched - neighbouring lines with identical shape/coefficients are grouped and
+//             each vector lane evaluates the same stencil row for a different line
+enum class block_kernel { line, batched };
+
+// Launch configuration of the block matvecs.  A team_size of 0 leaves the team size
+// to Kokkos (Kokkos::AUTO).  `lanes` is the maximum number of lines grouped into one
+// batch by block_kernel::batched.  See block_tuner.hpp for choosing these at runtime.
+struct block_launch {
+    block_kernel kernel = block_kernel::line;
+    int team_size = 0;
+    int vector_len = 8;
+    int lanes = 8;
+
+    bool operator==(const block_launch&) const = default;
+};
+
+// Summary of the coefficient storage built by block::build_device_arrays.  Without
+// deduplication every line would store its own left/interior/right sets.
+struct coefficient_stats {
+    integer lines;
+    integer sets;         // non-empty coefficient sets across all lines
+    integer unique_sets;  // distinct sets actually stored
+    integer coefficients; // coefficients that would be stored without deduplication
+    integer stored;       // coefficients held in coeffs_d
+
+    std::size_t bytes() const { return stored * sizeof(real); }
+    std::size_t bytes_saved() const { return (coefficients - stored) * sizeof(real); }
+};
+
 // Block matrix arising from method-of-lines discretization over whole domain.
 // Due to the requirements of a cut-cell mesh, the InnerBlocks may not be adjacent to
 // eachother.  To simplify construction, a builder class is exposed which computes all
@@ -23,9 +58,20 @@ class block
 
     // Device-accessible arrays for the future TeamPolicy kernel (17c.5).
     // meta_d: one inner_block_meta per line.
-    // coeffs_d: all left/circulant/right coefficients concatenated.
+    // coeffs_d: the distinct left/circulant/right coefficient sets concatenated.
     device_view<inner_block_meta*> meta_d;
     device_view<real*> coeffs_d;
+    coefficient_stats stats{};
+
+    // coeffs_d rounded to float, allocated while the precision is fp32
+    device_view<float*> coeffs_f;
+    storage_precision precision_ = storage_precision::fp64;
+
+    // Line groups for the batched kernel (built on demand by launch()), for batches of
+    // at most batch_lanes lines.
+    device_view<line_batch_meta*> batch_d;
+    int batch_lanes = 0;
+    block_launch launch_{};
 
     void build_device_arrays()
     {
@@ -33,8 +79,9 @@ class block
 
         const int n = static_cast<int>(blocks.size());
 
-        // First pass: compute total coefficient count and populate host metadata.
-        int total_coeffs = 0;
+        // Populate host metadata.  Coefficient sets are hash-consed so lines sharing
+        // a closure or interior stencil point at a single copy in coeffs_d.
+        coefficient_pool pool;
         std::vector<inner_block_meta> host_meta(n);
         for (int i = 0; i < n; ++i) {
             const auto& ib = blocks[i];
@@ -48,49 +95,128 @@ class block
             m.stride = ib.stride();
             m.left_rows = L.rows();
             m.left_cols = L.columns();
-            m.left_coeff_offset = total_coeffs;
-            total_coeffs += L.size();
+            m.left_coeff_offset = pool.insert(L.data());
             m.interior_rows = C.rows();
-            m.interior_coeff_offset = total_coeffs;
+            m.interior_coeff_offset = pool.insert(C.data());
             m.stencil_width = C.size();
-            total_coeffs += C.size();
+            m.interior_kernel = select_stencil_kernel(C.size());
             m.right_rows = R.rows();
             m.right_cols = R.columns();
-            m.right_coeff_offset = total_coeffs;
+            m.right_coeff_offset = pool.insert(R.data());
             m.right_col_offset = R.col_offset();
-            total_coeffs += R.size();
         }
 
-        // Allocate device views.
+        stats = coefficient_stats{.lines = n,
+                                  .sets = pool.sets(),
+                                  .unique_sets = pool.unique_sets(),
+                                  .coefficients = pool.requested(),
+                                  .stored = pool.size()};
+
+        // Allocate device views and copy.
         meta_d = device_view<inner_block_meta*>("block_meta", n);
-        coeffs_d = device_view<real*>("block_coeffs", total_coeffs);
+        coeffs_d = device_view<real*>("block_coeffs", pool.size());
 
-        // Copy metadata to device.
         auto h_meta = Kokkos::View<const inner_block_meta*, Kokkos::HostSpace,
                                    Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
             host_meta.data(), n);
         Kokkos::deep_copy(meta_d, h_meta);
 
-        // Second pass: copy coefficients into a contiguous host buffer, then to device.
-        std::vector<real> host_coeffs(total_coeffs);
-        for (int i = 0; i < n; ++i) {
-            const auto& ib = blocks[i];
-            const auto& m = host_meta[i];
+        auto h_coeffs = Kokkos::View<const real*, Kokkos::HostSpace,
+                                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+            pool.data().data(), pool.size());
+        Kokkos::deep_copy(coeffs_d, h_coeffs);
+    }
 
-            auto lc = ib.left().data();
-            std::copy(lc.begin(), lc.end(), host_coeffs.begin() + m.left_coeff_offset);
+    // Two lines can share a batch when their shape and coefficients match.  The
+    // offsets are checked separately since they must shift by a common amount.
+    bool same_shape(int i, int j) const
+    {
+        const auto& a = blocks[i];
+        const auto& b = blocks[j];
+        return a.stride() == b.stride() && a.left().rows() == b.left().rows() &&
+               a.left().columns() == b.left().columns() &&
+               a.interior_circ().rows() == b.interior_circ().rows() &&
+               a.right().rows() == b.right().rows() &&
+               a.right().columns() == b.right().columns() &&
+               std::ranges::equal(a.left().data(), b.left().data()) &&
+               std::ranges::equal(a.interior_circ().data(), b.interior_circ().data()) &&
+               std::ranges::equal(a.right().data(), b.right().data());
+    }
+
+    // Greedily group consecutive lines into batches of at most `lanes` lines.
+    // Lines within a batch must be offset from the leader by a constant amount
+    // (1 for the fast index, giving contiguous loads across lanes).
+    void build_batches(int lanes)
+    {
+        assert(lanes > 0);
+        const int n = static_cast<int>(blocks.size());
+        std::vector<line_batch_meta> host_batches;
+        host_batches.reserve(n / lanes + 1);
+
+        auto shift = [this](int i, int j) {
+            const auto& a = blocks[i];
+            const auto& b = blocks[j];
+            const integer d = b.row_offset() - a.row_offset();
+            const bool uniform =
+                b.col_offset() - a.col_offset() == d &&
+                b.right().col_offset() - a.right().col_offset() == d;
+            return uniform ? d : integer{0};
+        };
+
+        int i = 0;
+        while (i < n) {
+            line_batch_meta lb{i, 1, 0};
+            if (i + 1 < n && same_shape(i, i + 1)) {
+                const integer d = shift(i, i + 1);
+                if (d > 0) {
+                    lb.lane_offset = static_cast<int>(d);
+                    while (lb.lines < lanes && i + lb.lines < n &&
+                           same_shape(i, i + lb.lines) &&
+                           shift(i, i + lb.lines) == d * lb.lines)
+                        ++lb.lines;
+                }
+            }
+            host_batches.push_back(lb);
+            i += lb.lines;
+        }
 
-            auto cc = ib.interior_circ().data();
-            std::copy(cc.begin(), cc.end(), host_coeffs.begin() + m.interior_coeff_offset);
+        const int nb = static_cast<int>(host_batches.size());
+        batch_lanes = lanes;
+        batch_d = device_view<line_batch_meta*>("block_batches", nb);
+        auto h_batches = Kokkos::View<const line_batch_meta*, Kokkos::HostSpace,
+                                      Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+            host_batches.data(), nb);
+        Kokkos::deep_copy(batch_d, h_batches);
+    }
 
-            auto rc = ib.right().data();
-            std::copy(rc.begin(), rc.end(), host_coeffs.begin() + m.right_coeff_offset);
+    // Launch the single-vector kernel selected by launch_ for the types of P
+    template <typename P, typename Op>
+    void launch_kernel(const device_view<typename P::coefficient_type*>& coeffs,
+                       const typename P::field_type* x_ptr,
+                       typename P::field_type* b_ptr,
+                       Op op) const
+    {
+        if (launch_.kernel == block_kernel::batched) {
+            Kokkos::parallel_for(team_policy(num_batches()),
+                                 batched_matvec_functor<Op, P>{
+                                     meta_d, batch_d, coeffs, x_ptr, b_ptr, op});
+        } else {
+            Kokkos::parallel_for(
+                team_policy(num_lines()),
+                matvec_functor<Op, P>{meta_d, coeffs, x_ptr, b_ptr, op});
         }
+    }
 
-        auto h_coeffs = Kokkos::View<const real*, Kokkos::HostSpace,
-                                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
-            host_coeffs.data(), total_coeffs);
-        Kokkos::deep_copy(coeffs_d, h_coeffs);
+    template <typename X, typename Op>
+    void apply(const X* x_ptr, X* b_ptr, Op op) const
+    {
+        Kokkos::Profiling::ScopedRegion region("block::operator()");
+        if (num_lines() == 0) return;
+
+        if (precision_ == storage_precision::fp32)
+            launch_kernel<precision_policy<float, X>>(coeffs_f, x_ptr, b_ptr, op);
+        else
+            launch_kernel<precision_policy<real, X>>(coeffs_d, x_ptr, b_ptr, op);
     }
 
 public:
@@ -109,17 +235,106 @@ public:
         return b.row_offset() + b.rows() * b.stride();
     }
 
+    // Copy of this block with every line stored contiguously: an offset o becomes
+    // map(o) and the stride becomes 1.  `map` must be affine along each line, as the
+    // pencil_layout orderings are.  The launch configuration is kept.
+    template <typename F>
+    block relaid(F&& map) const
+    {
+        std::vector<inner_block> b;
+        b.reserve(blocks.size());
+        for (auto&& ib : blocks) {
+            const auto& L = ib.left();
+            const auto& C = ib.interior_circ();
+            const auto& R = ib.right();
+            b.emplace_back(ib.columns(),
+                           map(ib.row_offset()),
+                           map(ib.col_offset()),
+                           1,
+                           dense{L.rows(), L.columns(), L.data(), L.flags()},
+                           circulant{C.rows(), C.data()},
+                           dense{R.rows(), R.columns(), R.data(), R.flags()});
+        }
+        block res{MOVE(b)};
+        res.launch(launch_);
+        res.precision(precision_);
+        return res;
+    }
+
     const device_view<inner_block_meta*>& metadata_view() const { return meta_d; }
     const device_view<real*>& coefficients_view() const { return coeffs_d; }
+    const coefficient_stats& coefficient_report() const { return stats; }
     int num_lines() const { return static_cast<int>(blocks.size()); }
+    int num_batches() const { return static_cast<int>(batch_d.extent(0)); }
+    const device_view<line_batch_meta*>& batch_view() const { return batch_d; }
+
+    // Select the launch configuration used by operator() and graph_node.
+    void launch(const block_launch& l)
+    {
+        assert(l.team_size >= 0 && l.vector_len > 0 && l.lanes > 0);
+        launch_ = l;
+        if (l.kernel == block_kernel::batched && !blocks.empty() && l.lanes != batch_lanes)
+            build_batches(l.lanes);
+    }
+    const block_launch& launch() const { return launch_; }
+
+    // Select the storage precision of the coefficients read by operator() and
+    // graph_node.  fp32 keeps a float copy of the coefficients next to the fp64 ones,
+    // which the multi-vector kernel and the analysis visitors continue to use.
+    void precision(storage_precision p)
+    {
+        precision_ = p;
+        if (p == storage_precision::fp64) {
+            coeffs_f = device_view<float*>{};
+            return;
+        }
+        if (blocks.empty() || coeffs_f.is_allocated()) return;
+
+        auto h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, coeffs_d);
+        std::vector<float> hf(h.extent(0));
+        for (std::size_t i = 0; i < hf.size(); ++i) hf[i] = static_cast<float>(h(i));
+
+        coeffs_f = device_view<float*>("block_coeffs_fp32", hf.size());
+        auto h_coeffs = Kokkos::View<const float*, Kokkos::HostSpace,
+                                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+            hf.data(), hf.size());
+        Kokkos::deep_copy(coeffs_f, h_coeffs);
+    }
+    storage_precision precision() const { return precision_; }
+    const device_view<float*>& coefficients_fp32_view() const { return coeffs_f; }
+
+    // Select the matvec kernel.  For block_kernel::batched, `lanes` is the maximum
+    // number of lines evaluated together (typically the SIMD width in doubles).
+    void kernel(block_kernel k, int lanes = 8)
+    {
+        auto l = launch_;
+        l.kernel = k;
+        l.lanes = lanes;
+        launch(l);
+    }
+    block_kernel kernel() const { return launch_.kernel; }
+
+    // Team policy for `league` teams under the current launch configuration
+    Kokkos::TeamPolicy<execution_space> team_policy(integer league) const
+    {
+        using policy = Kokkos::TeamPolicy<execution_space>;
+        return launch_.team_size > 0
+                   ? policy(league, launch_.team_size, launch_.vector_len)
+                   : policy(league, Kokkos::AUTO, launch_.vector_len);
+    }
 
     // Named functor for the block matvec kernel, shared by operator() and graph_node.
-    template <typename Op>
+    // P (a precision_policy) sets the coefficient and field storage types.
+    template <typename Op, typename P = fp64_policy>
     struct matvec_functor {
+        using C = typename P::coefficient_type;
+        using X = typename P::field_type;
+        using A = typename P::accumulate_type;
+
         device_view<inner_block_meta*> meta;
-        device_view<real*> coeffs;
-        const real* x_ptr;
-        real* b_ptr;
+        device_view<C*> coeffs;
+        const X* x_ptr;
+        X* b_ptr;
         Op op;
 
         using team_policy = Kokkos::TeamPolicy<execution_space>;
@@ -129,83 +344,295 @@ public:
         void operator()(const member_type& team) const
         {
             const auto m = meta(team.league_rank());
+
+            if (m.interior_kernel == stencil_kernel::generic) {
+                const int total_rows = m.left_rows + m.interior_rows + m.right_rows;
+                Kokkos::parallel_for(Kokkos::TeamThreadRange(team, total_rows),
+                                     [&](int local_row) { row(team, m, local_row); });
+                return;
+            }
+
+            // Fixed width interior: the boundary rows keep the dense reductions while
+            // the interior rows are spread over the threads and vector lanes.
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team, m.left_rows + m.right_rows),
+                [&](int r) {
+                    row(team, m, r < m.left_rows ? r : r + m.interior_rows);
+                });
+
+            switch (m.interior_kernel) {
+            case stencil_kernel::w3:
+                interior<3>(team, m);
+                break;
+            case stencil_kernel::w5:
+                interior<5>(team, m);
+                break;
+            case stencil_kernel::w7:
+                interior<7>(team, m);
+                break;
+            case stencil_kernel::w9:
+                interior<9>(team, m);
+                break;
+            default:
+                break;
+            }
+        }
+
+        template <int W>
+        KOKKOS_INLINE_FUNCTION void interior(const member_type& team,
+                                             const inner_block_meta& m) const
+        {
+            C c[W];
+            for (int j = 0; j < W; ++j) c[j] = coeffs(m.interior_coeff_offset + j);
+
+            const int first = m.row_offset + m.left_rows * m.stride;
+            const int st = m.stride;
+            Kokkos::parallel_for(
+                Kokkos::TeamVectorRange(team, m.interior_rows), [&](int r) {
+                    const int out_idx = first + r * st;
+                    const X* x = x_ptr + out_idx - (W / 2) * st;
+                    op(b_ptr[out_idx], fixed_dot<W>(c, x, st));
+                });
+        }
+
+        KOKKOS_INLINE_FUNCTION
+        void row(const member_type& team, const inner_block_meta& m, int local_row) const
+        {
+            int out_idx;
+            A dot = 0;
+
+            if (local_row < m.left_rows) {
+                // Dense left boundary
+                int r = local_row;
+                out_idx = m.row_offset + r * m.stride;
+                Kokkos::parallel_reduce(
+                    Kokkos::ThreadVectorRange(team, m.left_cols),
+                    [&](int j, A& s) {
+                        s += A(coeffs(m.left_coeff_offset + r * m.left_cols + j))
+                             * x_ptr[m.col_offset + j * m.stride];
+                    }, dot);
+            } else if (local_row < m.left_rows + m.interior_rows) {
+                // Circulant interior
+                int r = local_row - m.left_rows;
+                out_idx = m.row_offset + (m.left_rows + r) * m.stride;
+                const int half_w = m.stencil_width / 2;
+                Kokkos::parallel_reduce(
+                    Kokkos::ThreadVectorRange(team, m.stencil_width),
+                    [&](int j, A& s) {
+                        s += A(coeffs(m.interior_coeff_offset + j))
+                             * x_ptr[out_idx + (j - half_w) * m.stride];
+                    }, dot);
+            } else {
+                // Dense right boundary
+                int r = local_row - m.left_rows - m.interior_rows;
+                out_idx = m.row_offset + (m.left_rows + m.interior_rows + r) * m.stride;
+                Kokkos::parallel_reduce(
+                    Kokkos::ThreadVectorRange(team, m.right_cols),
+                    [&](int j, A& s) {
+                        s += A(coeffs(m.right_coeff_offset + r * m.right_cols + j))
+                             * x_ptr[m.right_col_offset + j * m.stride];
+                    }, dot);
+            }
+
+            Kokkos::single(Kokkos::PerThread(team), [&]() { op(b_ptr[out_idx], dot); });
+        }
+    };
+
+    // Named functor for the line-batched kernel: one team per line_batch_meta.
+    // Each team thread owns one output row of the leader line and the vector lanes
+    // evaluate that row for every line in the batch.  Coefficients are shared by
+    // the batch, so they are loaded once per row rather than once per line.
+    template <typename Op, typename P = fp64_policy>
+    struct batched_matvec_functor {
+        using C = typename P::coefficient_type;
+        using X = typename P::field_type;
+
+        device_view<inner_block_meta*> meta;
+        device_view<line_batch_meta*> batches;
+        device_view<C*> coeffs;
+        const X* x_ptr;
+        X* b_ptr;
+        Op op;
+
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        using member_type = typename team_policy::member_type;
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            const auto lb = batches(team.league_rank());
+            const auto m = meta(lb.first_line);
             const int total_rows = m.left_rows + m.interior_rows + m.right_rows;
+            const C* c_ptr = coeffs.data();
 
             Kokkos::parallel_for(
                 Kokkos::TeamThreadRange(team, total_rows),
                 [&](int local_row) {
                     int out_idx;
-                    real dot = 0;
+                    int in_idx;
+                    int width;
+                    stencil_kernel k = stencil_kernel::generic;
+                    const C* c;
 
                     if (local_row < m.left_rows) {
-                        // Dense left boundary
-                        int r = local_row;
+                        const int r = local_row;
                         out_idx = m.row_offset + r * m.stride;
-                        Kokkos::parallel_reduce(
-                            Kokkos::ThreadVectorRange(team, m.left_cols),
-                            [&](int j, real& s) {
-                                s += coeffs(m.left_coeff_offset + r * m.left_cols + j)
-                                     * x_ptr[m.col_offset + j * m.stride];
-                            }, dot);
+                        in_idx = m.col_offset;
+                        width = m.left_cols;
+                        c = c_ptr + m.left_coeff_offset + r * m.left_cols;
                     } else if (local_row < m.left_rows + m.interior_rows) {
-                        // Circulant interior
-                        int r = local_row - m.left_rows;
-                        out_idx = m.row_offset + (m.left_rows + r) * m.stride;
-                        const int half_w = m.stencil_width / 2;
-                        Kokkos::parallel_reduce(
-                            Kokkos::ThreadVectorRange(team, m.stencil_width),
-                            [&](int j, real& s) {
-                                s += coeffs(m.interior_coeff_offset + j)
-                                     * x_ptr[out_idx + (j - half_w) * m.stride];
-                            }, dot);
+                        out_idx = m.row_offset + local_row * m.stride;
+                        in_idx = out_idx - (m.stencil_width / 2) * m.stride;
+                        width = m.stencil_width;
+                        k = m.interior_kernel;
+                        c = c_ptr + m.interior_coeff_offset;
                     } else {
-                        // Dense right boundary
-                        int r = local_row - m.left_rows - m.interior_rows;
-                        out_idx = m.row_offset + (m.left_rows + m.interior_rows + r) * m.stride;
-                        Kokkos::parallel_reduce(
-                            Kokkos::ThreadVectorRange(team, m.right_cols),
-                            [&](int j, real& s) {
-                                s += coeffs(m.right_coeff_offset + r * m.right_cols + j)
-                                     * x_ptr[m.right_col_offset + j * m.stride];
-                            }, dot);
+                        const int r = local_row - m.left_rows - m.interior_rows;
+                        out_idx = m.row_offset + local_row * m.stride;
+                        in_idx = m.right_col_offset;
+                        width = m.right_cols;
+                        c = c_ptr + m.right_coeff_offset + r * m.right_cols;
                     }
 
-                    Kokkos::single(Kokkos::PerThread(team), [&]() {
-                        op(b_ptr[out_idx], dot);
-                    });
+                    Kokkos::parallel_for(
+                        Kokkos::ThreadVectorRange(team, lb.lines),
+                        [&](int lane) {
+                            const int shift = lane * lb.lane_offset;
+                            const X* x = x_ptr + in_idx + shift;
+                            op(b_ptr[out_idx + shift],
+                               stencil_dot(k, c, x, m.stride, width));
+                        });
                 });
         }
     };
 
+    // Named functor for the multi-vector kernel: one team per line and one vector lane
+    // per row.  Each lane walks the row's coefficients once and applies every one to
+    // all k inputs, so coefficient loads are shared by the k fields.
+    template <typename Op>
+    struct multi_matvec_functor {
+        device_view<inner_block_meta*> meta;
+        device_view<real*> coeffs;
+        multi_vector v;
+        Op op;
+
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        using member_type = typename team_policy::member_type;
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            const auto m = meta(team.league_rank());
+            const int total_rows = m.left_rows + m.interior_rows + m.right_rows;
+            const real* c_ptr = coeffs.data();
+
+            Kokkos::parallel_for(
+                Kokkos::TeamVectorRange(team, total_rows), [&](int local_row) {
+                    const auto e = locate_row(m, local_row);
+                    const real* c = c_ptr + e.coeff_offset;
+
+                    real dot[max_vectors] = {};
+                    for (int j = 0; j < e.width; ++j) {
+                        const real w = c[j];
+                        const int col = e.in_idx + j * m.stride;
+                        for (int f = 0; f < v.k; ++f) dot[f] += w * v.x[f][col];
+                    }
+                    for (int f = 0; f < v.k; ++f) op(v.b[f][e.out_idx], dot[f]);
+                });
+        }
+    };
+
+    // Graph nodes need a single kernel type regardless of the selected kernel and
+    // coefficient precision.
+    template <typename Op>
+    struct kernel_functor {
+        matvec_functor<Op> line;
+        batched_matvec_functor<Op> batched;
+        matvec_functor<Op, fp32_coefficients> line_fp32;
+        batched_matvec_functor<Op, fp32_coefficients> batched_fp32;
+        bool use_batched;
+        bool use_fp32;
+
+        using member_type = typename matvec_functor<Op>::member_type;
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            if (use_fp32) {
+                if (use_batched)
+                    batched_fp32(team);
+                else
+                    line_fp32(team);
+            } else if (use_batched)
+                batched(team);
+            else
+                line(team);
+        }
+    };
+
     template <typename Op = eq_t>
     void operator()(std::span<const real> x, std::span<real> b, Op op = {}) const
+    {
+        apply(x.data(), b.data(), op);
+    }
+
+    // Apply the block to fields stored in float (fp32_storage when the coefficient
+    // precision is fp32).  The products are still accumulated in real.
+    template <typename Op = eq_t>
+    void operator()(std::span<const float> x, std::span<float> b, Op op = {}) const
+    {
+        apply(x.data(), b.data(), op);
+    }
+
+    // Apply the block to v.k input/output pairs in one launch (block_kernel is not
+    // consulted: lines are never batched across fields).  Always fp64 coefficients.
+    template <typename Op = eq_t>
+    void operator()(const multi_vector& v, Op op = {}) const
     {
         Kokkos::Profiling::ScopedRegion region("block::operator()");
         const auto n = num_lines();
-        if (n == 0) return;
-
-        constexpr int vector_len = 8;
-        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        if (n == 0 || v.k == 0) return;
+        assert(v.k <= max_vectors);
 
-        Kokkos::parallel_for(
-            team_policy(n, Kokkos::AUTO, vector_len),
-            matvec_functor<Op>{meta_d, coeffs_d, x.data(), b.data(), op});
+        Kokkos::parallel_for(team_policy(n),
+                             multi_matvec_functor<Op>{meta_d, coeffs_d, v, op});
     }
 
     // Chain a TeamPolicy graph node that performs the block matvec with the given op.
-    // For empty blocks (0 lines), the node executes zero teams.
+    // For empty blocks (0 lines) or disabled nodes, the node executes zero teams.
     template <typename NodeType, typename Op = eq_t>
-    auto graph_node(NodeType parent, const real* x_ptr, real* b_ptr, Op op = {}) const
+    auto graph_node(NodeType parent,
+                    const real* x_ptr,
+                    real* b_ptr,
+                    Op op = {},
+                    bool enabled = true) const
     {
-        const auto n = num_lines();
-
-        constexpr int vector_len = 8;
-        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        const bool batched = launch_.kernel == block_kernel::batched;
+        const bool fp32 = precision_ == storage_precision::fp32;
+        const auto n = !enabled ? 0 : batched ? num_batches() : num_lines();
 
         return parent.then_parallel_for(
             "block_matvec",
-            team_policy(n, Kokkos::AUTO, vector_len),
-            matvec_functor<Op>{meta_d, coeffs_d, x_ptr, b_ptr, op});
+            team_policy(n),
+            kernel_functor<Op>{
+                matvec_functor<Op>{meta_d, coeffs_d, x_ptr, b_ptr, op},
+                batched_matvec_functor<Op>{meta_d, batch_d, coeffs_d, x_ptr, b_ptr, op},
+                matvec_functor<Op, fp32_coefficients>{meta_d, coeffs_f, x_ptr, b_ptr, op},
+                batched_matvec_functor<Op, fp32_coefficients>{
+                    meta_d, batch_d, coeffs_f, x_ptr, b_ptr, op},
+                batched,
+                fp32});
+    }
+
+    // Multi-vector graph node, see operator()(const multi_vector&, Op).
+    template <typename NodeType, typename Op = eq_t>
+    auto graph_node(NodeType parent, const multi_vector& v, Op op = {}) const
+    {
+        assert(v.k <= max_vectors);
+        return parent.then_parallel_for(
+            "block_multi_matvec",
+            team_policy(num_lines()),
+            multi_matvec_functor<Op>{meta_d, coeffs_d, v, op});
     }
 
     void visit(visitor& v) const
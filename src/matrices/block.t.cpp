@@ -282,6 +282,7 @@ TEST_CASE("device metadata arrays")
     Kokkos::deep_copy(h_meta, meta_view);
 
     // Expected coefficient sizes per inner_block: 20 (left) + 3 (circ) + 6 (right) = 29
+    // Both blocks share the same coefficients so they are stored once.
     const int coeffs_per_block = 20 + 3 + 6;
 
     SECTION("inner_block 0 metadata")
@@ -311,13 +312,13 @@ TEST_CASE("device metadata arrays")
         REQUIRE(m.stride == 1);
         REQUIRE(m.left_rows == 4);
         REQUIRE(m.left_cols == 5);
-        REQUIRE(m.left_coeff_offset == coeffs_per_block);
+        REQUIRE(m.left_coeff_offset == 0);
         REQUIRE(m.interior_rows == 10);
-        REQUIRE(m.interior_coeff_offset == coeffs_per_block + 20);
+        REQUIRE(m.interior_coeff_offset == 20);
         REQUIRE(m.stencil_width == 3);
         REQUIRE(m.right_rows == 2);
         REQUIRE(m.right_cols == 3);
-        REQUIRE(m.right_coeff_offset == coeffs_per_block + 23);
+        REQUIRE(m.right_coeff_offset == 23);
         // right_col_offset = 20 + 1*(16-3) = 33
         REQUIRE(m.right_col_offset == 33);
     }
@@ -325,9 +326,9 @@ TEST_CASE("device metadata arrays")
     SECTION("coefficient data")
     {
         const auto& coeffs_view = A.coefficients_view();
-        REQUIRE(coeffs_view.extent(0) == static_cast<std::size_t>(2 * coeffs_per_block));
+        REQUIRE(coeffs_view.extent(0) == static_cast<std::size_t>(coeffs_per_block));
 
-        std::vector<real> host_coeffs(2 * coeffs_per_block);
+        std::vector<real> host_coeffs(coeffs_per_block);
         auto h_coeffs = Kokkos::View<real*, Kokkos::HostSpace,
                                      Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
             host_coeffs.data(), host_coeffs.size());
@@ -344,10 +345,6 @@ TEST_CASE("device metadata arrays")
         // Check right coefficients for block 0
         for (int i = 0; i < 6; ++i)
             REQUIRE(host_coeffs[23 + i] == Catch::Approx(right_c[i]));
-
-        // Check left coefficients for block 1 (same data, offset by coeffs_per_block)
-        for (int i = 0; i < 20; ++i)
-            REQUIRE(host_coeffs[coeffs_per_block + i] == Catch::Approx(left_c[i]));
     }
 }
 
@@ -395,4 +392,299 @@ TEST_CASE("device metadata with stride")
     REQUIRE(host_meta[1].col_offset == 1);
     REQUIRE(host_meta[1].stride == 3);
     REQUIRE(host_meta[1].right_col_offset == 37);
-}
\ No newline at end of file
+}
+TEST_CASE("batched kernel matches line kernel")
+{
+    using T = std::vector<real>;
+
+    auto iota15 = std::views::iota(0, 15);
+    const T lc(iota15.begin(), iota15.end()); // 3x5 matrix
+    const T ic{-2, -1, 0, 1, 2};
+    auto iota6 = std::views::iota(1, 7);
+    const T rc(iota6.begin(), iota6.end()); // 2x3 matrix
+    const T rc_other{6, 5, 4, 3, 2, 1};
+
+    const integer columns = 15;
+
+    // Lines 0-2 share shape and coefficients and are offset by `columns` (batched
+    // together).  Line 3 has different right boundary coefficients and starts a new
+    // batch.
+    auto bld = matrix::block::builder(4);
+    for (integer line = 0; line < 3; ++line)
+        bld.add_inner_block(columns, line * columns, line * columns, 1,
+                            matrix::dense(3, 5, lc),
+                            matrix::circulant(10, ic),
+                            matrix::dense(2, 3, rc));
+    bld.add_inner_block(columns, 3 * columns, 3 * columns, 1,
+                        matrix::dense(3, 5, lc),
+                        matrix::circulant(10, ic),
+                        matrix::dense(2, 3, rc_other));
+    auto A = MOVE(bld).to_block();
+
+    T x(4 * columns);
+    std::generate(x.begin(), x.end(), g);
+
+    T b_line(x.size());
+    A(x, b_line);
+
+    A.kernel(matrix::block_kernel::batched, 4);
+    REQUIRE(A.kernel() == matrix::block_kernel::batched);
+    REQUIRE(A.num_batches() == 2);
+
+    std::vector<matrix::line_batch_meta> host_batches(2);
+    auto h_batches = Kokkos::View<matrix::line_batch_meta*, Kokkos::HostSpace,
+                                  Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        host_batches.data(), 2);
+    Kokkos::deep_copy(h_batches, A.batch_view());
+    REQUIRE(host_batches[0].first_line == 0);
+    REQUIRE(host_batches[0].lines == 3);
+    REQUIRE(host_batches[0].lane_offset == columns);
+    REQUIRE(host_batches[1].first_line == 3);
+    REQUIRE(host_batches[1].lines == 1);
+
+    T b_batched(x.size());
+    A(x, b_batched);
+    REQUIRE_THAT(b_batched, Approx(b_line));
+
+    // accumulation
+    A(x, b_batched, plus_eq);
+    T b_line2(x.size());
+    std::ranges::transform(b_line, b_line2.begin(), x2);
+    REQUIRE_THAT(b_batched, Approx(b_line2));
+
+    // lane limit splits the uniform lines into several batches
+    A.kernel(matrix::block_kernel::batched, 2);
+    REQUIRE(A.num_batches() == 3);
+    T b_two(x.size());
+    A(x, b_two);
+    REQUIRE_THAT(b_two, Approx(b_line));
+}
+
+TEST_CASE("fixed width interior kernels")
+{
+    using T = std::vector<real>;
+
+    randomize();
+    const integer lr = 5, lc = 7, nint = 10;
+    const integer columns = lr + nint + lr;
+
+    // 3/5/7/9 use the specialized kernels, 11 exercises the generic fallback
+    for (integer w : {3, 5, 7, 9, 11}) {
+        T left(lr * lc), right(lr * lc), ic(w);
+        std::generate(left.begin(), left.end(), g);
+        std::generate(right.begin(), right.end(), g);
+        std::generate(ic.begin(), ic.end(), g);
+
+        auto bld = matrix::block::builder(2);
+        for (integer line = 0; line < 2; ++line)
+            bld.add_inner_block(columns, line * columns, line * columns, 1,
+                                matrix::dense(lr, lc, left),
+                                matrix::circulant(nint, ic),
+                                matrix::dense(lr, lc, right));
+        auto A = MOVE(bld).to_block();
+
+        std::vector<matrix::inner_block_meta> host_meta(2);
+        auto h_meta = Kokkos::View<matrix::inner_block_meta*, Kokkos::HostSpace,
+                                   Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+            host_meta.data(), 2);
+        Kokkos::deep_copy(h_meta, A.metadata_view());
+        REQUIRE(host_meta[0].interior_kernel == matrix::select_stencil_kernel(w));
+        REQUIRE((w == 11) == (host_meta[1].interior_kernel ==
+                              matrix::stencil_kernel::generic));
+
+        T x(2 * columns);
+        std::generate(x.begin(), x.end(), g);
+
+        T expected(x.size());
+        for (integer line = 0; line < 2; ++line) {
+            const auto o = line * columns;
+            for (integer i = 0; i < lr; ++i)
+                for (integer j = 0; j < lc; ++j) {
+                    expected[o + i] += left[i * lc + j] * x[o + j];
+                    expected[o + lr + nint + i] +=
+                        right[i * lc + j] * x[o + columns - lc + j];
+                }
+            for (integer i = lr; i < lr + nint; ++i)
+                for (integer j = 0; j < w; ++j)
+                    expected[o + i] += ic[j] * x[o + i - w / 2 + j];
+        }
+
+        T b(x.size());
+        A(x, b);
+        REQUIRE_THAT(b, Approx(expected));
+
+        A.kernel(matrix::block_kernel::batched);
+        T bb(x.size());
+        A(x, bb);
+        REQUIRE_THAT(bb, Approx(expected));
+    }
+}
+
+TEST_CASE("coefficient deduplication")
+{
+    using T = std::vector<real>;
+
+    auto iota15 = std::views::iota(0, 15);
+    const T lc(iota15.begin(), iota15.end()); // 3x5 matrix
+    const T ic{-2, -1, 0, 1, 2};
+    auto iota6 = std::views::iota(1, 7);
+    const T rc(iota6.begin(), iota6.end()); // 2x3 matrix
+    const T rc_other{6, 5, 4, 3, 2, 1};
+
+    const integer columns = 15;
+
+    // Lines 0-2 share all coefficients.  Line 3 only differs on the right.
+    auto bld = matrix::block::builder(4);
+    for (integer line = 0; line < 4; ++line)
+        bld.add_inner_block(columns, line * columns, line * columns, 1,
+                            matrix::dense(3, 5, lc),
+                            matrix::circulant(10, ic),
+                            matrix::dense(2, 3, line < 3 ? rc : rc_other));
+    const auto A = MOVE(bld).to_block();
+
+    const auto& r = A.coefficient_report();
+    REQUIRE(r.lines == 4);
+    REQUIRE(r.sets == 12);
+    REQUIRE(r.unique_sets == 4);
+    REQUIRE(r.coefficients == 4 * (15 + 5 + 6));
+    REQUIRE(r.stored == 15 + 5 + 6 + 6);
+    REQUIRE(r.bytes() == A.coefficients_view().extent(0) * sizeof(real));
+    REQUIRE(r.bytes_saved() == (r.coefficients - r.stored) * sizeof(real));
+
+    std::vector<matrix::inner_block_meta> host_meta(4);
+    auto h_meta = Kokkos::View<matrix::inner_block_meta*, Kokkos::HostSpace,
+                               Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        host_meta.data(), 4);
+    Kokkos::deep_copy(h_meta, A.metadata_view());
+    for (int i = 1; i < 4; ++i) {
+        REQUIRE(host_meta[i].left_coeff_offset == host_meta[0].left_coeff_offset);
+        REQUIRE(host_meta[i].interior_coeff_offset ==
+                host_meta[0].interior_coeff_offset);
+    }
+    REQUIRE(host_meta[2].right_coeff_offset == host_meta[0].right_coeff_offset);
+    REQUIRE(host_meta[3].right_coeff_offset == 15 + 5 + 6);
+
+    // shared storage gives the same result as applying each line separately
+    T x(4 * columns);
+    std::generate(x.begin(), x.end(), g);
+    T b(x.size()), expected(x.size());
+    A(x, b);
+    for (integer line = 0; line < 4; ++line) {
+        const auto& rcl = line < 3 ? rc : rc_other;
+        const auto ib = matrix::inner_block(columns, line * columns, line * columns, 1,
+                                            matrix::dense(3, 5, lc),
+                                            matrix::circulant(10, ic),
+                                            matrix::dense(2, 3, rcl));
+        ib(x, expected);
+    }
+    REQUIRE_THAT(b, Approx(expected));
+}
+
+TEST_CASE("multi-vector")
+{
+    using T = std::vector<real>;
+
+    randomize();
+    const integer lr = 3, lc = 5, nint = 12;
+    const integer columns = lr + nint + lr;
+    T left(lr * lc), right(lr * lc), ic(5);
+    std::generate(left.begin(), left.end(), g);
+    std::generate(right.begin(), right.end(), g);
+    std::generate(ic.begin(), ic.end(), g);
+
+    auto bld = matrix::block::builder(3);
+    for (integer line = 0; line < 3; ++line)
+        bld.add_inner_block(columns, line * columns, line * columns, 1,
+                            matrix::dense(lr, lc, left),
+                            matrix::circulant(nint, ic),
+                            matrix::dense(lr, lc, right));
+    auto A = MOVE(bld).to_block();
+
+    constexpr int k = 5;
+    std::vector<T> x(k, T(3 * columns)), b(k, T(3 * columns)), expected = b;
+    matrix::multi_vector v{.k = k};
+    for (int f = 0; f < k; ++f) {
+        std::generate(x[f].begin(), x[f].end(), g);
+        A(x[f], expected[f]);
+        v.x[f] = x[f].data();
+        v.b[f] = b[f].data();
+    }
+
+    A(v);
+    for (int f = 0; f < k; ++f) REQUIRE_THAT(b[f], Approx(expected[f]));
+
+    // accumulation through a graph node
+    auto graph = Kokkos::Experimental::create_graph<execution_space>(
+        [&](auto root) { A.graph_node(root, v, plus_eq); });
+    graph.instantiate();
+    graph.submit();
+    Kokkos::fence();
+    for (int f = 0; f < k; ++f) {
+        T twice(expected[f].size());
+        std::ranges::transform(expected[f], twice.begin(), x2);
+        REQUIRE_THAT(b[f], Approx(twice));
+    }
+}
+
+TEST_CASE("fp32 storage")
+{
+    using T = std::vector<real>;
+
+    // two strided lines and a unit stride line with a wider interior
+    auto bld = matrix::block::builder(3);
+    const T lc{0.1, 0.2, 0.3, 0.4, 0.5, 0.6};
+    const T rc{1.0 / 3, 2.0 / 3, 1.0, 4.0 / 3};
+    bld.add_inner_block(
+        20, 0, 0, 2, matrix::dense(2, 3, lc), matrix::circulant(16, T{-1, 0, 1}),
+        matrix::dense(2, 2, rc));
+    bld.add_inner_block(
+        20, 1, 1, 2, matrix::dense(2, 3, lc), matrix::circulant(16, T{-1, 0, 1}),
+        matrix::dense(2, 2, rc));
+    bld.add_inner_block(20,
+                        40,
+                        40,
+                        1,
+                        matrix::dense(2, 3, lc),
+                        matrix::circulant(16, T{0.1, -0.2, 1, 0.3, -0.2}),
+                        matrix::dense(2, 2, rc));
+    auto A = MOVE(bld).to_block();
+    REQUIRE(A.precision() == matrix::storage_precision::fp64);
+
+    randomize();
+    T x(60);
+    std::ranges::generate(x, g);
+    T b64(x.size()), b(x.size());
+    A(x, b64);
+
+    A.precision(matrix::storage_precision::fp32);
+    REQUIRE(A.coefficients_fp32_view().extent(0) == A.coefficients_view().extent(0));
+
+    for (auto kernel : {matrix::block_kernel::line, matrix::block_kernel::batched}) {
+        A.kernel(kernel, 2);
+
+        // fp32 coefficients on fp64 fields
+        std::ranges::fill(b, 0.0);
+        A(x, b);
+        REQUIRE_THAT(b, Approx(b64).epsilon(1e-6).margin(1e-6));
+
+        auto graph = Kokkos::Experimental::create_graph<execution_space>(
+            [&](auto root) { A.graph_node(root, x.data(), b.data(), plus_eq); });
+        graph.instantiate();
+        graph.submit();
+        Kokkos::fence();
+        T twice(b64);
+        for (auto& v : twice) v *= 2;
+        REQUIRE_THAT(b, Approx(twice).epsilon(1e-6).margin(1e-6));
+
+        // fp32 coefficients and fields
+        std::vector<float> xf(x.begin(), x.end()), bf(x.size());
+        A(xf, bf);
+        REQUIRE_THAT(T(bf.begin(), bf.end()), Approx(b64).epsilon(1e-5).margin(1e-5));
+    }
+
+    // back to fp64 reproduces the original product
+    A.precision(matrix::storage_precision::fp64);
+    REQUIRE(!A.coefficients_fp32_view().is_allocated());
+    A(x, b);
+    REQUIRE_THAT(b, Approx(b64));
+}
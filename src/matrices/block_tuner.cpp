@@ -0,0 +1,196 @@
+#include "block_tuner.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+namespace ccs::matrix
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+// Add the well-formed entries stored at `path` to `entries`, keeping existing keys.
+void read_entries(const std::string& path, std::map<tuning_key, block_launch>& entries)
+{
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream is(line);
+        tuning_key key;
+        block_launch l;
+        int precision, kernel;
+        if (is >> key.extents[0] >> key.extents[1] >> key.extents[2] >>
+            key.stencil_width >> key.threads >> key.dir >> key.pencil >> precision >>
+            kernel >> l.team_size >> l.vector_len >> l.lanes) {
+            if (key.pencil < 0 || key.pencil > 1 || precision < 0 || precision > 1 ||
+                kernel < 0 || kernel > 1 || l.team_size < 0 || l.vector_len < 1 ||
+                l.lanes < 1)
+                continue;
+            key.precision = static_cast<storage_precision>(precision);
+            l.kernel = static_cast<block_kernel>(kernel);
+            entries.try_emplace(key, l);
+        }
+    }
+}
+} // namespace
+
+tuning_cache::tuning_cache(std::string path) : path_{MOVE(path)}
+{
+    read_entries(path_, entries);
+}
+
+std::optional<block_launch> tuning_cache::find(const tuning_key& key) const
+{
+    if (auto it = entries.find(key); it != entries.end()) return it->second;
+    return std::nullopt;
+}
+
+void tuning_cache::insert(const tuning_key& key, const block_launch& l)
+{
+    entries[key] = l;
+}
+
+bool tuning_cache::save() const
+{
+    if (path_.empty()) return false;
+
+    // keep the entries other processes stored since this cache was loaded; ours win
+    // for keys in both
+    auto merged = entries;
+    read_entries(path_, merged);
+
+    // write a uniquely named sibling and rename it over the cache so neither a
+    // concurrent reader nor a concurrent writer sees a partial file.  An entry stored
+    // by another process between the read above and the rename is lost and will be
+    // measured again on its next miss.
+    std::ostringstream name;
+    name << path_ << '.' << std::hex << std::random_device{}() << ".tmp";
+    const auto tmp = name.str();
+    std::error_code ec;
+    {
+        std::ofstream out(tmp);
+        if (!out) return false;
+        out << "# nx ny nz stencil_width threads dir pencil precision kernel team_size "
+               "vector_len lanes\n";
+        for (auto&& [k, l] : merged)
+            out << k.extents[0] << ' ' << k.extents[1] << ' ' << k.extents[2] << ' '
+                << k.stencil_width << ' ' << k.threads << ' ' << k.dir << ' '
+                << k.pencil << ' ' << static_cast<int>(k.precision) << ' '
+                << static_cast<int>(l.kernel) << ' ' << l.team_size << ' '
+                << l.vector_len << ' ' << l.lanes << '\n';
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, path_, ec);
+    if (!ec) return true;
+    fs::remove(tmp, ec);
+    return false;
+}
+
+std::vector<block_launch> candidate_launches()
+{
+    std::vector<block_launch> c;
+    for (int team_size : {0, 1, 2, 4})
+        for (int vector_len : {1, 4, 8, 16}) {
+            c.push_back(block_launch{block_kernel::line, team_size, vector_len});
+            for (int lanes : {4, 8})
+                c.push_back(
+                    block_launch{block_kernel::batched, team_size, vector_len, lanes});
+        }
+    return c;
+}
+
+namespace
+{
+// Length of an input/output vector large enough for every index A touches.
+integer extent_of(const block& A)
+{
+    const auto& meta = A.metadata_view();
+    integer n = 0;
+    for (int l = 0; l < (int)meta.extent(0); ++l) {
+        const auto& m = meta(l);
+        const int rows = m.left_rows + m.interior_rows + m.right_rows;
+        n = std::max({n,
+                      integer{m.row_offset} + integer{rows} * m.stride,
+                      integer{m.col_offset} + integer{m.left_cols} * m.stride,
+                      integer{m.right_col_offset} + integer{m.right_cols} * m.stride});
+    }
+    return n;
+}
+
+bool launchable(const block& A, const block_launch& l)
+{
+    using policy = Kokkos::TeamPolicy<execution_space>;
+    if (l.vector_len > policy::vector_length_max()) return false;
+    if (l.team_size == 0) return true;
+
+    const auto p = policy(1, Kokkos::AUTO, l.vector_len);
+    const auto f = block::matvec_functor<eq_t>{
+        A.metadata_view(), A.coefficients_view(), nullptr, nullptr, eq};
+    return l.team_size <= p.team_size_max(f, Kokkos::ParallelForTag{});
+}
+} // namespace
+
+block_launch autotune(block& A, std::span<const block_launch> candidates, int reps)
+{
+    if (A.num_lines() == 0 || candidates.empty()) return A.launch();
+
+    const auto n = extent_of(A);
+    std::vector<real> x(n, 1.0);
+    std::vector<real> b(n);
+
+    auto best = A.launch();
+    double best_t = std::numeric_limits<double>::max();
+    for (auto&& l : candidates) {
+        if (!launchable(A, l)) continue;
+        A.launch(l);
+
+        // one untimed application to warm the caches
+        A(x, b);
+        Kokkos::fence();
+
+        Kokkos::Timer timer;
+        for (int r = 0; r < reps; ++r) A(x, b);
+        Kokkos::fence();
+        if (const double t = timer.seconds(); t < best_t) {
+            best_t = t;
+            best = l;
+        }
+    }
+
+    A.launch(best);
+    return best;
+}
+
+block_launch autotune(block& A, int reps)
+{
+    return autotune(A, candidate_launches(), reps);
+}
+
+block_launch autotune(block& A, tuning_key key, tuning_cache& cache, int reps)
+{
+    if (key.threads == 0) key.threads = execution_space().concurrency();
+    key.precision = A.precision();
+
+    if (auto l = cache.find(key); l) {
+        A.launch(*l);
+        return *l;
+    }
+
+    auto l = autotune(A, reps);
+    if (A.num_lines()) cache.insert(key, l);
+    return l;
+}
+
+} // namespace ccs::matrix
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "block.hpp"
+
+#include <compare>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ccs::matrix
+{
+
+// What a tuned block_launch depends on.  `threads` is the concurrency of the execution
+// space the choice was measured with; autotune fills it in when it is 0.  autotune
+// also sets `precision` to the storage precision of the block it tunes.
+struct tuning_key {
+    int3 extents{};
+    int stencil_width = 0;
+    int threads = 0;
+    int dir = 0;
+    // 1 for a block relaid into pencil ordering (derivative_mode::pencil), which has
+    // unit stride and is tuned separately from the strided block
+    int pencil = 0;
+    storage_precision precision = storage_precision::fp64;
+
+    auto operator<=>(const tuning_key&) const = default;
+};
+
+// Tuned launch configurations persisted in a small text file, one entry per line:
+//
+//   nx ny nz stencil_width threads dir pencil precision kernel team_size vector_len lanes
+//
+// with precision 0 for fp64 and 1 for fp32, and kernel 0 for block_kernel::line and 1
+// for block_kernel::batched.  A missing or
+// unreadable file gives an empty cache; malformed lines, including those of older
+// formats with fewer key fields, are skipped.
+class tuning_cache
+{
+    std::string path_;
+    std::map<tuning_key, block_launch> entries;
+
+public:
+    tuning_cache() = default;
+
+    // Load the entries stored at `path`, which is also where save() writes.
+    explicit tuning_cache(std::string path);
+
+    const std::string& path() const { return path_; }
+    integer size() const { return entries.size(); }
+
+    std::optional<block_launch> find(const tuning_key& key) const;
+    void insert(const tuning_key& key, const block_launch& l);
+
+    // Write every entry to path(), together with the entries other processes have
+    // stored there since this cache was loaded (ours win for keys in both).  Returns
+    // false if the file could not be written.
+    bool save() const;
+};
+
+// Launch configurations tried by autotune: Kokkos' choice and small fixed team sizes
+// crossed with several vector lengths, for both kernels.
+std::vector<block_launch> candidate_launches();
+
+// Time `reps` applications of A under each candidate and leave A configured with the
+// fastest, which is returned.  Candidates the execution space cannot launch are
+// skipped.  An empty block keeps its configuration.
+block_launch autotune(block& A,
+                      std::span<const block_launch> candidates,
+                      int reps = 3);
+block_launch autotune(block& A, int reps = 3);
+
+// As above but consult `cache` first.  A newly measured configuration is added to the
+// cache; the caller decides when to save() it.
+block_launch autotune(block& A, tuning_key key, tuning_cache& cache, int reps = 3);
+
+} // namespace ccs::matrix
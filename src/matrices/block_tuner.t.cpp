@@ -0,0 +1,174 @@
+#include "block_tuner.hpp"
+
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "random/random.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+// Custom main: Kokkos must be initialized before parallel_for calls.
+int main(int argc, char* argv[])
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    return Catch::Session().run(argc, argv);
+}
+
+using namespace ccs;
+using Catch::Matchers::Approx;
+
+namespace fs = std::filesystem;
+
+constexpr auto g = []() { return pick(); };
+
+namespace
+{
+// Lines of one shape, offset by `columns`, so the batched kernel groups them
+matrix::block uniform_block(integer lines, integer columns)
+{
+    using T = std::vector<real>;
+    auto iota15 = std::views::iota(0, 15);
+    const T lc(iota15.begin(), iota15.end()); // 3x5 matrix
+    const T ic{-2, -1, 0, 1, 2};
+    const T rc{1, 2, 3, 4, 5, 6}; // 2x3 matrix
+
+    auto bld = matrix::block::builder(lines);
+    for (integer line = 0; line < lines; ++line)
+        bld.add_inner_block(columns,
+                            line * columns,
+                            line * columns,
+                            1,
+                            matrix::dense(3, 5, lc),
+                            matrix::circulant(columns - 5, ic),
+                            matrix::dense(2, 3, rc));
+    return MOVE(bld).to_block();
+}
+} // namespace
+
+TEST_CASE("autotune")
+{
+    using T = std::vector<real>;
+
+    const integer lines = 9, columns = 20;
+    auto A = uniform_block(lines, columns);
+
+    T x(lines * columns);
+    randomize();
+    std::ranges::generate(x, g);
+
+    T b_ref(x.size());
+    A(x, b_ref);
+
+    const auto candidates = matrix::candidate_launches();
+    REQUIRE(std::ranges::find(candidates, matrix::block_launch{}) != candidates.end());
+
+    auto best = matrix::autotune(A, candidates, 2);
+    REQUIRE(A.launch() == best);
+    REQUIRE(std::ranges::find(candidates, best) != candidates.end());
+
+    // whichever candidate won, the product is unchanged
+    T b(x.size());
+    A(x, b);
+    REQUIRE_THAT(b, Approx(b_ref));
+
+    // every candidate the execution space can launch gives the same product
+    for (auto&& l : candidates) {
+        if (matrix::autotune(A, std::span{&l, 1}, 1) != l) continue;
+        std::ranges::fill(b, 0.0);
+        A(x, b);
+        REQUIRE_THAT(b, Approx(b_ref));
+    }
+
+    // an empty block is left alone
+    matrix::block E{};
+    REQUIRE(matrix::autotune(E) == matrix::block_launch{});
+}
+
+TEST_CASE("tuning cache")
+{
+    const auto path = (fs::temp_directory_path() / "shoccs_tuning_cache.t.txt").string();
+    fs::remove(path);
+
+    const auto key = matrix::tuning_key{
+        .extents = {9, 1, 20}, .stencil_width = 5, .threads = 3, .dir = 2};
+    const auto tuned = matrix::block_launch{.kernel = matrix::block_kernel::batched,
+                                            .team_size = 2,
+                                            .vector_len = 4,
+                                            .lanes = 4};
+
+    {
+        // missing file gives an empty cache
+        matrix::tuning_cache cache{path};
+        REQUIRE(cache.size() == 0);
+        REQUIRE(!cache.find(key));
+
+        cache.insert(key, tuned);
+        cache.insert(matrix::tuning_key{.extents = {9, 1, 20}, .dir = 1},
+                     matrix::block_launch{});
+        REQUIRE(cache.save());
+    }
+
+    // malformed lines and lines without the pencil field are skipped
+    std::ofstream{path, std::ios::app} << "1 2 3\nnot an entry\n9 1 20 5 3 2 1 2 4 4\n";
+
+    matrix::tuning_cache cache{path};
+    REQUIRE(cache.size() == 2);
+    auto l = cache.find(key);
+    REQUIRE(l);
+    REQUIRE(*l == tuned);
+    REQUIRE(!cache.find(matrix::tuning_key{.extents = {9, 1, 20}, .dir = 0}));
+    auto relaid = key;
+    relaid.pencil = 1;
+    REQUIRE(!cache.find(relaid));
+
+    // a cached entry is applied without timing; a new key is measured and stored
+    auto A = uniform_block(9, 20);
+    REQUIRE(matrix::autotune(A, key, cache) == tuned);
+    REQUIRE(A.launch() == tuned);
+    REQUIRE(A.num_batches() == 3);
+
+    auto other = key;
+    other.dir = 0;
+    auto measured = matrix::autotune(A, other, cache, 1);
+    REQUIRE(cache.size() == 3);
+    REQUIRE(*cache.find(other) == measured);
+
+    // threads default to the execution space concurrency
+    other.threads = 0;
+    matrix::autotune(A, other, cache, 1);
+    other.threads = execution_space().concurrency();
+    REQUIRE(cache.find(other));
+
+    // fp32 coefficients are tuned under their own key
+    auto single = key;
+    single.precision = matrix::storage_precision::fp32;
+    A.precision(matrix::storage_precision::fp32);
+    matrix::autotune(A, key, cache, 1);
+    REQUIRE(cache.find(single));
+    A.precision(matrix::storage_precision::fp64);
+
+    // save keeps entries stored by another cache on the same file
+    {
+        matrix::tuning_cache writer{path};
+        const auto theirs = matrix::tuning_key{.extents = {3, 4, 5}, .dir = 1};
+        writer.insert(theirs, tuned);
+        REQUIRE(writer.save());
+
+        REQUIRE(!cache.find(theirs));
+        REQUIRE(cache.save());
+        matrix::tuning_cache reloaded{path};
+        REQUIRE(reloaded.size() == cache.size() + 1);
+        REQUIRE(*reloaded.find(theirs) == tuned);
+        REQUIRE(*reloaded.find(key) == tuned);
+        REQUIRE(reloaded.find(single));
+    }
+
+    fs::remove(path);
+}
@@ -1,9 +1,9 @@
 #include "circulant.hpp"
 
 #include "kokkos_types.hpp"
+#include "stencil_kernel.hpp"
 
 #include <cassert>
-#include <numeric>
 
 namespace ccs::matrix
 {
@@ -48,23 +48,29 @@ void circulant::operator()(std::span<const real> x, std::span<real> b, Op op) co
     const auto* xp = x.data();
     auto* bp = b.data();
 
-    if (st == 1) {
-        Kokkos::parallel_for(
-            Kokkos::RangePolicy<execution_space>(0, nr),
-            [=](int i) {
-                auto dot = std::inner_product(vp, vp + vs, xp + i, 0.0);
-                op(bp[i], dot);
-            });
-    } else {
-        Kokkos::parallel_for(
-            Kokkos::RangePolicy<execution_space>(0, nr),
-            [=](int i) {
-                real dot = 0.0;
-                for (integer j = 0; j < vs; j++)
-                    dot += vp[j] * xp[(i + j) * st];
-                op(bp[i * st], dot);
-            });
-    }
+    with_stencil_kernel(select_stencil_kernel(vs), [&](auto width) {
+        constexpr int W = decltype(width)::value;
+        if constexpr (W == 0) {
+            Kokkos::parallel_for(
+                Kokkos::RangePolicy<execution_space>(0, nr), [=](int i) {
+                    op(bp[i * st], generic_dot(vp, xp + i * st, st, vs));
+                });
+        } else {
+            // copy the coefficients so the kernel holds them by value
+            real c[W];
+            for (int j = 0; j < W; ++j) c[j] = vp[j];
+            if (st == 1) {
+                Kokkos::parallel_for(
+                    Kokkos::RangePolicy<execution_space>(0, nr),
+                    [=](int i) { op(bp[i], fixed_dot<W>(c, xp + i, 1)); });
+            } else {
+                Kokkos::parallel_for(
+                    Kokkos::RangePolicy<execution_space>(0, nr), [=](int i) {
+                        op(bp[i * st], fixed_dot<W>(c, xp + i * st, st));
+                    });
+            }
+        }
+    });
 }
 
 template void
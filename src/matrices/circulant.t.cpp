@@ -130,3 +130,31 @@ TEST_CASE("stride")
         REQUIRE_THAT(q, Approx(r));
     }
 }
+
+TEST_CASE("fixed width kernels")
+{
+    using T = std::vector<real>;
+
+    randomize();
+    // 3/5/7/9 use the specialized kernels, 11 exercises the generic fallback
+    for (integer w : {3, 5, 7, 9, 11}) {
+        T coeffs(w);
+        std::generate(coeffs.begin(), coeffs.end(), g);
+
+        for (integer st : {1, 3}) {
+            const integer rows = 8;
+            const auto A = matrix::circulant(rows, st * (w / 2), st, coeffs);
+            T x(st * (rows + w - 1));
+            std::generate(x.begin(), x.end(), g);
+
+            T expected(x.size());
+            for (integer i = 0; i < rows; ++i)
+                for (integer j = 0; j < w; ++j)
+                    expected[st * (i + w / 2)] += coeffs[j] * x[st * (i + j)];
+
+            T b(x.size());
+            A(x, b);
+            REQUIRE_THAT(b, Approx(expected));
+        }
+    }
+}
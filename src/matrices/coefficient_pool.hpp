@@ -0,0 +1,48 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ccs::matrix
+{
+
+// Hash-consed store of coefficient sets.  Each distinct (byte-identical) set is kept
+// once and every request for it returns the offset of the shared copy.  Used by
+// block::build_device_arrays so the lines of a direction, which on an uncut box all
+// carry the same boundary closures and interior stencil, share one copy.
+class coefficient_pool
+{
+    std::vector<real> data_;
+    std::unordered_map<std::string, int> offsets_;
+    integer requested_ = 0;
+    integer sets_ = 0;
+
+public:
+    // Return the offset of `c` in the pool, appending it if it has not been seen.
+    int insert(std::span<const real> c)
+    {
+        requested_ += c.size();
+        if (c.empty()) return 0;
+        ++sets_;
+
+        std::string key(reinterpret_cast<const char*>(c.data()), c.size_bytes());
+        auto [it, inserted] = offsets_.try_emplace(MOVE(key), (int)data_.size());
+        if (inserted) data_.insert(data_.end(), c.begin(), c.end());
+        return it->second;
+    }
+
+    std::span<const real> data() const { return data_; }
+
+    // number of non-empty sets inserted and how many of them were distinct
+    integer sets() const { return sets_; }
+    integer unique_sets() const { return offsets_.size(); }
+    // coefficients inserted versus coefficients stored
+    integer requested() const { return requested_; }
+    integer size() const { return data_.size(); }
+};
+
+} // namespace ccs::matrix
@@ -3,64 +3,244 @@
 #include "kokkos_types.hpp"
 
 #include <algorithm>
+#include <cassert>
+#include <numeric>
 
 namespace ccs::matrix
 {
 
-csr csr::builder::to_csr(integer nrows)
+csr csr::builder::to_csr(integer nrows) const
 {
-    std::vector<int> u(nrows + 1);
+    return to_csr(std::span{this, 1}, nrows);
+}
+
+csr csr::builder::to_csr(std::span<const builder> parts, integer nrows)
+{
+    using policy = Kokkos::RangePolicy<execution_space>;
 
-    std::ranges::sort(p);
-    auto first = p.begin();
-    auto last = p.end();
+    // point i of the concatenated parts is parts[k].p[i - first[k]]
+    std::vector<integer> first(parts.size() + 1);
+    for (std::size_t k = 0; k < parts.size(); ++k)
+        first[k + 1] = first[k] + parts[k].p.size();
+    const integer n = first.back();
+    auto point = [&](integer i) -> const pts& {
+        const auto k = std::ranges::upper_bound(first, i) - first.begin() - 1;
+        return parts[k].p[i - first[k]];
+    };
 
-    for (integer i = 0; i < nrows; i++) {
-        u[i + 1] = u[i];
-        while (first != last && first->row == i) {
-            ++u[i + 1];
-            ++first;
+    // count the entries of each row and turn the counts into row offsets: h_u[r + 1]
+    // is the end of row r
+    std::vector<integer> h_u(nrows + 1);
+    Kokkos::parallel_for("csr_count", policy(0, n), [&](integer i) {
+        assert(point(i).row >= 0 && point(i).row < nrows);
+        Kokkos::atomic_fetch_add(&h_u[point(i).row + 1], integer{1});
+    });
+    Kokkos::fence("csr count complete");
+    std::inclusive_scan(h_u.begin(), h_u.end(), h_u.begin());
+
+    // scatter (col, v) straight into the output arrays, using h_u[r] as the cursor of
+    // row r.  Afterwards h_u[r] is the end of row r, so shifting h_u up by one restores
+    // the offsets.  The order within a row depends on the scheduling, but sorting the
+    // rows makes the result deterministic.
+    auto res = csr{};
+    res.w = device_view<real*>("csr_w", n);
+    res.v = device_view<integer*>("csr_v", n);
+    auto h_w = Kokkos::create_mirror_view(res.w);
+    auto h_v = Kokkos::create_mirror_view(res.v);
+    Kokkos::parallel_for("csr_scatter", policy(0, n), [&](integer i) {
+        const auto& pt = point(i);
+        const integer j = Kokkos::atomic_fetch_add(&h_u[pt.row], integer{1});
+        h_w(j) = pt.v;
+        h_v(j) = pt.col;
+    });
+    Kokkos::fence("csr scatter complete");
+    std::shift_right(h_u.begin(), h_u.end(), 1);
+    h_u[0] = 0;
+
+    // insertion sort of each row by column, then value.  Rows hold a stencil's worth
+    // of entries, so this beats a general sort and needs no scratch.
+    Kokkos::parallel_for("csr_rows", policy(0, nrows), [&](integer r) {
+        for (integer i = h_u[r] + 1; i < h_u[r + 1]; ++i) {
+            const integer col = h_v(i);
+            const real v = h_w(i);
+            integer j = i;
+            for (; j > h_u[r] && (h_v(j - 1) > col || (h_v(j - 1) == col && h_w(j - 1) > v));
+                 --j) {
+                h_v(j) = h_v(j - 1);
+                h_w(j) = h_w(j - 1);
+            }
+            h_v(j) = col;
+            h_w(j) = v;
         }
+    });
+    Kokkos::fence("csr rows complete");
+    res.u = to_view<integer>("csr_u", h_u);
+    Kokkos::deep_copy(res.w, h_w);
+    Kokkos::deep_copy(res.v, h_v);
+    return res;
+}
+
+void csr::operator()(std::span<const real> x, std::span<real> b) const
+{
+    (*this)(sources{x.data()}, b);
+}
+
+void csr::operator()(sources x, std::span<real> b) const
+{
+    using team_policy = Kokkos::TeamPolicy<execution_space>;
+    Kokkos::parallel_for(team_policy(league_size(), Kokkos::AUTO, chunk_),
+                         functor(x, b.data()));
+}
+
+void csr::operator()(const multi_sources& x) const
+{
+    if (x.k == 0) return;
+    assert(x.k <= max_vectors);
+    using team_policy = Kokkos::TeamPolicy<execution_space>;
+    Kokkos::parallel_for(team_policy(league_size(), Kokkos::AUTO, chunk_),
+                         multi_functor(x));
+}
+
+void csr::operator()(const multi_vector& x) const
+{
+    assert(s.extent(0) == 0);
+    multi_sources ms{.k = x.k};
+    for (int f = 0; f < x.k; ++f) {
+        ms.x[f] = sources{x.x[f]};
+        ms.b[f] = x.b[f];
     }
+    (*this)(ms);
+}
+
+csr csr::merge(std::span<const csr* const> parts, std::span<const int> ids)
+{
+    assert(ids.empty() || ids.size() == parts.size());
+    auto id_of = [&](std::size_t k) { return ids.empty() ? (int)k : ids[k]; };
+    for (std::size_t k = 0; k < parts.size(); ++k)
+        assert(id_of(k) >= 0 && id_of(k) < max_sources);
 
-    std::vector<real> w_vec;
-    std::vector<integer> v_vec;
-    w_vec.reserve(p.size());
-    v_vec.reserve(p.size());
-    for (auto& pt : p) {
-        w_vec.push_back(pt.v);
-        v_vec.push_back(pt.col);
+    integer nr = 0;
+    for (auto* A : parts) nr = std::max(nr, A->rows());
+
+    std::vector<integer> h_u(nr + 1);
+    std::vector<real> h_w;
+    std::vector<integer> h_v;
+    std::vector<std::uint8_t> h_s;
+    for (integer r = 0; r < nr; ++r) {
+        for (std::size_t k = 0; k < parts.size(); ++k) {
+            const auto* A = parts[k];
+            if (r >= A->rows()) continue;
+            for (integer i = A->u(r); i < A->u(r + 1); ++i) {
+                h_w.push_back(A->w(i));
+                h_v.push_back(A->v(i));
+                h_s.push_back(static_cast<std::uint8_t>(id_of(k)));
+            }
+        }
+        h_u[r + 1] = h_w.size();
     }
-    return csr{w_vec, v_vec, u};
+
+    auto res = csr{h_w, h_v, h_u};
+    res.s = to_view<std::uint8_t>("csr_s", h_s);
+    return res;
 }
 
-void csr::operator()(std::span<const real> x, std::span<real> b) const
+csr csr::scaled_rows(std::span<const real> scale) const
+{
+    assert((integer)scale.size() >= rows());
+
+    std::vector<real> h_w(size());
+    for (integer r = 0; r < rows(); ++r)
+        for (integer i = u(r); i < u(r + 1); ++i) h_w[i] = w(i) * scale[r];
+
+    auto res = csr{};
+    res.w = to_view<real>("csr_w", h_w);
+    res.v = v;
+    res.u = u;
+    res.s = s;
+    res.f = f;
+    return res;
+}
+
+integer csr::num_sources() const
+{
+    if (s.extent(0) == 0) return size() ? 1 : 0;
+    integer n = 0;
+    for (std::size_t i = 0; i < s.extent(0); ++i) n = std::max<integer>(n, s(i) + 1);
+    return n;
+}
+
+void csr::layout(csr_layout l, int chunk, int sigma)
+{
+    assert(chunk > 0 && sigma > 0);
+    layout_ = l;
+    chunk_ = chunk;
+    if (l == csr_layout::sell) build_sell(chunk, sigma);
+}
+
+void csr::build_sell(int chunk, int sigma)
 {
-    const auto nr = rows();
-    const auto* w_ptr = w.data();
-    const auto* v_ptr = v.data();
-    const auto* u_ptr = u.data();
-    const auto* x_ptr = x.data();
-    auto* b_ptr = b.data();
-    Kokkos::parallel_for(
-        Kokkos::RangePolicy<execution_space>(0, nr),
-        [=](integer row) {
-            for (integer i = u_ptr[row]; i < u_ptr[row + 1]; i++)
-                b_ptr[row] += w_ptr[i] * x_ptr[v_ptr[i]];
-        });
+    const integer nr = rows();
+    const integer n_slices = (nr + chunk - 1) / chunk;
+    // sorting windows are whole slices so no slice straddles two windows
+    const integer window = std::max<integer>(chunk, (sigma + chunk - 1) / chunk * chunk);
+
+    auto row_len = [this](integer r) { return u(r + 1) - u(r); };
+
+    // rows sorted by decreasing length within each window
+    std::vector<integer> order(n_slices * chunk, -1);
+    std::iota(order.begin(), order.begin() + nr, integer{0});
+    for (integer first = 0; first < nr; first += window) {
+        auto last = std::min(first + window, nr);
+        std::stable_sort(order.begin() + first,
+                         order.begin() + last,
+                         [&](integer a, integer b) { return row_len(a) > row_len(b); });
+    }
+
+    std::vector<integer> h_u(n_slices + 1);
+    for (integer sl = 0; sl < n_slices; ++sl) {
+        integer width = 0;
+        for (int l = 0; l < chunk; ++l)
+            if (auto r = order[sl * chunk + l]; r >= 0)
+                width = std::max(width, row_len(r));
+        h_u[sl + 1] = h_u[sl] + width * chunk;
+    }
+
+    // padding reads a valid column with a zero coefficient
+    const integer pad_col = size() ? v(0) : 0;
+    const bool merged = s.extent(0) > 0;
+    std::vector<real> h_w(h_u[n_slices], 0.0);
+    std::vector<integer> h_v(h_u[n_slices], pad_col);
+    std::vector<std::uint8_t> h_s(merged ? h_u[n_slices] : 0, merged ? s(0) : 0);
+    for (integer sl = 0; sl < n_slices; ++sl) {
+        for (int l = 0; l < chunk; ++l) {
+            auto r = order[sl * chunk + l];
+            if (r < 0) continue;
+            for (integer j = 0; j < row_len(r); ++j) {
+                h_w[h_u[sl] + j * chunk + l] = w(u(r) + j);
+                h_v[h_u[sl] + j * chunk + l] = v(u(r) + j);
+                if (merged) h_s[h_u[sl] + j * chunk + l] = s(u(r) + j);
+            }
+        }
+    }
+
+    slice_u = to_view<integer>("csr_slice_u", h_u);
+    slice_row = to_view<integer>("csr_slice_row", order);
+    slice_w = to_view<real>("csr_slice_w", h_w);
+    slice_v = to_view<integer>("csr_slice_v", h_v);
+    slice_s = to_view<std::uint8_t>("csr_slice_s", h_s);
 }
 
 std::span<const integer> csr::column_indices(integer row) const
 {
-    integer r0 = u[row];
-    integer r1 = u[row + 1];
+    integer r0 = u(row);
+    integer r1 = u(row + 1);
     return std::span(v.data() + r0, r1 - r0);
 }
 
 std::span<const real> csr::column_coefficients(integer row) const
 {
-    integer r0 = u[row];
-    integer r1 = u[row + 1];
+    integer r0 = u(row);
+    integer r1 = u(row + 1);
     return std::span(w.data() + r0, r1 - r0);
 }
 
@@ -4,63 +4,324 @@
 #include "matrix_visitor.hpp"
 
 #include "kokkos_types.hpp"
+#include "multi_vector.hpp"
 
 #include <Kokkos_Graph.hpp>
 
+#include <cassert>
 #include <compare>
+#include <cstdint>
+#include <span>
 #include <ranges>
 #include <vector>
 
 namespace ccs::matrix
 {
+// Storage layout used by the csr matvec kernels.
+//   csr  - standard compressed rows, one vector lane per row
+//   sell - SELL-C-sigma: rows are sorted by length within windows of sigma rows and
+//          packed into slices of C rows padded to the longest row in the slice.  Each
+//          slice is stored column-major so the C lanes read consecutive entries.
+enum class csr_layout { csr, sell };
+
 class csr
 {
     // standard csr format
-    std::vector<real> w;    // values
-    std::vector<integer> v; // column indices
-    std::vector<integer> u; // starting column index for rows
+    device_view<real*> w;    // values
+    device_view<integer*> v; // column indices
+    device_view<integer*> u; // starting column index for rows
+    // source vector of each entry for matrices built by merge (empty otherwise)
+    device_view<std::uint8_t*> s;
     flag f;
 
+    // SELL-C-sigma copy of the matrix (built on demand by layout())
+    csr_layout layout_ = csr_layout::csr;
+    int chunk_ = 8;
+    device_view<integer*> slice_u;   // offset of each slice in slice_w/slice_v
+    device_view<integer*> slice_row; // row held by each lane, -1 for padding
+    device_view<real*> slice_w;
+    device_view<integer*> slice_v;
+    device_view<std::uint8_t*> slice_s;
+
+    void build_sell(int chunk, int sigma);
+
+    template <typename T, std::ranges::input_range R>
+    static device_view<T*> to_view(const char* label, R&& r)
+    {
+        std::vector<T> h(std::ranges::begin(r), std::ranges::end(r));
+        auto d = device_view<T*>(label, h.size());
+        Kokkos::deep_copy(d,
+                          Kokkos::View<const T*, Kokkos::HostSpace,
+                                       Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+                              h.data(), h.size()));
+        return d;
+    }
+
 public:
+    // Input vectors for a merged matrix, indexed by the source id of each entry.  Six
+    // covers the (D, R) pairs of the three components of a divergence.
+    static constexpr int max_sources = 6;
+    struct sources {
+        const real* p[max_sources];
+    };
+
+    // Multi-vector form: field f reads x[f] and accumulates into b[f].
+    struct multi_sources {
+        sources x[max_vectors];
+        real* b[max_vectors];
+        int k;
+    };
+
     csr() = default;
 
     template <std::ranges::input_range W, std::ranges::input_range V, std::ranges::input_range U>
     csr(W&& w, V&& v, U&& u, flag row_col_space = 0)
-        : w(std::ranges::begin(w), std::ranges::end(w)),
-          v(std::ranges::begin(v), std::ranges::end(v)),
-          u(std::ranges::begin(u), std::ranges::end(u)),
+        : w(to_view<real>("csr_w", w)),
+          v(to_view<integer>("csr_v", v)),
+          u(to_view<integer>("csr_u", u)),
           f{row_col_space}
     {
     }
 
-    integer rows() const { return u.size() ? u.size() - 1 : 0; }
+    integer rows() const { return u.extent(0) ? u.extent(0) - 1 : 0; }
+    // Host access to the csr arrays (memory_space is host accessible)
     std::span<const integer> column_indices(integer row) const;
     std::span<const real> column_coefficients(integer row) const;
 
     // number of non-zero entries
-    integer size() const { return (integer)w.size(); }
+    integer size() const { return (integer)w.extent(0); }
+
+    // Combine matrices sharing an output space into one matrix whose entries remember
+    // which input they came from.  Row r of the result holds row r of every input,
+    // in order, with source id ids[k] for input k (its position when ids is empty).
+    // Applying the result with sources{x0, x1, ...} accumulates the same values as
+    // applying each input to its own vector, in a single pass over the output.
+    static csr merge(std::span<const csr* const> parts, std::span<const int> ids = {});
+    integer num_sources() const;
+
+    // Copy of the matrix with row r multiplied by scale[r], for operators that weight
+    // each output point by a fixed coefficient.  Source ids and flags are kept; the
+    // copy uses csr_layout::csr.
+    csr scaled_rows(std::span<const real> scale) const;
+
+    // Select the matvec layout.  `chunk` is the number of rows per team (the slice
+    // height C for csr_layout::sell) and must be a valid vector length, typically the
+    // SIMD width in doubles.  `sigma` is the sell sorting window in rows.
+    void layout(csr_layout l, int chunk = 8, int sigma = 256);
+    csr_layout layout() const { return layout_; }
+
+    // number of stored entries in the active layout, including sell padding
+    integer stored_size() const
+    {
+        return layout_ == csr_layout::sell ? (integer)slice_w.extent(0) : size();
+    }
+
+    // Named functor for the csr matvec, shared by operator() and graph_node.  Each
+    // team handles `chunk` rows (or one sell slice).  The rows are split over the
+    // team's threads and vector lanes together, so every row is written by exactly
+    // one lane whatever team size Kokkos picks.
+    struct matvec_functor {
+        device_view<real*> w;
+        device_view<integer*> v;
+        device_view<integer*> u;
+        device_view<std::uint8_t*> s;
+        device_view<integer*> slice_u;
+        device_view<integer*> slice_row;
+        device_view<real*> slice_w;
+        device_view<integer*> slice_v;
+        device_view<std::uint8_t*> slice_s;
+        sources x;
+        real* b_ptr;
+        integer nr;
+        int chunk;
+        bool sell;
+        bool merged;
+
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        using member_type = typename team_policy::member_type;
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            const integer slice = team.league_rank();
+            Kokkos::parallel_for(Kokkos::TeamVectorRange(team, chunk), [&](int l) {
+                if (sell) {
+                    const integer row = slice_row(slice * chunk + l);
+                    if (row < 0) return;
+                    const integer first = slice_u(slice);
+                    const integer width = (slice_u(slice + 1) - first) / chunk;
+                    real dot = 0;
+                    for (integer j = 0; j < width; ++j) {
+                        const integer i = first + j * chunk + l;
+                        dot += slice_w(i) * x.p[merged ? slice_s(i) : 0][slice_v(i)];
+                    }
+                    b_ptr[row] += dot;
+                } else {
+                    const integer row = slice * chunk + l;
+                    if (row >= nr) return;
+                    real dot = 0;
+                    for (integer i = u(row); i < u(row + 1); i++)
+                        dot += w(i) * x.p[merged ? s(i) : 0][v(i)];
+                    b_ptr[row] += dot;
+                }
+            });
+        }
+    };
+
+    matvec_functor functor(sources x, real* b_ptr) const
+    {
+        return {w,
+                v,
+                u,
+                s,
+                slice_u,
+                slice_row,
+                slice_w,
+                slice_v,
+                slice_s,
+                x,
+                b_ptr,
+                rows(),
+                chunk_,
+                layout_ == csr_layout::sell,
+                s.extent(0) > 0};
+    }
+
+    // Multi-vector matvec: like matvec_functor, but each lane walks its row once and
+    // applies every coefficient to all k fields.
+    struct multi_matvec_functor {
+        device_view<real*> w;
+        device_view<integer*> v;
+        device_view<integer*> u;
+        device_view<std::uint8_t*> s;
+        device_view<integer*> slice_u;
+        device_view<integer*> slice_row;
+        device_view<real*> slice_w;
+        device_view<integer*> slice_v;
+        device_view<std::uint8_t*> slice_s;
+        multi_sources x;
+        integer nr;
+        int chunk;
+        bool sell;
+        bool merged;
+
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        using member_type = typename team_policy::member_type;
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            const integer slice = team.league_rank();
+            Kokkos::parallel_for(Kokkos::TeamVectorRange(team, chunk), [&](int l) {
+                real dot[max_vectors] = {};
+                integer row;
+                if (sell) {
+                    row = slice_row(slice * chunk + l);
+                    if (row < 0) return;
+                    const integer first = slice_u(slice);
+                    const integer width = (slice_u(slice + 1) - first) / chunk;
+                    for (integer j = 0; j < width; ++j) {
+                        const integer i = first + j * chunk + l;
+                        const real c = slice_w(i);
+                        const integer col = slice_v(i);
+                        const int src = merged ? slice_s(i) : 0;
+                        for (int f = 0; f < x.k; ++f) dot[f] += c * x.x[f].p[src][col];
+                    }
+                } else {
+                    row = slice * chunk + l;
+                    if (row >= nr) return;
+                    for (integer i = u(row); i < u(row + 1); i++) {
+                        const real c = w(i);
+                        const integer col = v(i);
+                        const int src = merged ? s(i) : 0;
+                        for (int f = 0; f < x.k; ++f) dot[f] += c * x.x[f].p[src][col];
+                    }
+                }
+                for (int f = 0; f < x.k; ++f) x.b[f][row] += dot[f];
+            });
+        }
+    };
+
+    multi_matvec_functor multi_functor(const multi_sources& x) const
+    {
+        return {w,
+                v,
+                u,
+                s,
+                slice_u,
+                slice_row,
+                slice_w,
+                slice_v,
+                slice_s,
+                x,
+                rows(),
+                chunk_,
+                layout_ == csr_layout::sell,
+                s.extent(0) > 0};
+    }
+
+    // Device copy of the csr arrays for kernels that evaluate rows themselves, e.g.
+    // to fold the corrections into another pass over the output.
+    struct row_view {
+        device_view<real*> w;
+        device_view<integer*> v;
+        device_view<integer*> u;
+        device_view<std::uint8_t*> s;
+        integer nr = 0;
+
+        // row `row` applied to x, 0 for rows past the end of the matrix
+        KOKKOS_INLINE_FUNCTION real dot(integer row, const sources& x) const
+        {
+            if (row >= nr) return 0;
+            const bool merged = s.extent(0) > 0;
+            real d = 0;
+            for (integer i = u(row); i < u(row + 1); i++)
+                d += w(i) * x.p[merged ? s(i) : 0][v(i)];
+            return d;
+        }
+    };
+
+    row_view rows_view() const { return {w, v, u, s, rows()}; }
+
+    // number of teams launched by the matvec kernel
+    int league_size() const { return static_cast<int>((rows() + chunk_ - 1) / chunk_); }
 
     void operator()(std::span<const real> x, std::span<real> b) const;
+    void operator()(sources x, std::span<real> b) const;
+    // Apply to x.k fields in one launch (always +=).  The multi_vector form is for
+    // unmerged matrices.
+    void operator()(const multi_sources& x) const;
+    void operator()(const multi_vector& x) const;
+
+    // Chain a TeamPolicy graph node that performs the CSR matvec (always +=).
+    // For 0-row matrices, the node executes zero teams.
+    template <typename NodeType>
+    auto graph_node(NodeType parent, sources x, real* b_ptr) const
+    {
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        return parent.then_parallel_for("csr_matvec",
+                                        team_policy(league_size(), Kokkos::AUTO, chunk_),
+                                        functor(x, b_ptr));
+    }
 
-    // Chain a RangePolicy graph node that performs the CSR matvec (always +=).
-    // For 0-row matrices, the node executes zero iterations.
     template <typename NodeType>
     auto graph_node(NodeType parent, const real* x_ptr, real* b_ptr) const
     {
-        const auto nr = rows();
-        const auto* wp = w.data();
-        const auto* vp = v.data();
-        const auto* up = u.data();
-        return parent.then_parallel_for(
-            "csr_matvec",
-            Kokkos::RangePolicy<execution_space>(0, nr),
-            KOKKOS_LAMBDA(integer row) {
-                for (integer i = up[row]; i < up[row + 1]; i++)
-                    b_ptr[row] += wp[i] * x_ptr[vp[i]];
-            });
+        return graph_node(parent, sources{x_ptr}, b_ptr);
+    }
+
+    template <typename NodeType>
+    auto graph_node(NodeType parent, const multi_sources& x) const
+    {
+        assert(x.k <= max_vectors);
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        return parent.then_parallel_for("csr_multi_matvec",
+                                        team_policy(league_size(), Kokkos::AUTO, chunk_),
+                                        multi_functor(x));
     }
 
     struct builder;
+    struct parallel_builder;
 
     flag flags() const { return f; }
     void flags(flag f_) { f = f_; }
@@ -88,7 +349,40 @@ struct csr::builder {
         p.emplace_back(row, col, v);
     }
 
-    csr to_csr(integer nrows);
+    // The rows in order with the entries of each row sorted by column, then value:
+    // the matrix a full sort of the points gives.  Points are bucketed by row with a
+    // parallel counting sort (count, prefix sum, scatter) directly into the matrix
+    // arrays and each row is then sorted in place, so besides the matrix only the
+    // row offsets and one offset per part are allocated.  Every row must be less than
+    // nrows.
+    csr to_csr(integer nrows) const;
+
+    // The matrix of the points of all parts, identical to adding them to one builder.
+    static csr to_csr(std::span<const builder> parts, integer nrows);
+};
+
+// Points added from concurrently running threads.  Each thread adds to its own part,
+// indexed by the id of a Kokkos UniqueToken, so no locking is needed and to_csr reads
+// the parts in place.  Host only: add_point appends to a std::vector, which may
+// allocate, so it must not be called from device code:
+//
+//     auto token = Kokkos::Experimental::UniqueToken<execution_space>{};
+//     auto b = csr::parallel_builder{token.size()};
+//     ... inside a kernel:
+//     const int id = token.acquire();
+//     b.add_point(id, row, col, v);
+//     token.release(id);
+struct csr::parallel_builder {
+    std::vector<builder> parts;
+
+    explicit parallel_builder(int n) : parts(n) {}
+
+    void add_point(int id, integer row, integer col, real v)
+    {
+        parts[id].add_point(row, col, v);
+    }
+
+    csr to_csr(integer nrows) const { return builder::to_csr(parts, nrows); }
 };
 
 } // namespace ccs::matrix
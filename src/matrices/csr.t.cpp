@@ -172,3 +172,228 @@ TEST_CASE("Random Builder")
         REQUIRE_THAT(b, Approx(exact));
     }
 }
+
+TEST_CASE("sell layout")
+{
+    // ragged rows: lengths 0..6 in a scrambled order, 37 rows so the last slice is
+    // partially filled
+    constexpr integer nrows = 37;
+    constexpr integer ncols = 50;
+
+    std::uniform_int_distribution<integer> col(0, ncols - 1);
+    auto builder = matrix::csr::builder();
+    for (integer r = 0; r < nrows; ++r)
+        for (integer j = 0; j < (r * 5) % 7; ++j) builder.add_point(r, col(rng), pick());
+
+    auto A = builder.to_csr(nrows);
+    const T x = random_vec(ncols);
+
+    T expected(nrows);
+    for (integer r = 0; r < nrows; ++r) {
+        auto c = A.column_indices(r);
+        auto w = A.column_coefficients(r);
+        for (std::size_t i = 0; i < c.size(); ++i) expected[r] += w[i] * x[c[i]];
+    }
+
+    T b(nrows);
+    A(x, b);
+    REQUIRE_THAT(b, Approx(expected));
+
+    const std::vector<std::pair<int, int>> params{{4, 4}, {4, 16}, {8, 256}};
+    for (auto [chunk, sigma] : params) {
+        A.layout(matrix::csr_layout::sell, chunk, sigma);
+        REQUIRE(A.layout() == matrix::csr_layout::sell);
+        REQUIRE(A.stored_size() >= A.size());
+        REQUIRE(A.stored_size() % chunk == 0);
+
+        T bs(nrows);
+        A(x, bs);
+        REQUIRE_THAT(bs, Approx(expected));
+
+        // accumulates like the csr kernel
+        A(x, bs);
+        T expected2(nrows);
+        std::ranges::transform(expected, expected2.begin(), [](real v) { return 2 * v; });
+        REQUIRE_THAT(bs, Approx(expected2));
+    }
+
+    // sorting the whole matrix packs the rows at least as tight as sorting each slice
+    A.layout(matrix::csr_layout::sell, 8, 1);
+    const auto unsorted = A.stored_size();
+    A.layout(matrix::csr_layout::sell, 8, nrows);
+    REQUIRE(A.stored_size() <= unsorted);
+
+    A.layout(matrix::csr_layout::csr);
+    REQUIRE(A.stored_size() == A.size());
+}
+
+TEST_CASE("merge")
+{
+    // three matrices with different row counts reading different vectors
+    const std::vector<integer> nrows{23, 31, 17};
+    constexpr integer ncols = 40;
+
+    std::uniform_int_distribution<integer> col(0, ncols - 1);
+    std::vector<matrix::csr> parts;
+    std::vector<T> xs;
+    for (auto n : nrows) {
+        auto builder = matrix::csr::builder();
+        for (integer r = 0; r < n; ++r)
+            for (integer j = 0; j < (r * 3) % 5; ++j)
+                builder.add_point(r, col(rng), pick());
+        parts.push_back(builder.to_csr(n));
+        xs.push_back(random_vec(ncols));
+    }
+
+    T expected(31);
+    for (std::size_t k = 0; k < parts.size(); ++k) parts[k](xs[k], expected);
+
+    const std::vector<const matrix::csr*> ptrs{&parts[0], &parts[1], &parts[2]};
+    auto M = matrix::csr::merge(ptrs);
+    REQUIRE(M.rows() == 31);
+    REQUIRE(M.size() == parts[0].size() + parts[1].size() + parts[2].size());
+    REQUIRE(M.num_sources() == 3);
+
+    const matrix::csr::sources x{xs[0].data(), xs[1].data(), xs[2].data()};
+    T b(31);
+    M(x, b);
+    REQUIRE_THAT(b, Approx(expected));
+
+    M.layout(matrix::csr_layout::sell, 4, 16);
+    T bs(31);
+    M(x, bs);
+    REQUIRE_THAT(bs, Approx(expected));
+
+    // row_view evaluates the same rows and gives 0 past the end
+    const auto rv = M.rows_view();
+    T br(32);
+    for (integer r = 0; r < 32; ++r) br[r] = rv.dot(r, x);
+    REQUIRE(br[31] == 0.0);
+    br.pop_back();
+    REQUIRE_THAT(br, Approx(expected));
+
+    // inputs sharing a source id read the same vector
+    const std::vector<int> ids{0, 1, 0};
+    auto S = matrix::csr::merge(ptrs, ids);
+    REQUIRE(S.num_sources() == 2);
+    T shared(31);
+    parts[0](xs[0], shared);
+    parts[1](xs[1], shared);
+    parts[2](xs[0], shared);
+    T b2(31);
+    S(matrix::csr::sources{xs[0].data(), xs[1].data()}, b2);
+    REQUIRE_THAT(b2, Approx(shared));
+}
+
+TEST_CASE("multi-vector")
+{
+    constexpr integer nrows = 29;
+    constexpr integer ncols = 40;
+    constexpr int k = 3;
+
+    std::uniform_int_distribution<integer> col(0, ncols - 1);
+    auto builder = matrix::csr::builder();
+    for (integer r = 0; r < nrows; ++r)
+        for (integer j = 0; j < (r * 5) % 7; ++j) builder.add_point(r, col(rng), pick());
+    auto A = builder.to_csr(nrows);
+
+    std::vector<T> x, expected(k, T(nrows));
+    for (int f = 0; f < k; ++f) {
+        x.push_back(random_vec(ncols));
+        A(x[f], expected[f]);
+    }
+
+    for (auto l : {matrix::csr_layout::csr, matrix::csr_layout::sell}) {
+        A.layout(l, 4, 16);
+        std::vector<T> b(k, T(nrows));
+        matrix::multi_vector v{.k = k};
+        for (int f = 0; f < k; ++f) {
+            v.x[f] = x[f].data();
+            v.b[f] = b[f].data();
+        }
+        A(v);
+        for (int f = 0; f < k; ++f) REQUIRE_THAT(b[f], Approx(expected[f]));
+    }
+
+    // merged matrices read per-field sources
+    auto N = A;
+    const std::vector<const matrix::csr*> ptrs{&A, &N};
+    auto M = matrix::csr::merge(ptrs);
+    std::vector<T> b(k, T(nrows));
+    matrix::csr::multi_sources ms{.k = k};
+    for (int f = 0; f < k; ++f) {
+        ms.x[f] = {x[f].data(), x[(f + 1) % k].data()};
+        ms.b[f] = b[f].data();
+    }
+    M(ms);
+    for (int f = 0; f < k; ++f) {
+        T sum(nrows);
+        for (integer r = 0; r < nrows; ++r)
+            sum[r] = expected[f][r] + expected[(f + 1) % k][r];
+        REQUIRE_THAT(b[f], Approx(sum));
+    }
+}
+
+TEST_CASE("counting sort builder")
+{
+    using P = matrix::csr::builder::pts;
+    constexpr integer nrows = 301;
+    constexpr integer ncols = 40;
+
+    // ragged rows with empty ones, repeated columns and repeated (row, col) entries
+    std::uniform_int_distribution<integer> row(0, nrows - 1);
+    std::uniform_int_distribution<integer> col(0, ncols - 1);
+    std::vector<P> pts;
+    for (int i = 0; i < 2000; ++i) {
+        const auto r = row(rng) / 2 * 2;
+        pts.push_back(P{r, col(rng), pick()});
+        if (i % 7 == 0) pts.push_back(P{r, pts.back().col, pick()});
+    }
+
+    // reference: the fully sorted points
+    auto sorted = pts;
+    std::ranges::sort(sorted);
+    auto same_as_sorted = [&](const matrix::csr& A) {
+        REQUIRE(A.rows() == nrows);
+        REQUIRE(A.size() == (integer)sorted.size());
+        auto it = sorted.begin();
+        for (integer r = 0; r < nrows; ++r) {
+            const auto c = A.column_indices(r);
+            const auto w = A.column_coefficients(r);
+            for (std::size_t i = 0; i < c.size(); ++i, ++it) {
+                REQUIRE(it->row == r);
+                REQUIRE(c[i] == it->col);
+                REQUIRE(w[i] == it->v);
+            }
+        }
+        REQUIRE(it == sorted.end());
+    };
+
+    std::ranges::shuffle(pts, rng);
+    auto b = matrix::csr::builder();
+    for (auto&& [r, c, v] : pts) b.add_point(r, c, v);
+    same_as_sorted(b.to_csr(nrows));
+
+    // the same points spread over several parts
+    auto pb = matrix::csr::parallel_builder{5};
+    std::uniform_int_distribution<int> part(0, 4);
+    for (auto&& [r, c, v] : pts) pb.add_point(part(rng), r, c, v);
+    same_as_sorted(pb.to_csr(nrows));
+
+    // and added concurrently
+    auto token = Kokkos::Experimental::UniqueToken<execution_space>{};
+    auto cb = matrix::csr::parallel_builder{token.size()};
+    Kokkos::parallel_for(
+        Kokkos::RangePolicy<execution_space>(0, (integer)pts.size()), [&](integer i) {
+            const int id = token.acquire();
+            cb.add_point(id, pts[i].row, pts[i].col, pts[i].v);
+            token.release(id);
+        });
+    Kokkos::fence();
+    same_as_sorted(cb.to_csr(nrows));
+
+    // an empty builder still has every row
+    const auto E = matrix::csr::builder().to_csr(nrows);
+    REQUIRE(E.rows() == nrows);
+    REQUIRE(E.size() == 0);
+}
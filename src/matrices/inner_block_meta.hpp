@@ -1,5 +1,7 @@
 #pragma once
 
+#include "stencil_kernel.hpp"
+
 namespace ccs::matrix
 {
 
@@ -16,10 +18,69 @@ struct inner_block_meta {
     int interior_rows;
     int interior_coeff_offset;
     int stencil_width;
+    stencil_kernel interior_kernel; // chosen once from stencil_width
     int right_rows;
     int right_cols;
     int right_coeff_offset;
     int right_col_offset;
 };
 
+// Where row `local_row` of a line (counting the left, interior and right rows in
+// turn) reads and writes: the row is the dot product of `width` coefficients starting
+// at coeff_offset with x[in_idx], x[in_idx + stride], ... and lands in b[out_idx].
+struct row_extent {
+    int out_idx;
+    int in_idx;
+    int coeff_offset;
+    int width;
+};
+
+KOKKOS_INLINE_FUNCTION row_extent locate_row(const inner_block_meta& m, int local_row)
+{
+    const int out_idx = m.row_offset + local_row * m.stride;
+    if (local_row < m.left_rows)
+        return {out_idx,
+                m.col_offset,
+                m.left_coeff_offset + local_row * m.left_cols,
+                m.left_cols};
+
+    if (local_row < m.left_rows + m.interior_rows)
+        return {out_idx,
+                out_idx - (m.stencil_width / 2) * m.stride,
+                m.interior_coeff_offset,
+                m.stencil_width};
+
+    const int r = local_row - m.left_rows - m.interior_rows;
+    return {out_idx,
+            m.right_col_offset,
+            m.right_coeff_offset + r * m.right_cols,
+            m.right_cols};
+}
+
+// Serial evaluation of row `local_row` of the line described by m.  Returns the
+// row's dot product with x and sets out_idx to the row's position in the output span.
+KOKKOS_INLINE_FUNCTION real row_dot(
+    const inner_block_meta& m, const real* c, const real* x, int local_row, int& out_idx)
+{
+    const auto e = locate_row(m, local_row);
+    out_idx = e.out_idx;
+    const bool interior =
+        local_row >= m.left_rows && local_row < m.left_rows + m.interior_rows;
+    return stencil_dot(interior ? m.interior_kernel : stencil_kernel::generic,
+                       c + e.coeff_offset,
+                       x + e.in_idx,
+                       m.stride,
+                       e.width);
+}
+
+// POD struct describing a group of neighbouring lines evaluated together by the
+// line-batched block kernel.  Every line in the group has the same shape and
+// coefficients as `first_line`; line `first_line + l` is the leader shifted by
+// `l * lane_offset` in both the input and output spans.
+struct line_batch_meta {
+    int first_line;
+    int lines;
+    int lane_offset;
+};
+
 } // namespace ccs::matrix
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace ccs::matrix
+{
+
+// Up to max_vectors input/output pairs applied together by the multi-vector matvecs
+// of block and csr.  Every pair shares the matrix, so each coefficient and column
+// index is loaded once per row for all k of them.
+inline constexpr int max_vectors = 8;
+
+struct multi_vector {
+    const real* x[max_vectors];
+    real* b[max_vectors];
+    int k;
+};
+
+} // namespace ccs::matrix
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "index_extents.hpp"
+#include "kokkos_types.hpp"
+
+#include <Kokkos_Graph.hpp>
+#include <Kokkos_Profiling_ScopedRegion.hpp>
+
+#include <span>
+
+namespace ccs::matrix
+{
+
+// Direction-contiguous ("pencil") ordering of the points of a 3D mesh.  In the natural
+// ordering ic = i * n1 * n2 + j * n2 + k, only direction 2 has unit stride.  The pencil
+// ordering for direction `dir` makes that direction fastest, keeping the other two in
+// their natural order, so a derivative along `dir` reads contiguous memory.
+//
+// Both orderings are viewed as `batches` stacked rows x cols matrices, natural index
+// b * rows * cols + r * cols + c, and the pencil ordering is their transpose,
+// b * rows * cols + c * rows + r:
+//   dir 0: 1 batch of n0 x (n1 * n2)
+//   dir 1: n0 batches of n1 x n2
+//   dir 2: the identity (cols == 1)
+class pencil_layout
+{
+    integer batches = 0;
+    integer rows = 0;
+    integer cols = 0;
+
+public:
+    // Edge length of the square tiles the transposes are blocked into.
+    static constexpr int tile = 32;
+
+    pencil_layout() = default;
+
+    pencil_layout(int dir, const index_extents& extents)
+    {
+        const auto& n = extents.extents;
+        batches = dir == 0 ? 1 : dir == 1 ? integer{n[0]} : integer{n[0]} * n[1];
+        rows = n[dir];
+        cols = dir == 0 ? integer{n[1]} * n[2] : dir == 1 ? integer{n[2]} : 1;
+    }
+
+    integer size() const { return batches * rows * cols; }
+
+    // True when the pencil ordering is the natural one
+    bool identity() const { return cols <= 1 || rows <= 1; }
+
+    // pencil index of natural index ic
+    KOKKOS_INLINE_FUNCTION integer operator()(integer ic) const
+    {
+        const integer rc = rows * cols;
+        const integer rem = ic % rc;
+        return ic - rem + (rem % cols) * rows + rem / cols;
+    }
+
+    // Named functor for the cache-blocked transposes.  One team per tile of one batch:
+    // the team threads take the tile's rows and the vector lanes its columns, so the
+    // natural side is accessed contiguously and the strided side stays within a tile.
+    // to_pencil assigns every point; the reverse direction applies `op` at the points
+    // flagged in `mask` (or at every point when the mask is empty).
+    template <typename Op>
+    struct transpose_functor {
+        const real* in;
+        real* out;
+        device_view<std::uint8_t*> mask;
+        integer rows, cols;
+        integer row_tiles, col_tiles;
+        bool to_pencil;
+        Op op;
+
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        using member_type = typename team_policy::member_type;
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            const integer t = team.league_rank();
+            const integer tiles = row_tiles * col_tiles;
+            const integer base = (t / tiles) * rows * cols;
+            const integer r0 = ((t % tiles) / col_tiles) * tile;
+            const integer c0 = (t % col_tiles) * tile;
+            const int nr = static_cast<int>(r0 + tile < rows ? tile : rows - r0);
+            const int nc = static_cast<int>(c0 + tile < cols ? tile : cols - c0);
+            const bool masked = mask.extent(0) > 0;
+
+            Kokkos::parallel_for(Kokkos::TeamThreadRange(team, nr), [&](int rr) {
+                const integer r = r0 + rr;
+                Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, nc), [&](int cc) {
+                    const integer c = c0 + cc;
+                    const integer natural = base + r * cols + c;
+                    const integer pencil = base + c * rows + r;
+                    if (to_pencil)
+                        out[pencil] = in[natural];
+                    else if (!masked || mask(pencil))
+                        op(out[natural], in[pencil]);
+                });
+            });
+        }
+    };
+
+    integer num_tiles() const
+    {
+        return batches * ((rows + tile - 1) / tile) * ((cols + tile - 1) / tile);
+    }
+
+    template <typename Op>
+    transpose_functor<Op> functor(const real* in,
+                                  real* out,
+                                  bool to_pencil,
+                                  Op op,
+                                  device_view<std::uint8_t*> mask = {}) const
+    {
+        return {in,
+                out,
+                mask,
+                rows,
+                cols,
+                (rows + tile - 1) / tile,
+                (cols + tile - 1) / tile,
+                to_pencil,
+                op};
+    }
+
+    // u_p = u reordered into pencils
+    void to_pencils(std::span<const real> u, std::span<real> u_p) const
+    {
+        Kokkos::Profiling::ScopedRegion region("pencil_layout::to_pencils");
+        Kokkos::parallel_for(policy(num_tiles()), functor(u.data(), u_p.data(), true, eq));
+    }
+
+    // u op= u_p reordered back into the natural ordering, at the points flagged in
+    // `mask` if it is given
+    template <typename Op = eq_t>
+    void from_pencils(std::span<const real> u_p,
+                      std::span<real> u,
+                      Op op = {},
+                      device_view<std::uint8_t*> mask = {}) const
+    {
+        Kokkos::Profiling::ScopedRegion region("pencil_layout::from_pencils");
+        Kokkos::parallel_for(policy(num_tiles()),
+                             functor(u_p.data(), u.data(), false, op, mask));
+    }
+
+    // Graph node forms.  A disabled node executes zero teams so the graph's shape does
+    // not depend on whether pencils are in use.
+    template <typename NodeType>
+    auto to_pencils_node(NodeType parent,
+                         const real* u,
+                         real* u_p,
+                         bool enabled = true) const
+    {
+        return parent.then_parallel_for("pencil_transpose",
+                                        policy(enabled ? num_tiles() : 0),
+                                        functor(u, u_p, true, eq));
+    }
+
+    template <typename NodeType, typename Op = eq_t>
+    auto from_pencils_node(NodeType parent,
+                           const real* u_p,
+                           real* u,
+                           Op op = {},
+                           device_view<std::uint8_t*> mask = {},
+                           bool enabled = true) const
+    {
+        return parent.then_parallel_for("pencil_transpose_back",
+                                        policy(enabled ? num_tiles() : 0),
+                                        functor(u_p, u, false, op, mask));
+    }
+
+private:
+    static Kokkos::TeamPolicy<execution_space> policy(integer league)
+    {
+        constexpr int vector_len = 8;
+        return Kokkos::TeamPolicy<execution_space>(league, Kokkos::AUTO, vector_len);
+    }
+};
+
+} // namespace ccs::matrix
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace ccs::matrix
+{
+
+// Storage precision of the block coefficients, selected at runtime with
+// block::precision.  Products are always accumulated in `real`.
+enum class storage_precision { fp64, fp32 };
+
+// Types used by one instantiation of the block kernels: coefficients are loaded as
+// coefficient_type, fields are read and written as field_type and every dot product
+// is carried out in accumulate_type.
+template <typename Coefficient, typename Field = real>
+struct precision_policy {
+    using coefficient_type = Coefficient;
+    using field_type = Field;
+    using accumulate_type = real;
+};
+
+using fp64_policy = precision_policy<real>;
+// fp32 coefficients applied to fp64 fields
+using fp32_coefficients = precision_policy<float>;
+// fp32 coefficients and fields
+using fp32_storage = precision_policy<float, float>;
+
+} // namespace ccs::matrix
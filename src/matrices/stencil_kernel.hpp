@@ -0,0 +1,100 @@
+#pragma once
+
+#include "kokkos_types.hpp"
+
+#include <utility>
+
+namespace ccs::matrix
+{
+
+// Interior stencil kernels.  The production schemes (E2, E2-poly, E4u, E6u, E8u) only
+// use a handful of interior widths so those are compiled with the width known, which
+// lets the coefficients live in registers and the tap loop be fully unrolled.  Any
+// other width falls back to the generic runtime loop.
+enum class stencil_kernel : int { generic = 0, w3 = 3, w5 = 5, w7 = 7, w9 = 9 };
+
+constexpr stencil_kernel select_stencil_kernel(integer width)
+{
+    switch (width) {
+    case 3:
+        return stencil_kernel::w3;
+    case 5:
+        return stencil_kernel::w5;
+    case 7:
+        return stencil_kernel::w7;
+    case 9:
+        return stencil_kernel::w9;
+    default:
+        return stencil_kernel::generic;
+    }
+}
+
+// The dot products below accept coefficients and fields stored in any floating point
+// type (see precision.hpp) and always accumulate in real.
+namespace detail
+{
+template <typename C, typename X, typename I, std::size_t... J>
+KOKKOS_INLINE_FUNCTION real
+fixed_dot(const C* c, const X* x, I stride, std::index_sequence<J...>)
+{
+    // left fold keeps the summation order of the generic loop
+    return (real{0} + ... + (real(c[J]) * x[J * stride]));
+}
+} // namespace detail
+
+// dot product of the W coefficients in c with x, x[stride], ..., x[(W-1)*stride]
+template <int W, typename C, typename X, typename I>
+KOKKOS_INLINE_FUNCTION real fixed_dot(const C* c, const X* x, I stride)
+{
+    return detail::fixed_dot(c, x, stride, std::make_index_sequence<W>{});
+}
+
+template <typename C, typename X, typename I>
+KOKKOS_INLINE_FUNCTION real generic_dot(const C* c, const X* x, I stride, int width)
+{
+    real dot = 0;
+    for (int j = 0; j < width; ++j) dot += real(c[j]) * x[j * stride];
+    return dot;
+}
+
+// Runtime dispatch on a kernel chosen once at setup.  `width` is only used by the
+// generic kernel.
+template <typename C, typename X, typename I>
+KOKKOS_INLINE_FUNCTION real
+stencil_dot(stencil_kernel k, const C* c, const X* x, I stride, int width)
+{
+    switch (k) {
+    case stencil_kernel::w3:
+        return fixed_dot<3>(c, x, stride);
+    case stencil_kernel::w5:
+        return fixed_dot<5>(c, x, stride);
+    case stencil_kernel::w7:
+        return fixed_dot<7>(c, x, stride);
+    case stencil_kernel::w9:
+        return fixed_dot<9>(c, x, stride);
+    default:
+        return generic_dot(c, x, stride, width);
+    }
+}
+
+// Invoke f with std::integral_constant<int, W> for the fixed width kernels, or
+// std::integral_constant<int, 0> for the generic one.  Used to hoist the dispatch
+// out of a parallel loop when the whole loop shares one width.
+template <typename F>
+decltype(auto) with_stencil_kernel(stencil_kernel k, F&& f)
+{
+    switch (k) {
+    case stencil_kernel::w3:
+        return f(std::integral_constant<int, 3>{});
+    case stencil_kernel::w5:
+        return f(std::integral_constant<int, 5>{});
+    case stencil_kernel::w7:
+        return f(std::integral_constant<int, 7>{});
+    case stencil_kernel::w9:
+        return f(std::integral_constant<int, 9>{});
+    default:
+        return f(std::integral_constant<int, 0>{});
+    }
+}
+
+} // namespace ccs::matrix
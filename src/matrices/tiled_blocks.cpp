@@ -0,0 +1,105 @@
+#include "tiled_blocks.hpp"
+
+#include <cassert>
+#include <vector>
+
+namespace ccs::matrix
+{
+
+tiled_blocks::tiled_blocks(std::span<const block* const> blocks,
+                           const index_extents& extents,
+                           int3 tile_size,
+                           std::span<const device_view<real*>> scales)
+    : nb{(int)blocks.size()}, n{extents.extents}, tile{tile_size}
+{
+    assert(nb <= max_blocks);
+    assert(scales.empty() || (int)scales.size() == nb);
+    for (std::size_t b = 0; b < scales.size(); ++b) scale[b] = scales[b];
+    for (int d = 0; d < 3; ++d) {
+        assert(tile[d] > 0);
+        nt[d] = (n[d] + tile[d] - 1) / tile[d];
+    }
+
+    auto tile_of = [this](integer idx) {
+        const integer k = idx % n[2];
+        const integer j = (idx / n[2]) % n[1];
+        const integer i = idx / (integer{n[1]} * n[2]);
+        return ((i / tile[0]) * nt[1] + j / tile[1]) * nt[2] + k / tile[2];
+    };
+
+    // Walk the rows of every line and cut them wherever they cross into a new tile.
+    // The host copy of the metadata is read directly (memory_space is host
+    // accessible).
+    const integer n_tiles = num_tiles();
+    std::vector<std::vector<tile_segment>> buckets(n_tiles * nb);
+    for (int b = 0; b < nb; ++b) {
+        meta[b] = blocks[b]->metadata_view();
+        coeffs[b] = blocks[b]->coefficients_view();
+
+        for (int l = 0; l < (int)meta[b].extent(0); ++l) {
+            const auto& m = meta[b](l);
+            const int total_rows = m.left_rows + m.interior_rows + m.right_rows;
+            auto row_tile = [&](int r) {
+                return tile_of(m.row_offset + integer{r} * m.stride);
+            };
+            int r = 0;
+            while (r < total_rows) {
+                const auto t = row_tile(r);
+                int e = r + 1;
+                while (e < total_rows && row_tile(e) == t) ++e;
+                buckets[t * nb + b].push_back(tile_segment{l, r, e - r});
+                r = e;
+            }
+        }
+    }
+
+    std::vector<int> h_u(buckets.size() + 1);
+    std::vector<tile_segment> h_segs;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        h_segs.insert(h_segs.end(), buckets[i].begin(), buckets[i].end());
+        h_u[i + 1] = h_segs.size();
+    }
+
+    segs = device_view<tile_segment*>("tiled_blocks_segs", h_segs.size());
+    auto h_segs_v = Kokkos::View<const tile_segment*, Kokkos::HostSpace,
+                                 Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        h_segs.data(), h_segs.size());
+    Kokkos::deep_copy(segs, h_segs_v);
+
+    seg_u = device_view<int*>("tiled_blocks_seg_u", h_u.size());
+    auto h_u_v = Kokkos::View<const int*, Kokkos::HostSpace,
+                              Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        h_u.data(), h_u.size());
+    Kokkos::deep_copy(seg_u, h_u_v);
+}
+
+void tiled_blocks::operator()(std::span<const real> x, std::span<real> b) const
+{
+    Kokkos::Profiling::ScopedRegion region("tiled_blocks::operator()");
+    constexpr int vector_len = 8;
+    using team_policy = Kokkos::TeamPolicy<execution_space>;
+    Kokkos::parallel_for(team_policy(num_tiles(), Kokkos::AUTO, vector_len),
+                         functor({x.data(), x.data(), x.data()}, b.data()));
+}
+
+void tiled_blocks::operator()(std::span<const real> x,
+                              std::span<real> b,
+                              const csr& C,
+                              csr::sources sources) const
+{
+    (*this)({x.data(), x.data(), x.data()}, b, C, sources);
+}
+
+void tiled_blocks::operator()(block_sources x,
+                              std::span<real> b,
+                              const csr& C,
+                              csr::sources sources) const
+{
+    Kokkos::Profiling::ScopedRegion region("tiled_blocks::operator()");
+    constexpr int vector_len = 8;
+    using team_policy = Kokkos::TeamPolicy<execution_space>;
+    Kokkos::parallel_for(team_policy(num_tiles(), Kokkos::AUTO, vector_len),
+                         functor(x, b.data(), C.rows_view(), sources));
+}
+
+} // namespace ccs::matrix
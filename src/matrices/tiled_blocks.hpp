@@ -0,0 +1,230 @@
+#pragma once
+
+#include "block.hpp"
+#include "csr.hpp"
+#include "index_extents.hpp"
+
+#include "kokkos_types.hpp"
+
+#include <Kokkos_Graph.hpp>
+
+#include <array>
+#include <span>
+
+namespace ccs::matrix
+{
+
+// The rows [first_row, first_row + rows) of block line `line` that lie in one tile.
+struct tile_segment {
+    int line;
+    int first_row;
+    int rows;
+};
+
+// Sum of up to three blocks (the x, y and z block rows of a laplacian) evaluated tile
+// by tile.  The mesh is cut into 3D tiles and each team owns one tile: it zeroes the
+// tile's outputs and then adds the rows of every block that land in the tile, so the
+// output is written while it is cache resident and without a separate zero pass.
+// The rows of each block are split into per-tile segments at construction.  A csr
+// correction sharing the output space can be folded into the same pass: it is added
+// to the tile's points after the blocks.  Each block's rows may be weighted by a
+// per-output scale, giving sum_b scale_b * (A_b x), and each block may read its own
+// input, giving sum_b A_b x_b (the three components of a divergence).
+class tiled_blocks
+{
+public:
+    static constexpr int max_blocks = 3;
+    // input of each block
+    using block_sources = std::array<const real*, max_blocks>;
+
+private:
+    int nb = 0;
+    device_view<inner_block_meta*> meta[max_blocks];
+    device_view<real*> coeffs[max_blocks];
+    // output scale of each block, empty when unscaled
+    device_view<real*> scale[max_blocks];
+    // segments grouped by tile and then by block; those of block b in tile t are
+    // [seg_u(t * nb + b), seg_u(t * nb + b + 1))
+    device_view<tile_segment*> segs;
+    device_view<int*> seg_u;
+    int3 n{};
+    int3 tile{};
+    int3 nt{};
+
+public:
+    tiled_blocks() = default;
+
+    // `blocks` share the output space described by `extents`.  `scales`, if given,
+    // holds one output scale per block (an empty view leaves that block unscaled).
+    tiled_blocks(std::span<const block* const> blocks,
+                 const index_extents& extents,
+                 int3 tile_size = {8, 8, 64},
+                 std::span<const device_view<real*>> scales = {});
+
+    integer num_tiles() const { return integer{nt[0]} * nt[1] * nt[2]; }
+    integer num_segments() const { return segs.extent(0); }
+    int3 tile_extents() const { return tile; }
+
+    // Named functor for the tiled kernel, shared by operator() and graph_node.
+    struct matvec_functor {
+        device_view<inner_block_meta*> meta[max_blocks];
+        device_view<real*> coeffs[max_blocks];
+        device_view<real*> scale[max_blocks];
+        device_view<tile_segment*> segs;
+        device_view<int*> seg_u;
+        int nb;
+        int3 n, tile, nt;
+        const real* x_ptr[max_blocks];
+        real* b_ptr;
+        // optional correction, skipped when it has no rows
+        csr::row_view corr;
+        csr::sources corr_x;
+
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        using member_type = typename team_policy::member_type;
+
+        // one past the last index of the tile starting at `first` in direction d
+        KOKKOS_INLINE_FUNCTION int last(int first, int d) const
+        {
+            return first + tile[d] < n[d] ? first + tile[d] : n[d];
+        }
+
+        KOKKOS_INLINE_FUNCTION
+        void operator()(const member_type& team) const
+        {
+            const int t = team.league_rank();
+            const int ti = t / (nt[1] * nt[2]);
+            const int tj = (t / nt[2]) % nt[1];
+            const int tk = t % nt[2];
+
+            const int i0 = ti * tile[0], i1 = last(i0, 0);
+            const int j0 = tj * tile[1], j1 = last(j0, 1);
+            const int k0 = tk * tile[2], k1 = last(k0, 2);
+            const int nj = j1 - j0;
+
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team, (i1 - i0) * nj), [&](int ij) {
+                    const integer base =
+                        (integer{i0 + ij / nj} * n[1] + j0 + ij % nj) * n[2];
+                    Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, k0, k1),
+                                         [&](int k) { b_ptr[base + k] = 0; });
+                });
+
+            // rows of different lines in one block never overlap but every block
+            // writes the whole tile, so the blocks are applied one after the other
+            for (int b = 0; b < nb; ++b) {
+                team.team_barrier();
+                const auto m_b = meta[b];
+                const real* c = coeffs[b].data();
+                const real* x = x_ptr[b];
+                const real* sc = scale[b].data();
+                const int first = seg_u(t * nb + b);
+                const int end = seg_u(t * nb + b + 1);
+                Kokkos::parallel_for(
+                    Kokkos::TeamThreadRange(team, first, end), [&](int s) {
+                        const auto seg = segs(s);
+                        const auto m = m_b(seg.line);
+                        Kokkos::parallel_for(
+                            Kokkos::ThreadVectorRange(team, seg.rows), [&](int r) {
+                                int out_idx;
+                                const real v =
+                                    row_dot(m, c, x, seg.first_row + r, out_idx);
+                                b_ptr[out_idx] += sc ? sc[out_idx] * v : v;
+                            });
+                    });
+            }
+
+            if (corr.nr == 0) return;
+            team.team_barrier();
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team, (i1 - i0) * nj), [&](int ij) {
+                    const integer base =
+                        (integer{i0 + ij / nj} * n[1] + j0 + ij % nj) * n[2];
+                    Kokkos::parallel_for(
+                        Kokkos::ThreadVectorRange(team, k0, k1), [&](int k) {
+                            b_ptr[base + k] += corr.dot(base + k, corr_x);
+                        });
+                });
+        }
+    };
+
+    matvec_functor functor(block_sources x,
+                           real* b_ptr,
+                           csr::row_view corr = {},
+                           csr::sources corr_x = {}) const
+    {
+        return {{meta[0], meta[1], meta[2]},
+                {coeffs[0], coeffs[1], coeffs[2]},
+                {scale[0], scale[1], scale[2]},
+                segs,
+                seg_u,
+                nb,
+                n,
+                tile,
+                nt,
+                {x[0], x[1], x[2]},
+                b_ptr,
+                corr,
+                corr_x};
+    }
+
+    // b = sum of the blocks applied to x.  Every entry of b is written.
+    void operator()(std::span<const real> x, std::span<real> b) const;
+
+    // b = sum of the blocks applied to x + C applied to `sources`, in one pass.
+    void operator()(std::span<const real> x,
+                    std::span<real> b,
+                    const csr& C,
+                    csr::sources sources) const;
+
+    // b = sum_b A_b x[b] + C applied to `sources`, in one pass.
+    void operator()(block_sources x,
+                    std::span<real> b,
+                    const csr& C,
+                    csr::sources sources) const;
+
+    // Chain a graph node performing operator().  A disabled node executes zero teams,
+    // which keeps the graph's shape (and node types) independent of runtime options.
+    template <typename NodeType>
+    auto graph_node(NodeType parent,
+                    const real* x_ptr,
+                    real* b_ptr,
+                    bool enabled = true) const
+    {
+        constexpr int vector_len = 8;
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        return parent.then_parallel_for(
+            "tiled_blocks_matvec",
+            team_policy(enabled ? num_tiles() : 0, Kokkos::AUTO, vector_len),
+            functor({x_ptr, x_ptr, x_ptr}, b_ptr));
+    }
+
+    template <typename NodeType>
+    auto graph_node(NodeType parent,
+                    const real* x_ptr,
+                    real* b_ptr,
+                    const csr& C,
+                    csr::sources sources,
+                    bool enabled = true) const
+    {
+        return graph_node(parent, {x_ptr, x_ptr, x_ptr}, b_ptr, C, sources, enabled);
+    }
+
+    template <typename NodeType>
+    auto graph_node(NodeType parent,
+                    block_sources x,
+                    real* b_ptr,
+                    const csr& C,
+                    csr::sources sources,
+                    bool enabled = true) const
+    {
+        constexpr int vector_len = 8;
+        using team_policy = Kokkos::TeamPolicy<execution_space>;
+        return parent.then_parallel_for(
+            "tiled_blocks_matvec",
+            team_policy(enabled ? num_tiles() : 0, Kokkos::AUTO, vector_len),
+            functor(x, b_ptr, C.rows_view(), sources));
+    }
+};
+
+} // namespace ccs::matrix
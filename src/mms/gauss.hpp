@@ -1,6 +1,7 @@
 #pragma once
 
 #include "types.hpp"
+#include <cmath>
 #include <span>
 #include <vector>
 
@@ -27,6 +28,44 @@ struct gauss {
           frequency{frequency.begin(), frequency.end()}
     {
     }
+
+    // Each gaussian is a separable term amplitude * cos(frequency * t) * g(x), with g
+    // the unit gaussian in the first Dims coordinates
+    int separable_terms() const { return static_cast<int>(center.size()); }
+
+    real time_factor(int i, real time) const
+    {
+        return amplitude[i] * std::cos(time * frequency[i]);
+    }
+
+    real time_factor_ddt(int i, real time) const
+    {
+        return -amplitude[i] * frequency[i] * std::sin(time * frequency[i]);
+    }
+
+protected:
+    template <int Dims>
+    real unit_gaussian(int i, const real3& loc) const
+    {
+        real e = 0;
+        for (int d = 0; d < Dims; ++d) {
+            const real r = (loc[d] - center[i][d]) / variance[i][d];
+            e += r * r;
+        }
+        return std::exp(-0.5 * e);
+    }
+
+    // lap g = g * sum_d ((x_d - c_d)^2 / v_d^4 - 1 / v_d^2)
+    template <int Dims>
+    real unit_gaussian_laplacian(int i, const real3& loc) const
+    {
+        real l = 0;
+        for (int d = 0; d < Dims; ++d) {
+            const real r = (loc[d] - center[i][d]) / variance[i][d];
+            l += (r * r - 1) / (variance[i][d] * variance[i][d]);
+        }
+        return unit_gaussian<Dims>(i, loc) * l;
+    }
 };
 
 // factories
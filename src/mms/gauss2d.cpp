@@ -59,6 +59,13 @@ struct gauss2d : gauss {
         return sol;
     }
 
+    real space_factor(int i, const real3& loc) const { return unit_gaussian<2>(i, loc); }
+
+    real space_factor_laplacian(int i, const real3& loc) const
+    {
+        return unit_gaussian_laplacian<2>(i, loc);
+    }
+
     // This is a scalar field
     real divergence(real, const real3&) const { return 0.0; }
 
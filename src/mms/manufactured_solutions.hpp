@@ -22,6 +22,19 @@ concept ManufacturedSolution = requires(const M& ms, real time, const real3& loc
     { ms.divergence(time, loc) } -> std::same_as<real>;
     { ms.laplacian(time, loc) } -> std::same_as<real>;
 };
+
+// A solution that is a sum of separable terms, u(t, x) = sum_k f_k(t) g_k(x).  Sources
+// built from ddt and laplacian can then tabulate g_k and lap g_k once and only
+// evaluate the time factors f_k and f'_k as time advances.
+template <typename M>
+concept SeparableSolution = ManufacturedSolution<M> &&
+    requires(const M& ms, int k, real time, const real3& loc) {
+    { ms.separable_terms() } -> std::same_as<int>;
+    { ms.time_factor(k, time) } -> std::same_as<real>;
+    { ms.time_factor_ddt(k, time) } -> std::same_as<real>;
+    { ms.space_factor(k, loc) } -> std::same_as<real>;
+    { ms.space_factor_laplacian(k, loc) } -> std::same_as<real>;
+};
 // clang-format on
 
 class manufactured_solution
@@ -52,6 +65,13 @@ class manufactured_solution
         // to call concurrently from multiple threads (e.g. pure-math Gauss MMS).
         // Returns false for Lua-backed MMS which uses a non-thread-safe Lua state.
         virtual bool is_thread_safe() const { return true; }
+
+        // Number of separable terms, or 0 if the solution is not known to be separable
+        virtual int separable_terms() const { return 0; }
+        virtual real time_factor(int, real) const { return 0.0; }
+        virtual real time_factor_ddt(int, real) const { return 0.0; }
+        virtual real space_factor(int, const real3&) const { return 0.0; }
+        virtual real space_factor_laplacian(int, const real3&) const { return 0.0; }
     };
 
     template <ManufacturedSolution M>
@@ -94,6 +114,46 @@ class manufactured_solution
         {
             return m.laplacian(time, loc);
         }
+
+        int separable_terms() const override
+        {
+            if constexpr (SeparableSolution<M>)
+                return m.separable_terms();
+            else
+                return 0;
+        }
+
+        real time_factor(int k, real time) const override
+        {
+            if constexpr (SeparableSolution<M>)
+                return m.time_factor(k, time);
+            else
+                return 0.0;
+        }
+
+        real time_factor_ddt(int k, real time) const override
+        {
+            if constexpr (SeparableSolution<M>)
+                return m.time_factor_ddt(k, time);
+            else
+                return 0.0;
+        }
+
+        real space_factor(int k, const real3& loc) const override
+        {
+            if constexpr (SeparableSolution<M>)
+                return m.space_factor(k, loc);
+            else
+                return 0.0;
+        }
+
+        real space_factor_laplacian(int k, const real3& loc) const override
+        {
+            if constexpr (SeparableSolution<M>)
+                return m.space_factor_laplacian(k, loc);
+            else
+                return 0.0;
+        }
     };
 
     any_sol* s;
@@ -145,6 +205,35 @@ public:
 
         bool is_thread_safe() const { return s && s->is_thread_safe(); }
 
+        // Number of terms f_k(t) g_k(x) the solution is a sum of, or 0 if it does not
+        // advertise a separable form.  The factors below are only meaningful for
+        // 0 <= k < separable_terms().
+        int separable_terms() const { return s ? s->separable_terms() : 0; }
+
+        real time_factor(int k, real time) const
+        {
+            assert(s);
+            return s->time_factor(k, time);
+        }
+
+        real time_factor_ddt(int k, real time) const
+        {
+            assert(s);
+            return s->time_factor_ddt(k, time);
+        }
+
+        real space_factor(int k, const real3& loc) const
+        {
+            assert(s);
+            return s->space_factor(k, loc);
+        }
+
+        real space_factor_laplacian(int k, const real3& loc) const
+        {
+            assert(s);
+            return s->space_factor_laplacian(k, loc);
+        }
+
         static std::optional<manufactured_solution>
         from_lua(const sol::table&, int dims = 3, const logs& = {});
 
@@ -1,6 +1,7 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include "gauss.hpp"
 #include "manufactured_solutions.hpp"
 #include "std_matchers.hpp"
 
@@ -182,6 +183,7 @@ TEST_CASE("lua")
     REQUIRE(!!ms_opt);
     auto& ms = *ms_opt;
     REQUIRE(ms);
+    REQUIRE(ms.separable_terms() == 0);
 
     const real3 loc{3.0, -0.5, -2.0};
     const real time = 8.0;
@@ -200,3 +202,29 @@ TEST_CASE("lua")
     REQUIRE_THAT(ms.gradient(time, loc), Approx(g));
     REQUIRE(ms.laplacian(time, loc) == Catch::Approx(t["lap"](time, loc)));
 }
+
+TEST_CASE("gaussian separable form")
+{
+    const std::vector<real3> center{{1, 1.2, -3.5}, {2, -1, 0.5}};
+    const std::vector<real3> variance{{0.5, 0.8, 2.0}, {0.3, 0.6, 0.4}};
+    const std::vector<real> amplitude{2, 1.2};
+    const std::vector<real> frequency{0.1, 0.2};
+
+    for (auto build : {build_ms_gauss1d, build_ms_gauss2d, build_ms_gauss3d}) {
+        const auto ms = build(center, variance, amplitude, frequency);
+        REQUIRE(ms.separable_terms() == 2);
+
+        for (auto loc : {real3{3.0, -0.5, -2.0}, real3{1.9, -0.7, 0.2}}) {
+            const real time = 8.0;
+            real u = 0, ddt = 0, lap = 0;
+            for (int k = 0; k < ms.separable_terms(); ++k) {
+                u += ms.time_factor(k, time) * ms.space_factor(k, loc);
+                ddt += ms.time_factor_ddt(k, time) * ms.space_factor(k, loc);
+                lap += ms.time_factor(k, time) * ms.space_factor_laplacian(k, loc);
+            }
+            REQUIRE(u == Catch::Approx(ms(time, loc)));
+            REQUIRE(ddt == Catch::Approx(ms.ddt(time, loc)));
+            REQUIRE(lap == Catch::Approx(ms.laplacian(time, loc)));
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include "advection.hpp"
+
+#include "io/logging.hpp"
+
+#include <Kokkos_Profiling_ScopedRegion.hpp>
+
+#include <fmt/ranges.h>
+#include <string>
+#include <vector>
+
+namespace ccs
+{
+advection::advection(const mesh& m,
+                     const stencil& st,
+                     const bcs::Grid& grid_bcs,
+                     const bcs::Object& obj_bcs,
+                     const std::array<scalar_view, 3>& a,
+                     const logs& build_logger,
+                     int3 tile,
+                     const operator_cache& cache)
+{
+    logs logger{build_logger, "advection", "advection.csv"};
+    logger.set_pattern("%v");
+    auto st_info = st.query_max();
+    std::vector<std::string> hdr(st_info.t - 1, "wall,psi");
+    logger(spdlog::level::info,
+           "timestamp,deriv,interp_dir,ic,y,psi,{}",
+           fmt::join(hdr, ","));
+    logger.set_pattern("%Y-%m-%d %H:%M:%S.%f,%v");
+
+    auto dxyz = derivative::xyz(m, st, grid_bcs, obj_bcs, logger, cache);
+    dx = MOVE(dxyz[0]);
+    dy = MOVE(dxyz[1]);
+    dz = MOVE(dxyz[2]);
+    ex = m.extents();
+
+    const std::array<const derivative*, 3> d{&dx, &dy, &dz};
+    for (int dir = 0; dir < 3; ++dir) {
+        const auto& a_d = a[dir].D;
+        a_D[dir] = device_view<real*>("advection_a", a_d.size());
+        Kokkos::deep_copy(a_D[dir],
+                          Kokkos::View<const real*, Kokkos::HostSpace,
+                                       Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+                              a_d.data(), a_d.size()));
+    }
+
+    const auto blocks = std::array<const matrix::block*, 3>{
+        &dx.block_matrix(), &dy.block_matrix(), &dz.block_matrix()};
+    tiles = matrix::tiled_blocks{blocks, ex, tile, a_D};
+
+    // Corrections with the coefficients folded into their rows.  Source ids follow
+    // the comment on corr_D and corr_R.
+    std::array<matrix::csr, 3> B;
+    for (int dir = 0; dir < 3; ++dir)
+        B[dir] = d[dir]->boundary_matrix().scaled_rows(a[dir].D);
+    corr_D = matrix::csr::merge(std::array{&B[0], &B[1], &B[2]});
+
+    for (int r = 0; r < 3; ++r) {
+        std::array<matrix::csr, 6> parts;
+        for (int dir = 0; dir < 3; ++dir) {
+            const auto& a_r = r == 0 ? a[dir].Rx : r == 1 ? a[dir].Ry : a[dir].Rz;
+            const auto [f, b] = d[dir]->cut_matrices(r);
+            parts[2 * dir] = f->scaled_rows(a_r);
+            parts[2 * dir + 1] = b->scaled_rows(a_r);
+        }
+        corr_R[r] = matrix::csr::merge(
+            std::array{
+                &parts[0], &parts[1], &parts[2], &parts[3], &parts[4], &parts[5]},
+            std::array{0, 1, 0, 1, 0, 1});
+    }
+}
+
+std::function<void(scalar_span)> advection::operator()(scalar_view u) const
+{
+    return [this, u](scalar_span du) {
+        Kokkos::Profiling::ScopedRegion region("advection::operator()");
+        const auto f = fused_R(corr_R, u, du);
+        tiles(u.D, du.D, corr_D, {u.Rx.data(), u.Ry.data(), u.Rz.data()});
+        Kokkos::parallel_for(Kokkos::RangePolicy<execution_space>(0, f.size()), f);
+        Kokkos::fence("advection::operator() complete");
+    };
+}
+
+void advection::build_graph(scalar_view u, scalar_span du)
+{
+    graph_ = Kokkos::Experimental::create_graph<execution_space>(
+        [&](auto root) { add_graph_nodes(root, u, du); });
+
+    graph_->instantiate();
+}
+
+void advection::submit_graph()
+{
+    Kokkos::Profiling::ScopedRegion region("advection::submit_graph()");
+    graph_->submit();
+    Kokkos::fence("advection::submit_graph() complete");
+}
+
+} // namespace ccs
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "derivative.hpp"
+#include "fields/scalar.hpp"
+#include "fused_corrections.hpp"
+#include "matrices/tiled_blocks.hpp"
+
+#include <Kokkos_Graph.hpp>
+#include <array>
+#include <optional>
+
+namespace ccs
+{
+
+// du = a_x * du/dx + a_y * du/dy + a_z * du/dz for a fixed coefficient field a.
+// The coefficients are folded into the operator at construction so the gradient is
+// never stored: the block rows of the three derivatives are applied tile by tile
+// (matrix::tiled_blocks) with each direction's output scaled by a_d.D, the cut-cell
+// corrections are merged with their rows pre-scaled by a_d, and a single pass
+// assigns Rx, Ry and Rz.  Every entry of du is written.
+class advection
+{
+    derivative dx;
+    derivative dy;
+    derivative dz;
+    index_extents ex;
+    // a_d.D, scaling the block rows of direction d
+    device_view<real*> a_D[3];
+    matrix::tiled_blocks tiles;
+    // B of each direction scaled by a_d.D, reading {u.Rx, u.Ry, u.Rz}, and for each R
+    // space the Bf/Br pairs of all directions scaled by a_d.R*, reading {u.D, u.R*}
+    matrix::csr corr_D;
+    matrix::csr corr_R[3];
+
+    // Pre-built graph for submit_graph().
+    std::optional<Kokkos::Experimental::Graph<execution_space>> graph_;
+
+public:
+    advection() = default;
+
+    // a[d] is the coefficient of the derivative in direction d.  `tile` is the tile
+    // extent of the D-space pass, see laplacian::kernel.  The derivatives are read from
+    // `cache` when it holds them.
+    advection(const mesh&,
+              const stencil&,
+              const bcs::Grid&,
+              const bcs::Object&,
+              const std::array<scalar_view, 3>& a,
+              const logs& = {},
+              int3 tile = {8, 8, 64},
+              const operator_cache& = {});
+
+    std::function<void(scalar_span)> operator()(scalar_view) const;
+
+    // Build a pre-instantiated graph.
+    void build_graph(scalar_view u, scalar_span du);
+
+    // Submit the pre-built graph.
+    void submit_graph();
+
+    // Add advection nodes to an existing graph: one tiled node writing du.D and one
+    // node writing du.Rx, du.Ry and du.Rz, both children of parent.  Returns a
+    // when_all of the two.
+    template <typename NodeT>
+    auto add_graph_nodes(NodeT parent, scalar_view u, scalar_span du) const
+    {
+        const auto f = fused_R(corr_R, u, du);
+        auto d = tiles.graph_node(parent,
+                                  u.D.data(),
+                                  du.D.data(),
+                                  corr_D,
+                                  {u.Rx.data(), u.Ry.data(), u.Rz.data()});
+        auto r = parent.then_parallel_for(
+            "adv_fused_R", Kokkos::RangePolicy<execution_space>(0, f.size()), f);
+        return Kokkos::Experimental::when_all(d, r);
+    }
+};
+} // namespace ccs
@@ -0,0 +1,148 @@
+#include "advection.hpp"
+#include "gradient.hpp"
+
+#include "fields/scalar.hpp"
+#include "stencils/stencil.hpp"
+
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include <ranges>
+
+#include <Kokkos_Core.hpp>
+
+// Custom main: Kokkos must be initialized before parallel_for calls.
+int main(int argc, char* argv[])
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    return Catch::Session().run(argc, argv);
+}
+
+using namespace ccs;
+using Catch::Matchers::Approx;
+
+const std::vector<real> alpha{
+    -1.47956280234494, 0.261900367793859, -0.145072532538541, -0.224665713988644};
+
+constexpr auto f2 = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return x * (y + z) + y * (x + z) + z * (x + y) + 3 * x * y * z;
+});
+
+// advection coefficients
+constexpr auto ax = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return 1 + x * y - z;
+});
+
+constexpr auto ay = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return -0.5 + x * z;
+});
+
+constexpr auto az = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return 2 - y;
+});
+
+// Owning scalar: 4 vectors with implicit conversion to scalar_view/scalar_span.
+struct owned_scalar {
+    std::vector<real> d_vec, rx_vec, ry_vec, rz_vec;
+
+    operator scalar_view() const { return {d_vec, rx_vec, ry_vec, rz_vec}; }
+    operator scalar_span() { return {d_vec, rx_vec, ry_vec, rz_vec}; }
+};
+
+owned_scalar make_scalar(const mesh& m, real val = 0)
+{
+    return {std::vector<real>(m.size(), val),
+            std::vector<real>(m.Rx().size(), val),
+            std::vector<real>(m.Ry().size(), val),
+            std::vector<real>(m.Rz().size(), val)};
+}
+
+// Evaluate a view adaptor at all mesh locations, producing an owned_scalar.
+owned_scalar eval_at_mesh(const mesh& m, auto va)
+{
+    auto result = make_scalar(m);
+    auto pos = std::views::transform(&mesh_object_info::position);
+    std::ranges::copy(ccs::cartesian_product(m.x(), m.y(), m.z()) | va,
+                      result.d_vec.begin());
+    std::ranges::copy(m.Rx() | pos | va, result.rx_vec.begin());
+    std::ranges::copy(m.Ry() | pos | va, result.ry_vec.begin());
+    std::ranges::copy(m.Rz() | pos | va, result.rz_vec.begin());
+    return result;
+}
+
+// a_x * du_x + a_y * du_y + a_z * du_z, component by component
+owned_scalar dot(const std::array<owned_scalar, 3>& a,
+                 const std::array<owned_scalar, 3>& du)
+{
+    auto res = du[0];
+    for (auto c : {&owned_scalar::d_vec,
+                   &owned_scalar::rx_vec,
+                   &owned_scalar::ry_vec,
+                   &owned_scalar::rz_vec})
+        for (std::size_t i = 0; i < (res.*c).size(); ++i)
+            (res.*c)[i] = (a[0].*c)[i] * (du[0].*c)[i] + (a[1].*c)[i] * (du[1].*c)[i] +
+                          (a[2].*c)[i] * (du[2].*c)[i];
+    return res;
+}
+
+void require_same(const owned_scalar& a, const owned_scalar& b)
+{
+    REQUIRE_THAT(a.d_vec, Approx(b.d_vec));
+    REQUIRE_THAT(a.rx_vec, Approx(b.rx_vec));
+    REQUIRE_THAT(a.ry_vec, Approx(b.ry_vec));
+    REQUIRE_THAT(a.rz_vec, Approx(b.rz_vec));
+}
+
+// advection must agree with the gradient dotted with the coefficients, writing every
+// entry of du.  The sphere leaves enough points between it and the walls that the
+// E2_1 boundary closures of a line do not overlap.
+void check_against_gradient(const mesh& m, const bcs::Grid& gridBcs, int3 tile)
+{
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto st = stencils::make_E2_1(alpha);
+
+    auto u = eval_at_mesh(m, f2);
+    const std::array a{eval_at_mesh(m, ax), eval_at_mesh(m, ay), eval_at_mesh(m, az)};
+
+    auto grad = gradient{m, st, gridBcs, objectBcs};
+    std::array du{make_scalar(m), make_scalar(m), make_scalar(m)};
+    grad(u)(du[0], du[1], du[2]);
+    const auto expected = dot(a, du);
+
+    auto adv = advection{m, st, gridBcs, objectBcs, {a[0], a[1], a[2]}, {}, tile};
+
+    auto out = make_scalar(m, 7.0);
+    scalar_span out_sp = out;
+    out_sp = adv(u);
+    require_same(out, expected);
+
+    auto out_graph = make_scalar(m, 7.0);
+    scalar_span out_graph_sp = out_graph;
+    adv.build_graph(u, out_graph_sp);
+    adv.submit_graph();
+    require_same(out_graph, expected);
+}
+
+TEST_CASE("matches gradient")
+{
+    auto m = mesh{index_extents{int3{25, 25, 25}},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 1.25}, 0.15)}};
+
+    for (auto tile : {int3{8, 8, 64}, int3{4, 5, 6}})
+        check_against_gradient(m, bcs::Grid{bcs::dd, bcs::ff, bcs::fd}, tile);
+}
+
+TEST_CASE("2D matches gradient")
+{
+    auto m = mesh{index_extents{int3{25, 26, 1}},
+                  domain_extents{.min = {0.1, 0.2, 0}, .max = {1, 2, 0}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 0}, 0.15)}};
+
+    check_against_gradient(m, bcs::Grid{bcs::dd, bcs::fd, bcs::ff}, {8, 8, 1});
+}
@@ -3,9 +3,13 @@
 #include <Kokkos_Profiling_ScopedRegion.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <functional>
+#include <iterator>
 #include <ranges>
 #include <span>
+#include <string>
 #include <vector>
 
 namespace ccs
@@ -156,28 +160,34 @@ struct OB_builder {
     }
 };
 
+// The rows and log messages of the cut points [first, last) of R(r)
+struct cut_chunk {
+    OB_builder builder;
+    std::vector<std::string> log;
+};
+
+bool has_cut_rows(int r, const mesh& m, const bcs::Object& obj_bcs)
+{
+    return m.R(r).size() > 0 &&
+           !std::ranges::all_of(obj_bcs, [](auto bc) { return bc == bcs::Dirichlet; });
+}
+
 void cut_discretization(int r,
                         int dir,
                         const mesh& m,
                         const stencil& st,
-                        const bcs::Grid& grid_bcs,
                         const bcs::Object& obj_bcs,
-                        matrix::csr& O,
-                        matrix::csr& B,
-                        std::span<const real> interior,
-                        const logs& logger)
+                        integer first,
+                        integer last,
+                        bool logging,
+                        cut_chunk& out)
 {
     const auto shapes = m.R(r);
-    const auto sz = shapes.size();
-
-    if (sz == 0 ||
-        std::ranges::all_of(obj_bcs, [](auto bc) { return bc == bcs::Dirichlet; }))
-        return; // quick exit'
 
     auto [p, rmax, tmax, ex_max] = st.query_max();
     auto h = m.h(dir);
 
-    OB_builder builder{};
+    auto& builder = out.builder;
 
     // allocate maximum amount of memory required by any boundary conditions
     std::vector<real> c(rmax * tmax);
@@ -187,7 +197,7 @@ void cut_discretization(int r,
 
     if (dir == r) {
         // no interpolation needed for this case
-        for (integer shape_row = 0; shape_row < (integer)sz; ++shape_row) {
+        for (integer shape_row = first; shape_row < last; ++shape_row) {
             const auto& obj = shapes[shape_row];
             auto bc_t = obj_bcs[obj.shape_id];
             // nothing to do for dirichlet
@@ -207,7 +217,7 @@ void cut_discretization(int r,
             }
         }
     } else {
-        for (integer shape_row = 0; shape_row < (integer)sz; ++shape_row) {
+        for (integer shape_row = first; shape_row < last; ++shape_row) {
             const auto& obj = shapes[shape_row];
             auto bc_t = obj_bcs[obj.shape_id];
             // nothing to do for dirichlet
@@ -232,7 +242,7 @@ void cut_discretization(int r,
 
             // prepare the log message if we are logging
             std::string msg{};
-            if (logger)
+            if (logging)
                 msg = fmt::format("{},{},{},{},{}", dir, r, shape_row, y, obj.psi);
 
             for (auto&& v : c_line) {
@@ -248,12 +258,9 @@ void cut_discretization(int r,
                 ++cp[dir];
             }
 
-            logger(spdlog::level::info, msg);
+            if (logging) out.log.push_back(MOVE(msg));
         }
     }
-
-    // construct ray in 'dir` emanative from R(r)
-    builder.to_csr(r, O, B, sz);
 }
 
 struct submatrix_size {
@@ -302,15 +309,47 @@ struct submatrix_size {
     integer right_row(integer row = 0) const { return last_row + stride * row; }
 };
 
+// A dense boundary closure of one line.  The assembly tasks only fill plain vectors;
+// the matrices, which own Kokkos views, are built afterwards on the calling thread.
+struct closure {
+    integer rows = 0;
+    integer columns = 0;
+    std::vector<real> v;
+    flag f = 0;
+
+    matrix::dense to_dense() const
+    {
+        auto d = matrix::dense{rows, columns, v};
+        if (f) d.flags(f);
+        return d;
+    }
+};
+
+// The arguments of block::builder::add_inner_block for one line
+struct line_rows {
+    integer columns;
+    integer row_offset;
+    integer col_offset;
+    integer stride;
+    closure left;
+    integer n_interior;
+    closure right;
+};
+
+// The block rows and B/N entries of a range of lines
+struct domain_chunk {
+    std::vector<line_rows> O;
+    matrix::csr::builder B;
+    matrix::csr::builder N;
+};
+
 void domain_discretization(int dir,
                            const mesh& m,
                            const stencil& st,
                            const bcs::Grid& grid_bcs,
                            const bcs::Object& obj_bcs,
-                           matrix::block& O,
-                           matrix::csr& B,
-                           matrix::csr& N,
-                           std::span<const real> interior)
+                           std::span<const line> lines,
+                           domain_chunk& out)
 {
     // query the stencil and allocate memory
     auto [p, rmax, tmax, ex_max] = st.query_max();
@@ -321,17 +360,17 @@ void domain_discretization(int dir,
     std::vector<real> right(rmax * tmax);
     std::vector<real> extra(ex_max);
 
-    auto B_builder = matrix::csr::builder();
-    auto O_builder = matrix::block::builder();
-    auto N_builder = matrix::csr::builder();
+    auto& B_builder = out.B;
+    auto& N_builder = out.N;
+    const auto faces = neumann_faces{m.extents(), grid_bcs};
 
-    for (auto [stride, start, end] : m.lines(dir)) {
+    for (auto [stride, start, end] : lines) {
         if (m.dirichlet_line(start.mesh_coordinate, dir, grid_bcs)) continue;
 
         // start with assumption of square matrix and adjust based on boundary conditions
         auto sub = submatrix_size{dir, stride, start, end, m};
 
-        auto leftMat = matrix::dense{};
+        auto leftMat = closure{};
 
         if (const auto& obj = start.object; obj) {
             const auto id = obj->objectID;
@@ -349,13 +388,12 @@ void domain_discretization(int dir,
             auto lc = std::span{left}.subspan(s * tLeft);
 
             // Build dense matrix: skip first column of each row
-            std::vector<real> dense_data;
-            dense_data.reserve(rLeft * (tLeft - 1));
+            leftMat = closure{rLeft, tLeft - 1};
+            leftMat.v.reserve(rLeft * (tLeft - 1));
             for (int row = 0; row < rLeft; ++row) {
                 auto row_span = lc.subspan(row * tLeft + 1, tLeft - 1);
-                dense_data.insert(dense_data.end(), row_span.begin(), row_span.end());
+                leftMat.v.insert(leftMat.v.end(), row_span.begin(), row_span.end());
             }
-            leftMat = matrix::dense{rLeft, tLeft - 1, dense_data};
 
             sub.remove_left_row_col();
 
@@ -368,19 +406,20 @@ void domain_discretization(int dir,
             auto&& [pLeft, rLeft, tLeft, exLeft] = st.query(grid_bcs[dir].left);
             st.nbs(h, grid_bcs[dir].left, 1.0, false, left, extra);
 
-            leftMat = matrix::dense{rLeft, tLeft, left};
+            leftMat = closure{rLeft, tLeft, {left.begin(), left.begin() + rLeft * tLeft}};
             if (grid_bcs[dir].left == bcs::Dirichlet) {
                 sub.remove_left_row();
-                leftMat.flags(ldd);
+                leftMat.f = ldd;
             } else if (grid_bcs[dir].left == bcs::Neumann) {
-                // add data to N matrix
+                // add data to N matrix, reading the face slot of the line's first point
+                const auto col = faces.slot(dir, 0, start.mesh_coordinate);
                 for (int row = 0; row < exLeft; row++) {
-                    N_builder.add_point(sub.left_row(row), sub.left_row(), extra[row]);
+                    N_builder.add_point(sub.left_row(row), col, extra[row]);
                 }
             }
         }
 
-        auto rightMat = matrix::dense{};
+        auto rightMat = closure{};
 
         if (const auto& obj = end.object; obj) {
             const auto id = obj->objectID;
@@ -395,13 +434,12 @@ void domain_discretization(int dir,
             auto rc = std::span{right}.subspan(0, rRight * tRight);
 
             // Build dense matrix: take first (tRight-1) columns of each row
-            std::vector<real> dense_data;
-            dense_data.reserve(rRight * (tRight - 1));
+            rightMat = closure{rRight, tRight - 1};
+            rightMat.v.reserve(rRight * (tRight - 1));
             for (int row = 0; row < rRight; ++row) {
                 auto row_span = rc.subspan(row * tRight, tRight - 1);
-                dense_data.insert(dense_data.end(), row_span.begin(), row_span.end());
+                rightMat.v.insert(rightMat.v.end(), row_span.begin(), row_span.end());
             }
-            rightMat = matrix::dense{rRight, tRight - 1, dense_data};
             sub.remove_right_row_col();
 
             // add points to B (last element of each row)
@@ -415,88 +453,352 @@ void domain_discretization(int dir,
             auto&& [pRight, rRight, tRight, exRight] = st.query(grid_bcs[dir].right);
             st.nbs(h, grid_bcs[dir].right, 1.0, true, right, extra);
 
-            rightMat = matrix::dense{rRight, tRight, right};
+            rightMat =
+                closure{rRight, tRight, {right.begin(), right.begin() + rRight * tRight}};
             if (grid_bcs[dir].right == bcs::Dirichlet) {
                 sub.remove_right_row();
-                rightMat.flags(rdd);
+                rightMat.f = rdd;
             } else if (grid_bcs[dir].right == bcs::Neumann) {
+                const auto col = faces.slot(dir, 1, end.mesh_coordinate);
                 for (int row = 0; row < exRight; row++) {
-                    N_builder.add_point(
-                        sub.right_row(row - exRight + 1), sub.right_row(), extra[row]);
+                    const auto r = sub.right_row(row - exRight + 1);
+                    N_builder.add_point(r, col, extra[row]);
                 }
             }
         }
-        const integer n_interior = sub.rows - leftMat.rows() - rightMat.rows();
+        const integer n_interior = sub.rows - leftMat.rows - rightMat.rows;
 
-        O_builder.add_inner_block(sub.columns,
+        out.O.push_back(line_rows{sub.columns,
                                   sub.row_offset,
                                   sub.col_offset,
                                   stride,
                                   MOVE(leftMat),
-                                  matrix::circulant{n_interior, interior},
-                                  MOVE(rightMat));
+                                  n_interior,
+                                  MOVE(rightMat)});
+    }
+}
+
+// Lines and cut points are discretized in chunks of this many, each chunk with its own
+// builders, and the chunks are concatenated in order.  The chunks depend only on the
+// counts and csr::builder sorts its points, so the matrices are identical to a serial
+// build for any number of threads.
+constexpr integer assembly_chunk = 64;
+
+integer num_chunks(integer n)
+{
+    return std::max<integer>(1, (n + assembly_chunk - 1) / assembly_chunk);
+}
+
+template <typename T>
+void append(std::vector<T>& to, std::vector<T>& from)
+{
+    to.insert(to.end(),
+              std::make_move_iterator(from.begin()),
+              std::make_move_iterator(from.end()));
+    from.clear();
+}
+
+// The assembly of one direction as stored in an operator_cache entry: the rows of
+// every line, the B and N points, and for each R space whether it has cut rows
+// followed by their points and log messages.
+void write_closure(cache_writer& out, const closure& c)
+{
+    out.write(c.rows);
+    out.write(c.columns);
+    out.write(c.v);
+    out.write(c.f);
+}
+
+bool read_closure(cache_reader& in, closure& c)
+{
+    return in.read(c.rows) && in.read(c.columns) && in.read(c.v) && in.read(c.f);
+}
+
+void write_assembly(cache_writer& out,
+                    const domain_chunk& d,
+                    const std::array<std::vector<cut_chunk>, 3>& cut)
+{
+    out.write(static_cast<integer>(d.O.size()));
+    for (const auto& l : d.O) {
+        out.write(l.columns);
+        out.write(l.row_offset);
+        out.write(l.col_offset);
+        out.write(l.stride);
+        write_closure(out, l.left);
+        out.write(l.n_interior);
+        write_closure(out, l.right);
     }
+    out.write(d.B.p);
+    out.write(d.N.p);
+
+    for (const auto& cr : cut) {
+        out.write(!cr.empty());
+        if (cr.empty()) continue;
+        out.write(cr[0].builder.O.p);
+        out.write(cr[0].builder.B.p);
+        out.write(static_cast<integer>(cr[0].log.size()));
+        for (const auto& msg : cr[0].log) out.write(msg);
+    }
+}
 
-    O = MOVE(O_builder).to_block();
-    B = MOVE(B_builder.to_csr(m.size()));
-    N = MOVE(N_builder.to_csr(m.size()));
+bool read_assembly(cache_reader& in,
+                   std::vector<domain_chunk>& domain,
+                   std::array<std::vector<cut_chunk>, 3>& cut)
+{
+    auto& d = domain.emplace_back();
+    integer n;
+    if (!in.read(n)) return false;
+    for (integer i = 0; i < n; ++i) {
+        auto& l = d.O.emplace_back();
+        if (!(in.read(l.columns) && in.read(l.row_offset) && in.read(l.col_offset) &&
+              in.read(l.stride) && read_closure(in, l.left) && in.read(l.n_interior) &&
+              read_closure(in, l.right)))
+            return false;
+    }
+    if (!(in.read(d.B.p) && in.read(d.N.p))) return false;
+
+    for (auto& cr : cut) {
+        bool rows;
+        if (!in.read(rows)) return false;
+        if (!rows) continue;
+        auto& c = cr.emplace_back();
+        if (!(in.read(c.builder.O.p) && in.read(c.builder.B.p) && in.read(n)))
+            return false;
+        for (integer i = 0; i < n; ++i)
+            if (!in.read(c.log.emplace_back())) return false;
+    }
+    return true;
+}
 
-    // col_space of B is `R{dir}`
-    // 0 -> rx == 1
-    // 1 -> ry == 2
-    // 2 -> rz == 4
-    B.flags(1u << dir);
+// Run independent host tasks on the execution space.  Tasks must not create Kokkos
+// views or launch kernels.
+void run_tasks(std::span<const std::function<void()>> tasks)
+{
+    Kokkos::parallel_for("derivative_assembly",
+                         Kokkos::RangePolicy<execution_space>(0, (integer)tasks.size()),
+                         [&](integer i) { tasks[i](); });
+    Kokkos::fence("derivative assembly complete");
 }
 } // namespace
 
+derivative::derivative(int dir, const mesh& m, const stencil& st) : dir{dir}
+{
+    auto [p, rmax, tmax, ex_max] = st.query_max();
+    tuning = matrix::tuning_key{
+        .extents = m.extents(), .stencil_width = static_cast<int>(2 * p + 1), .dir = dir};
+    pencil = matrix::pencil_layout{dir, m.extents()};
+}
+
 derivative::derivative(int dir,
                        const mesh& m,
                        const stencil& st,
                        const bcs::Grid& grid_bcs,
                        const bcs::Object& obj_bcs,
-                       const logs& logger)
-    : dir{dir}
+                       const logs& logger,
+                       const operator_cache& cache)
+    : derivative{dir, m, st}
 {
     if (m.extents()[dir] < 2) return;
-    // query the stencil and allocate memory
+    assemble(std::array{this}, m, st, grid_bcs, obj_bcs, logger, cache);
+}
+
+std::array<derivative, 3> derivative::xyz(const mesh& m,
+                                          const stencil& st,
+                                          const bcs::Grid& grid_bcs,
+                                          const bcs::Object& obj_bcs,
+                                          const logs& logger,
+                                          const operator_cache& cache)
+{
+    std::array<derivative, 3> d{
+        derivative{0, m, st}, derivative{1, m, st}, derivative{2, m, st}};
+    std::vector<derivative*> active;
+    for (auto& di : d)
+        if (m.extents()[di.dir] > 1) active.push_back(&di);
+    assemble(active, m, st, grid_bcs, obj_bcs, logger, cache);
+    return d;
+}
+
+void derivative::assemble(std::span<derivative* const> ds,
+                          const mesh& m,
+                          const stencil& st,
+                          const bcs::Grid& grid_bcs,
+                          const bcs::Object& obj_bcs,
+                          const logs& logger,
+                          const operator_cache& cache)
+{
+    Kokkos::Profiling::ScopedRegion region("derivative::assemble");
+    const auto nd = ds.size();
     auto [p, rmax, tmax, ex_max] = st.query_max();
-    auto h = m.h(dir);
-    // set up the interior stencil
-    auto interior_c = std::vector<real>(2 * p + 1);
-    st.interior(h, interior_c);
 
-    domain_discretization(dir, m, st, grid_bcs, obj_bcs, O, B, N, interior_c);
+    std::vector<std::vector<domain_chunk>> domain(nd);
+    std::vector<std::array<std::vector<cut_chunk>, 3>> cut(nd);
+
+    // Directions found in the cache skip straight to building the matrices.  The log
+    // messages are part of an entry so whether we are logging is part of its key.
+    std::vector<std::uint64_t> keys(nd);
+    std::vector<char> cached(nd, false);
+    if (cache) {
+        const auto base = operator_cache::key(m, st, grid_bcs, obj_bcs);
+        for (std::size_t i = 0; i < nd; ++i) {
+            auto k = base;
+            k.add(ds[i]->dir);
+            k.add(static_cast<bool>(logger));
+            keys[i] = k.value();
+            cached[i] = cache.load(keys[i], [&](cache_reader& in) {
+                return read_assembly(in, domain[i], cut[i]);
+            });
+            if (!cached[i]) {
+                domain[i].clear();
+                cut[i] = {};
+            }
+        }
+    }
+
+    // One task per chunk of lines and per chunk of cut points of every R space, for
+    // all derivatives at once
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t i = 0; i < nd; ++i) {
+        if (cached[i]) continue;
+        const int dir = ds[i]->dir;
+        const std::span<const line> lines = m.lines(dir);
+        domain[i].resize(num_chunks(lines.size()));
+        for (integer c = 0; c < (integer)domain[i].size(); ++c) {
+            const auto first = std::min<integer>(c * assembly_chunk, lines.size());
+            const auto n = std::min<integer>(assembly_chunk, lines.size() - first);
+            tasks.push_back([&, dir, i, c, chunk = lines.subspan(first, n)] {
+                domain_discretization(dir, m, st, grid_bcs, obj_bcs, chunk, domain[i][c]);
+            });
+        }
+
+        for (int r = 0; r < 3; ++r) {
+            if (!has_cut_rows(r, m, obj_bcs)) continue;
+            const integer sz = m.R(r).size();
+            cut[i][r].resize(num_chunks(sz));
+            for (integer c = 0; c < (integer)cut[i][r].size(); ++c) {
+                const auto first = c * assembly_chunk;
+                const auto last = std::min(first + assembly_chunk, sz);
+                tasks.push_back([&, dir, i, r, c, first, last] {
+                    cut_discretization(
+                        r, dir, m, st, obj_bcs, first, last, (bool)logger, cut[i][r][c]);
+                });
+            }
+        }
+    }
+    run_tasks(tasks);
+
+    // Concatenate the chunks in order and log the cut points in row order
+    for (std::size_t i = 0; i < nd; ++i) {
+        auto& d = domain[i];
+        for (std::size_t c = 1; c < d.size(); ++c) {
+            append(d[0].O, d[c].O);
+            append(d[0].B.p, d[c].B.p);
+            append(d[0].N.p, d[c].N.p);
+        }
+        for (auto& cr : cut[i]) {
+            for (std::size_t c = 1; c < cr.size(); ++c) {
+                append(cr[0].builder.O.p, cr[c].builder.O.p);
+                append(cr[0].builder.B.p, cr[c].builder.B.p);
+                append(cr[0].log, cr[c].log);
+            }
+            if (!cr.empty())
+                for (auto& msg : cr[0].log) logger(spdlog::level::info, msg);
+        }
+    }
+
+    for (std::size_t i = 0; i < nd; ++i)
+        if (cache && !cached[i])
+            cache.store(keys[i], [&](cache_writer& out) {
+                write_assembly(out, domain[i][0], cut[i]);
+            });
+
+    // Build the matrices
+    for (std::size_t i = 0; i < nd; ++i) {
+        auto& d = *ds[i];
+        auto interior = std::vector<real>(2 * p + 1);
+        st.interior(m.h(d.dir), interior);
+
+        auto& chunk = domain[i][0];
+        auto O_builder = matrix::block::builder(chunk.O.size());
+        for (const auto& l : chunk.O)
+            O_builder.add_inner_block(l.columns,
+                                      l.row_offset,
+                                      l.col_offset,
+                                      l.stride,
+                                      l.left.to_dense(),
+                                      matrix::circulant{l.n_interior, interior},
+                                      l.right.to_dense());
+        d.O = MOVE(O_builder).to_block();
+        d.B = MOVE(chunk.B.to_csr(m.size()));
+        d.N = MOVE(chunk.N.to_csr(m.size()));
+
+        // col_space of B is `R{dir}`
+        // 0 -> rx == 1
+        // 1 -> ry == 2
+        // 2 -> rz == 4
+        d.B.flags(1u << d.dir);
+
+        // construct ray in 'dir` emanative from R(r)
+        const std::array<std::array<matrix::csr*, 2>, 3> BfBr{
+            {{&d.Bfx, &d.Brx}, {&d.Bfy, &d.Bry}, {&d.Bfz, &d.Brz}}};
+        for (int r = 0; r < 3; ++r)
+            if (auto& cr = cut[i][r]; !cr.empty())
+                cr[0].builder.to_csr(r, *BfBr[r][0], *BfBr[r][1], m.R(r).size());
+    }
+}
 
-    cut_discretization(0, dir, m, st, grid_bcs, obj_bcs, Bfx, Brx, interior_c, logger);
-    cut_discretization(1, dir, m, st, grid_bcs, obj_bcs, Bfy, Bry, interior_c, logger);
-    cut_discretization(2, dir, m, st, grid_bcs, obj_bcs, Bfz, Brz, interior_c, logger);
+const derivative::fused_corrections& derivative::fused() const
+{
+    if (fused_) return *fused_;
+
+    // Source ids follow the order of the merged matrices: BN reads {u.R<dir>, nu}
+    // and BR* read {u.D, u.R*}
+    using parts = std::array<const matrix::csr*, 2>;
+    auto f = std::make_shared<fused_corrections>();
+    f->BN = matrix::csr::merge(parts{&B, &N});
+    f->BRx = matrix::csr::merge(parts{&Bfx, &Brx});
+    f->BRy = matrix::csr::merge(parts{&Bfy, &Bry});
+    f->BRz = matrix::csr::merge(parts{&Bfz, &Brz});
+    if (sparse_layout_ != matrix::csr_layout::csr)
+        for (auto* A : {&f->BN, &f->BRx, &f->BRy, &f->BRz})
+            A->layout(sparse_layout_, sparse_chunk, sparse_sigma);
+
+    fused_ = MOVE(f);
+    return *fused_;
 }
 
 template <typename Op>
     requires std::invocable<Op, real&, real>
-void derivative::apply_kernels(scalar_view u, scalar_span du, Op op) const
+void derivative::apply_kernels(
+    scalar_view u, const real* nu, scalar_span du, Op op, bool with_block) const
 {
-    // update points in R
-    Bfx(u.D, du.Rx);
-    Bfy(u.D, du.Ry);
-    Bfz(u.D, du.Rz);
+    using sources = matrix::csr::sources;
+    const real* u_D = u.D.data();
 
-    Brx(u.Rx, du.Rx);
-    Bry(u.Ry, du.Ry);
-    Brz(u.Rz, du.Rz);
+    // update points in R
+    const auto& f = fused();
+    f.BRx(sources{u_D, u.Rx.data()}, du.Rx);
+    f.BRy(sources{u_D, u.Ry.data()}, du.Ry);
+    f.BRz(sources{u_D, u.Rz.data()}, du.Rz);
 
     // update fluid domain
-    O(u.D, du.D, op);
-    switch (dir) {
-    case 0:
-        B(u.Rx, du.D);
-        break;
-    case 1:
-        B(u.Ry, du.D);
-        break;
-    default:
-        B(u.Rz, du.D);
+    if (with_block) apply_block(u.D, du.D, op);
+    const real* b_src = (dir == 0) ? u.Rx.data() : (dir == 1) ? u.Ry.data() : u.Rz.data();
+    if (nu)
+        f.BN(sources{b_src, nu}, du.D);
+    else
+        B(sources{b_src}, du.D);
+}
+
+template <typename Op>
+void derivative::apply_block(std::span<const real> u_D, std::span<real> du_D, Op op) const
+{
+    if (mode_ == derivative_mode::strided) {
+        O(u_D, du_D, op);
+        return;
     }
+    pencil.to_pencils(u_D, {u_p.data(), u_p.extent(0)});
+    pencil_block({u_p.data(), u_p.extent(0)}, {du_p.data(), du_p.extent(0)});
+    pencil.from_pencils({du_p.data(), du_p.extent(0)}, du_D, op, written);
 }
 
 template <typename Op>
@@ -504,20 +806,99 @@ template <typename Op>
 void derivative::operator()(scalar_view u, scalar_span du, Op op) const
 {
     Kokkos::Profiling::ScopedRegion region("derivative::operator()");
-    apply_kernels(u, du, op);
+    apply_kernels(u, nullptr, du, op);
     Kokkos::fence("derivative::operator() complete");
 }
 
 template <typename Op>
     requires std::invocable<Op, real&, real>
-void derivative::operator()(scalar_view u, scalar_view nu, scalar_span du, Op op) const
+void derivative::operator()(scalar_view u,
+                            std::span<const real> nu,
+                            scalar_span du,
+                            Op op) const
 {
     Kokkos::Profiling::ScopedRegion region("derivative::operator()");
-    apply_kernels(u, du, op);
-    N(nu.D, du.D);
+    apply_kernels(u, nu.data(), du, op);
     Kokkos::fence("derivative::operator() with Neumann complete");
 }
 
+matrix::multi_vector derivative::multi_D(std::span<const scalar_view> u,
+                                         std::span<const scalar_span> du) const
+{
+    matrix::multi_vector v{.k = (int)u.size()};
+    for (int f = 0; f < v.k; ++f) {
+        v.x[f] = u[f].D.data();
+        v.b[f] = du[f].D.data();
+    }
+    return v;
+}
+
+matrix::csr::multi_sources derivative::multi_B(std::span<const scalar_view> u,
+                                               std::span<const scalar_span> du) const
+{
+    matrix::csr::multi_sources v{.k = (int)u.size()};
+    for (int f = 0; f < v.k; ++f) {
+        const auto& uf = u[f];
+        v.x[f] = {(dir == 0) ? uf.Rx.data() : (dir == 1) ? uf.Ry.data() : uf.Rz.data()};
+        v.b[f] = du[f].D.data();
+    }
+    return v;
+}
+
+matrix::csr::multi_sources derivative::multi_R(int r,
+                                               std::span<const scalar_view> u,
+                                               std::span<const scalar_span> du) const
+{
+    matrix::csr::multi_sources v{.k = (int)u.size()};
+    for (int f = 0; f < v.k; ++f) {
+        const auto& uf = u[f];
+        const auto& R = (r == 0) ? uf.Rx : (r == 1) ? uf.Ry : uf.Rz;
+        const auto& dR = (r == 0) ? du[f].Rx : (r == 1) ? du[f].Ry : du[f].Rz;
+        v.x[f] = {uf.D.data(), R.data()};
+        v.b[f] = dR.data();
+    }
+    return v;
+}
+
+template <typename Op>
+    requires std::invocable<Op, real&, real>
+void derivative::operator()(std::span<const scalar_view> u,
+                            std::span<const scalar_span> du,
+                            Op op) const
+{
+    Kokkos::Profiling::ScopedRegion region("derivative::operator()");
+    assert(u.size() == du.size());
+
+    for (std::size_t first = 0; first < u.size(); first += matrix::max_vectors) {
+        const auto n = std::min<std::size_t>(matrix::max_vectors, u.size() - first);
+        const auto uf = u.subspan(first, n);
+        const auto duf = du.subspan(first, n);
+
+        // update points in R
+        const auto& f = fused();
+        f.BRx(multi_R(0, uf, duf));
+        f.BRy(multi_R(1, uf, duf));
+        f.BRz(multi_R(2, uf, duf));
+
+        // update fluid domain
+        O(multi_D(uf, duf), op);
+        B(multi_B(uf, duf));
+    }
+    Kokkos::fence("derivative::operator() multi-vector complete");
+}
+
+void derivative::apply_corrections(scalar_view u, scalar_span du) const
+{
+    apply_kernels(u, nullptr, du, plus_eq, false);
+}
+
+void derivative::apply_corrections(scalar_view u,
+                                   std::span<const real> nu,
+                                   scalar_span du) const
+{
+    apply_kernels(u, nu.data(), du, plus_eq, false);
+}
+
 template <typename Op>
     requires std::invocable<Op, real&, real>
 void derivative::build_graph(scalar_view u, scalar_span du, Op op)
@@ -534,18 +915,14 @@ void derivative::build_graph(scalar_view u, scalar_span du, Op op)
 
     graph_ = Kokkos::Experimental::create_graph<execution_space>(
         [&](auto root) {
-            // R-space chains (3 independent pairs)
-            auto bfx = Bfx.graph_node(root, u_D, du_Rx);
-            Brx.graph_node(bfx, u_Rx, du_Rx);
-
-            auto bfy = Bfy.graph_node(root, u_D, du_Ry);
-            Bry.graph_node(bfy, u_Ry, du_Ry);
-
-            auto bfz = Bfz.graph_node(root, u_D, du_Rz);
-            Brz.graph_node(bfz, u_Rz, du_Rz);
+            // R-space corrections (3 independent passes)
+            const auto& f = fused();
+            f.BRx.graph_node(root, {u_D, u_Rx}, du_Rx);
+            f.BRy.graph_node(root, {u_D, u_Ry}, du_Ry);
+            f.BRz.graph_node(root, {u_D, u_Rz}, du_Rz);
 
             // D-space chain
-            auto o = O.graph_node(root, u_D, du_D, op);
+            auto o = block_nodes(root, u_D, du_D, op, true);
             B.graph_node(o, b_src, du_D);
         });
 
@@ -554,13 +931,16 @@ void derivative::build_graph(scalar_view u, scalar_span du, Op op)
 
 template <typename Op>
     requires std::invocable<Op, real&, real>
-void derivative::build_graph(scalar_view u, scalar_view nu, scalar_span du, Op op)
+void derivative::build_graph(scalar_view u,
+                             std::span<const real> nu,
+                             scalar_span du,
+                             Op op)
 {
     const real* u_D = u.D.data();
     const real* u_Rx = u.Rx.data();
     const real* u_Ry = u.Ry.data();
     const real* u_Rz = u.Rz.data();
-    const real* nu_D = nu.D.data();
+    const real* nu_f = nu.data();
     real* du_D = du.D.data();
     real* du_Rx = du.Rx.data();
     real* du_Ry = du.Ry.data();
@@ -569,20 +949,15 @@ void derivative::build_graph(scalar_view u, scalar_view nu, scalar_span du, Op o
 
     graph_ = Kokkos::Experimental::create_graph<execution_space>(
         [&](auto root) {
-            // R-space chains (3 independent pairs)
-            auto bfx = Bfx.graph_node(root, u_D, du_Rx);
-            Brx.graph_node(bfx, u_Rx, du_Rx);
-
-            auto bfy = Bfy.graph_node(root, u_D, du_Ry);
-            Bry.graph_node(bfy, u_Ry, du_Ry);
-
-            auto bfz = Bfz.graph_node(root, u_D, du_Rz);
-            Brz.graph_node(bfz, u_Rz, du_Rz);
-
-            // D-space chain with Neumann
-            auto o = O.graph_node(root, u_D, du_D, op);
-            auto b = B.graph_node(o, b_src, du_D);
-            N.graph_node(b, nu_D, du_D);
+            // R-space corrections (3 independent passes)
+            const auto& f = fused();
+            f.BRx.graph_node(root, {u_D, u_Rx}, du_Rx);
+            f.BRy.graph_node(root, {u_D, u_Ry}, du_Ry);
+            f.BRz.graph_node(root, {u_D, u_Rz}, du_Rz);
+
+            // D-space chain with B and N applied in one pass
+            auto o = block_nodes(root, u_D, du_D, op, true);
+            f.BN.graph_node(o, {b_src, nu_f}, du_D);
         });
 
     graph_->instantiate();
@@ -595,20 +970,137 @@ void derivative::submit_graph()
     Kokkos::fence("derivative::submit_graph() complete");
 }
 
-template void derivative::operator()<eq_t>(scalar_view, scalar_span, eq_t) const;
+void derivative::sparse_layout(matrix::csr_layout l, int chunk, int sigma)
+{
+    for (auto* A : {&B, &N, &Bfx, &Brx, &Bfy, &Bry, &Bfz, &Brz})
+        A->layout(l, chunk, sigma);
+    sparse_layout_ = l;
+    sparse_chunk = chunk;
+    sparse_sigma = sigma;
+    // rebuilt with the new layout on next use
+    fused_.reset();
+}
 
-template void
-derivative::operator()<plus_eq_t>(scalar_view, scalar_span, plus_eq_t) const;
+matrix::block_launch derivative::tune(matrix::tuning_cache& cache, int reps)
+{
+    // the relaid block is a different layout, so it is timed and cached on its own
+    if (mode_ == derivative_mode::pencil) {
+        auto key = tuning;
+        key.pencil = 1;
+        return matrix::autotune(O_p, key, cache, reps);
+    }
+    return matrix::autotune(O, tuning, cache, reps);
+}
 
-template void
-derivative::operator()<eq_t>(scalar_view, scalar_view, scalar_span, eq_t) const;
+void derivative::precision(matrix::storage_precision p)
+{
+    O.precision(p);
+    O_p.precision(p);
+}
+
+void derivative::mode(derivative_mode m)
+{
+    if (m == derivative_mode::pencil && (pencil.identity() || O.num_lines() == 0))
+        m = derivative_mode::strided;
+    mode_ = m;
+
+    if (mode_ == derivative_mode::strided) {
+        O_p = matrix::block{};
+        u_p = du_p = device_view<real*>{};
+        written = device_view<std::uint8_t*>{};
+        return;
+    }
+
+    O_p = O.relaid(pencil);
+    u_p = device_view<real*>("derivative_u_p", pencil.size());
+    du_p = device_view<real*>("derivative_du_p", pencil.size());
+
+    // Only the rows of O may be written back: the remaining points of du.D belong to
+    // the boundary corrections or lie inside objects.
+    std::vector<std::uint8_t> h(pencil.size());
+    auto meta = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, O_p.metadata_view());
+    for (int l = 0; l < (int)meta.extent(0); ++l) {
+        const auto& b = meta(l);
+        const int rows = b.left_rows + b.interior_rows + b.right_rows;
+        std::fill_n(h.begin() + b.row_offset, rows, std::uint8_t{1});
+    }
+    written = device_view<std::uint8_t*>("derivative_written", h.size());
+    auto h_v = Kokkos::View<const std::uint8_t*, Kokkos::HostSpace,
+                            Kokkos::MemoryTraits<Kokkos::Unmanaged>>(h.data(), h.size());
+    Kokkos::deep_copy(written, h_v);
+}
+
+derivative_mode derivative::preferred_mode(int dir, const index_extents& extents)
+{
+    // stride of `dir` in the natural ordering
+    const auto& n = extents.extents;
+    const integer stride = dir == 0 ? integer{n[1]} * n[2] : dir == 1 ? integer{n[2]} : 1;
+    const integer size = integer{n[0]} * n[1] * n[2];
+
+    // 64 doubles is a 512 byte stride, past the reach of the hardware prefetchers,
+    // and 2^18 points (2 MiB) exceed a typical per-core L2
+    return stride >= 64 && size >= (integer{1} << 18) ? derivative_mode::pencil
+                                                      : derivative_mode::strided;
+}
+
+void derivative::to_pencils(std::span<const real> u, std::span<real> u_p) const
+{
+    pencil.to_pencils(u, u_p);
+}
+
+void derivative::from_pencils(std::span<const real> u_p, std::span<real> u) const
+{
+    pencil.from_pencils(u_p, u);
+}
+
+template <typename Op>
+void derivative::pencil_block(std::span<const real> u_p, std::span<real> du_p, Op op) const
+{
+    assert(mode_ == derivative_mode::pencil || pencil.identity() || O.num_lines() == 0);
+    (mode_ == derivative_mode::pencil ? O_p : O)(u_p, du_p, op);
+}
+
+integer derivative::sparse_size() const
+{
+    return B.size() + N.size() + Bfx.size() + Brx.size() + Bfy.size() + Bry.size() +
+           Bfz.size() + Brz.size();
+}
+
+template void derivative::operator()<eq_t>(scalar_view, scalar_span, eq_t) const;
 
 template void
-derivative::operator()<plus_eq_t>(scalar_view, scalar_view, scalar_span, plus_eq_t) const;
+derivative::operator()<plus_eq_t>(scalar_view, scalar_span, plus_eq_t) const;
 
+template void derivative::operator()<eq_t>(scalar_view,
+                                          std::span<const real>,
+                                          scalar_span,
+                                          eq_t) const;
+
+template void derivative::operator()<plus_eq_t>(scalar_view,
+                                               std::span<const real>,
+                                               scalar_span,
+                                               plus_eq_t) const;
+
+template void derivative::operator()<eq_t>(std::span<const scalar_view>,
+                                          std::span<const scalar_span>,
+                                          eq_t) const;
+template void derivative::operator()<plus_eq_t>(std::span<const scalar_view>,
+                                               std::span<const scalar_span>,
+                                               plus_eq_t) const;
+
+template void derivative::pencil_block<eq_t>(std::span<const real>,
+                                             std::span<real>,
+                                             eq_t) const;
+template void derivative::pencil_block<plus_eq_t>(std::span<const real>,
+                                                  std::span<real>,
+                                                  plus_eq_t) const;
 template void derivative::build_graph<eq_t>(scalar_view, scalar_span, eq_t);
 template void derivative::build_graph<plus_eq_t>(scalar_view, scalar_span, plus_eq_t);
-template void derivative::build_graph<eq_t>(scalar_view, scalar_view, scalar_span, eq_t);
-template void derivative::build_graph<plus_eq_t>(scalar_view, scalar_view, scalar_span, plus_eq_t);
+template void
+derivative::build_graph<eq_t>(scalar_view, std::span<const real>, scalar_span, eq_t);
+template void derivative::build_graph<plus_eq_t>(scalar_view,
+                                                 std::span<const real>,
+                                                 scalar_span,
+                                                 plus_eq_t);
 
 } // namespace ccs
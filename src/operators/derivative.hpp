@@ -5,18 +5,32 @@
 #include "boundaries.hpp"
 #include "fields/scalar.hpp"
 #include "matrices/block.hpp"
+#include "matrices/block_tuner.hpp"
 #include "matrices/csr.hpp"
 #include "matrices/matrix_visitor.hpp"
+#include "matrices/pencil.hpp"
 #include "mesh/mesh.hpp"
+#include "neumann_faces.hpp"
+#include "operator_cache.hpp"
 #include "stencils/stencil.hpp"
 
 #include "io/logging.hpp"
 
 #include <Kokkos_Graph.hpp>
+#include <array>
+#include <memory>
 #include <optional>
+#include <span>
 
 namespace ccs
 {
+// How the block matvec reads a direction whose stride is not 1.
+//   strided - in place, gathering u.D along each line
+//   pencil  - u.D is transposed into direction-contiguous pencils
+//             (matrix::pencil_layout), a unit-stride copy of the block is applied
+//             there and the result is transposed back
+enum class derivative_mode { strided, pencil };
+
 class derivative
 {
     int dir;
@@ -28,13 +42,86 @@ class derivative
     matrix::csr Bfx, Brx;
     matrix::csr Bfy, Bry;
     matrix::csr Bfz, Brz;
+    // Fused corrections: B and N merged into one pass over D for the Neumann
+    // overload, and each Bf*/Br* pair merged into one pass over its R space.  They
+    // duplicate the unfused matrices, so they are only built (by fused()) once this
+    // derivative applies its own corrections.  Operators that merge the corrections of
+    // several derivatives never pay for them.
+    struct fused_corrections {
+        matrix::csr BN;
+        matrix::csr BRx, BRy, BRz;
+    };
+    mutable std::shared_ptr<const fused_corrections> fused_;
+    // layout applied to the fused matrices when they are built
+    matrix::csr_layout sparse_layout_ = matrix::csr_layout::csr;
+    int sparse_chunk = 8;
+    int sparse_sigma = 256;
+    // identifies O in a matrix::tuning_cache
+    matrix::tuning_key tuning;
+    // Pencil mode: O relaid for the pencil ordering, scratch for u.D and du.D in that
+    // ordering and the (pencil) points O writes
+    derivative_mode mode_ = derivative_mode::strided;
+    matrix::pencil_layout pencil;
+    matrix::block O_p;
+    device_view<real*> u_p, du_p;
+    device_view<std::uint8_t*> written;
     // Pre-built graph for submit_graph().
     std::optional<Kokkos::Experimental::Graph<execution_space>> graph_;
 
-    // Submit all kernels (R-space + D-space) without fencing.
+    // The fused corrections, built on the first call.  The first call is not thread
+    // safe; derivatives are set up and applied from one host thread.
+    const fused_corrections& fused() const;
+
+    // Submit all kernels (R-space + D-space) without fencing.  B and N are applied
+    // together when nu is given, otherwise B alone.
     template <typename Op = eq_t>
         requires std::invocable<Op, real&, real>
-    void apply_kernels(scalar_view u, scalar_span du, Op op = {}) const;
+    void apply_kernels(scalar_view u,
+                       const real* nu,
+                       scalar_span du,
+                       Op op = {},
+                       bool with_block = true) const;
+
+    // The block matvec du.D op= O u.D in the selected mode
+    template <typename Op>
+    void apply_block(std::span<const real> u_D, std::span<real> du_D, Op op) const;
+
+    // Graph form of apply_block.  Only the nodes of the selected mode are added; the
+    // last one is returned type-erased so the node type does not depend on the mode.
+    // A disabled block adds O's node executing zero teams.
+    template <typename Op, typename NodeT>
+    Kokkos::Experimental::GraphNodeRef<execution_space>
+    block_nodes(NodeT parent, const real* u_D, real* du_D, Op op, bool enabled) const
+    {
+        if (!enabled || mode_ == derivative_mode::strided)
+            return O.graph_node(parent, u_D, du_D, op, enabled);
+        auto in = pencil.to_pencils_node(parent, u_D, u_p.data());
+        auto o_p = O_p.graph_node(in, u_p.data(), du_p.data(), eq);
+        return pencil.from_pencils_node(o_p, du_p.data(), du_D, op, written);
+    }
+
+    // Pointer sets for the multi-vector kernels: field f of u/du maps to entry f.
+    // r selects the R space (0, 1, 2) for the Bf*/Br* corrections.
+    matrix::multi_vector multi_D(std::span<const scalar_view> u,
+                                 std::span<const scalar_span> du) const;
+    matrix::csr::multi_sources multi_B(std::span<const scalar_view> u,
+                                       std::span<const scalar_span> du) const;
+    matrix::csr::multi_sources
+    multi_R(int r, std::span<const scalar_view> u, std::span<const scalar_span> du) const;
+
+    // Everything but the matrices, which assemble() fills in.
+    derivative(int dir, const mesh&, const stencil&);
+
+    // Discretize the lines and cut points of all `ds` in one parallel pass and build
+    // their matrices.  Directions with an entry in `cache` are read from it instead
+    // of discretized, and the others are added to it.
+    static void assemble(std::span<derivative* const> ds,
+                         const mesh&,
+                         const stencil&,
+                         const bcs::Grid&,
+                         const bcs::Object&,
+                         const logs&,
+                         const operator_cache&);
 
 public:
     derivative() = default;
@@ -44,7 +131,17 @@ public:
                const stencil& st,
                const bcs::Grid& grid_bcs,
                const bcs::Object& object_bcs,
-               const logs& = {});
+               const logs& = {},
+               const operator_cache& = {});
+
+    // The x, y and z derivatives, assembled together so the three directions share
+    // one parallel pass.  Identical to constructing them one at a time.
+    static std::array<derivative, 3> xyz(const mesh&,
+                                         const stencil&,
+                                         const bcs::Grid&,
+                                         const bcs::Object&,
+                                         const logs& = {},
+                                         const operator_cache& = {});
 
     void visit(matrix::visitor& v) const
     {
@@ -60,14 +157,24 @@ public:
         requires std::invocable<Op, real&, real>
     void operator()(scalar_view, scalar_span, Op op = {}) const;
 
-    // operator for when neumann conditions may be applied
+    // operator for when neumann conditions may be applied.  The derivative values are
+    // laid out by neumann_faces{m.extents(), grid_bcs}.
     template <typename Op = eq_t>
         requires std::invocable<Op, real&, real>
     void operator()(scalar_view field_values,
-                    scalar_view derivative_values,
+                    std::span<const real> derivative_values,
                     scalar_span,
                     Op op = {}) const;
 
+    // Multi-vector form of the non-Neumann operator: du[f] = d(u[f]) for every field,
+    // with each matrix read once per row for all fields.  Fields are processed in
+    // groups of matrix::max_vectors.
+    template <typename Op = eq_t>
+        requires std::invocable<Op, real&, real>
+    void operator()(std::span<const scalar_view> u,
+                    std::span<const scalar_span> du,
+                    Op op = {}) const;
+
     // Build a pre-instantiated graph for the non-Neumann overload.
     // Buffer pointers are baked in at creation time.
     template <typename Op = eq_t>
@@ -77,16 +184,86 @@ public:
     // Build a pre-instantiated graph for the Neumann overload.
     template <typename Op = eq_t>
         requires std::invocable<Op, real&, real>
-    void build_graph(scalar_view u, scalar_view nu, scalar_span du, Op op = {});
+    void build_graph(scalar_view u, std::span<const real> nu, scalar_span du, Op op = {});
 
     // Submit the pre-built graph.
     void submit_graph();
 
+    // Select the storage layout of the cut-cell csr matrices (B, N, Bf*, Br* and their
+    // fused forms).  Graph nodes capture the layout when they are created so call this
+    // before building any graphs.
+    void sparse_layout(matrix::csr_layout l, int chunk = 8, int sigma = 256);
+
+    // Select the launch configuration of the block matvec, reusing the one in `cache`
+    // for this mesh, stencil, direction and thread count or timing the candidates of
+    // matrix::autotune.  As with sparse_layout, call this before building any graphs.
+    matrix::block_launch tune(matrix::tuning_cache& cache, int reps = 3);
+
+    // Storage precision of the block coefficients (matrix::block::precision).  The
+    // cut-cell corrections and the fields stay in real.  Graphs capture the choice
+    // when they are built.
+    void precision(matrix::storage_precision p);
+    matrix::storage_precision precision() const { return O.precision(); }
+
+    // Select how the block matvec treats this direction.  Derivatives are built
+    // strided; preferred_mode is a cost model for callers that opt in.  Pencil mode is
+    // ignored for unit stride directions and the multi-vector overloads always use the
+    // strided path.  The pencil scratch only exists in pencil mode.  Graphs capture the
+    // mode when they are built, and tune() times the block of the current mode, so
+    // select the mode first.
+    void mode(derivative_mode m);
+    derivative_mode mode() const { return mode_; }
+
+    // Cost model for mode(): pencils pay off once a line's points lie on different
+    // pages and the field no longer fits in cache.
+    static derivative_mode preferred_mode(int dir, const index_extents& extents);
+
+    // "Stay transposed" interface for operators chained along one direction: move
+    // fields into and out of the pencil ordering once and apply the block matvec to
+    // pencil ordered data in between.  from_pencils writes every point.  The cut-cell
+    // corrections still act on the natural ordering (apply_corrections).  pencil_block
+    // requires mode() == derivative_mode::pencil unless pencils().identity().
+    const matrix::pencil_layout& pencils() const { return pencil; }
+    void to_pencils(std::span<const real> u, std::span<real> u_p) const;
+    void from_pencils(std::span<const real> u_p, std::span<real> u) const;
+    template <typename Op = eq_t>
+    void pencil_block(std::span<const real> u_p, std::span<real> du_p, Op op = {}) const;
+
+    // number of non-zeros in the cut-cell csr matrices
+    integer sparse_size() const;
+
+    // The block matvec alone, for callers that apply the block rows of several
+    // derivatives together (see matrix::tiled_blocks).
+    const matrix::block& block_matrix() const { return O; }
+
+    // The unfused cut-cell matrices, for callers that merge the corrections of several
+    // derivatives (see laplacian_kernel::fused).  B reads u.R<dir> and N reads nu,
+    // both writing du.D; cut_matrices(r) is {Bf, Br} for R space r, reading u.D and
+    // u.R<r> respectively and writing du.R<r>.
+    const matrix::csr& boundary_matrix() const { return B; }
+    const matrix::csr& neumann_matrix() const { return N; }
+    std::array<const matrix::csr*, 2> cut_matrices(int r) const
+    {
+        if (r == 0) return {&Bfx, &Brx};
+        if (r == 1) return {&Bfy, &Bry};
+        return {&Bfz, &Brz};
+    }
+
+    // Everything except the block matvec, accumulated into du without fencing.
+    void apply_corrections(scalar_view u, scalar_span du) const;
+    void apply_corrections(scalar_view u, std::span<const real> nu, scalar_span du) const;
+
     // Add derivative nodes to an existing graph, chaining from parent.
-    // Returns a when_all of all leaf nodes so the caller can chain further.
+    // Returns a when_all of all leaf nodes so the caller can chain further.  With
+    // with_block = false the block matvec node executes zero teams and only the
+    // corrections are applied; the returned node type does not change.
     template <typename Op = eq_t, typename NodeT>
         requires std::invocable<Op, real&, real>
-    auto add_graph_nodes(NodeT parent, scalar_view u, scalar_span du, Op op = {}) const
+    auto add_graph_nodes(NodeT parent,
+                         scalar_view u,
+                         scalar_span du,
+                         Op op = {},
+                         bool with_block = true) const
     {
         const real* u_D = u.D.data();
         const real* u_Rx = u.Rx.data();
@@ -98,54 +275,72 @@ public:
         real* du_Rz = du.Rz.data();
         const real* b_src = (dir == 0) ? u_Rx : (dir == 1) ? u_Ry : u_Rz;
 
-        // R-space chains (3 independent pairs)
-        auto bfx = Bfx.graph_node(parent, u_D, du_Rx);
-        auto brx = Brx.graph_node(bfx, u_Rx, du_Rx);
+        // R-space corrections (3 independent passes)
+        const auto& f = fused();
+        auto brx = f.BRx.graph_node(parent, {u_D, u_Rx}, du_Rx);
+        auto bry = f.BRy.graph_node(parent, {u_D, u_Ry}, du_Ry);
+        auto brz = f.BRz.graph_node(parent, {u_D, u_Rz}, du_Rz);
+
+        // D-space chain
+        auto o = block_nodes(parent, u_D, du_D, op, with_block);
+        auto b = B.graph_node(o, b_src, du_D);
+
+        return Kokkos::Experimental::when_all(brx, bry, brz, b);
+    }
 
-        auto bfy = Bfy.graph_node(parent, u_D, du_Ry);
-        auto bry = Bry.graph_node(bfy, u_Ry, du_Ry);
+    // Multi-vector overload for at most matrix::max_vectors fields.
+    template <typename Op = eq_t, typename NodeT>
+        requires std::invocable<Op, real&, real>
+    auto add_graph_nodes(NodeT parent,
+                         std::span<const scalar_view> u,
+                         std::span<const scalar_span> du,
+                         Op op = {}) const
+    {
+        assert(u.size() == du.size() && (int)u.size() <= matrix::max_vectors);
 
-        auto bfz = Bfz.graph_node(parent, u_D, du_Rz);
-        auto brz = Brz.graph_node(bfz, u_Rz, du_Rz);
+        // R-space corrections (3 independent passes)
+        const auto& f = fused();
+        auto brx = f.BRx.graph_node(parent, multi_R(0, u, du));
+        auto bry = f.BRy.graph_node(parent, multi_R(1, u, du));
+        auto brz = f.BRz.graph_node(parent, multi_R(2, u, du));
 
         // D-space chain
-        auto o = O.graph_node(parent, u_D, du_D, op);
-        auto b = B.graph_node(o, b_src, du_D);
+        auto o = O.graph_node(parent, multi_D(u, du), op);
+        auto b = B.graph_node(o, multi_B(u, du));
 
         return Kokkos::Experimental::when_all(brx, bry, brz, b);
     }
 
-    // Neumann overload: adds N node at end of D-space chain.
+    // Neumann overload: N is fused with B at the end of the D-space chain.
     template <typename Op = eq_t, typename NodeT>
         requires std::invocable<Op, real&, real>
-    auto add_graph_nodes(NodeT parent, scalar_view u, scalar_view nu,
-                         scalar_span du, Op op = {}) const
+    auto add_graph_nodes(NodeT parent,
+                         scalar_view u,
+                         std::span<const real> nu,
+                         scalar_span du,
+                         Op op = {},
+                         bool with_block = true) const
     {
         const real* u_D = u.D.data();
         const real* u_Rx = u.Rx.data();
         const real* u_Ry = u.Ry.data();
         const real* u_Rz = u.Rz.data();
-        const real* nu_D = nu.D.data();
+        const real* nu_f = nu.data();
         real* du_D = du.D.data();
         real* du_Rx = du.Rx.data();
         real* du_Ry = du.Ry.data();
         real* du_Rz = du.Rz.data();
         const real* b_src = (dir == 0) ? u_Rx : (dir == 1) ? u_Ry : u_Rz;
 
-        // R-space chains (3 independent pairs)
-        auto bfx = Bfx.graph_node(parent, u_D, du_Rx);
-        auto brx = Brx.graph_node(bfx, u_Rx, du_Rx);
-
-        auto bfy = Bfy.graph_node(parent, u_D, du_Ry);
-        auto bry = Bry.graph_node(bfy, u_Ry, du_Ry);
+        // R-space corrections (3 independent passes)
+        const auto& f = fused();
+        auto brx = f.BRx.graph_node(parent, {u_D, u_Rx}, du_Rx);
+        auto bry = f.BRy.graph_node(parent, {u_D, u_Ry}, du_Ry);
+        auto brz = f.BRz.graph_node(parent, {u_D, u_Rz}, du_Rz);
 
-        auto bfz = Bfz.graph_node(parent, u_D, du_Rz);
-        auto brz = Brz.graph_node(bfz, u_Rz, du_Rz);
-
-        // D-space chain with Neumann
-        auto o = O.graph_node(parent, u_D, du_D, op);
-        auto b = B.graph_node(o, b_src, du_D);
-        auto n = N.graph_node(b, nu_D, du_D);
+        // D-space chain with B and N applied in one pass
+        auto o = block_nodes(parent, u_D, du_D, op, with_block);
+        auto n = f.BN.graph_node(o, {b_src, nu_f}, du_D);
 
         return Kokkos::Experimental::when_all(brx, bry, brz, n);
     }
@@ -87,6 +87,17 @@ owned_scalar eval_at_mesh(const mesh& m, auto va)
     return result;
 }
 
+// The values of nu.D at the points of the Neumann faces of grid_bcs
+std::vector<real>
+on_faces(const mesh& m, const bcs::Grid& grid_bcs, const owned_scalar& nu)
+{
+    const auto faces = neumann_faces{m.extents(), grid_bcs};
+    std::vector<real> v(faces.size());
+    for (integer s = 0; s < faces.size(); ++s)
+        v[s] = nu.d_vec[m.extents()(faces.point(s).second)];
+    return v;
+}
+
 void fill_scalar(owned_scalar& s, real val)
 {
     std::ranges::fill(s.d_vec, val);
@@ -181,14 +192,15 @@ TEST_CASE("E2_Neumann")
 
     const auto objectBcs = bcs::Object{};
 
+    const auto gridBcs = bcs::Grid{bcs::dd, bcs::ff, bcs::nn};
+
     // initialize fields
     auto u = eval_at_mesh(m, f2);
-    auto nu = eval_at_mesh(m, f2_dz);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dz));
     auto ex = eval_at_mesh(m, f2_ddz);
 
     auto du = make_scalar(m);
 
-    const auto gridBcs = bcs::Grid{bcs::dd, bcs::ff, bcs::nn};
     zero_grid_dirichlet(m, gridBcs, ex);
 
     auto d = derivative(2, m, stencils::second::E2, gridBcs, objectBcs);
@@ -206,6 +218,53 @@ TEST_CASE("E2_Neumann")
     approx_D(du, ex);
 }
 
+TEST_CASE("Neumann faces")
+{
+    const auto extents = int3{10, 13, 17};
+
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}}};
+
+    const auto objectBcs = bcs::Object{};
+    const auto gridBcs = bcs::Grid{bcs::nn, bcs::dn, bcs::ff};
+
+    // one plane per Neumann face, x min, x max then y max
+    const auto faces = neumann_faces{m.extents(), gridBcs};
+    REQUIRE(faces.size() == 2 * 13 * 17 + 10 * 17);
+    REQUIRE(faces.size(0, 1) == 13 * 17);
+    REQUIRE(faces.size(1, 0) == 0);
+    REQUIRE(faces.offset(1, 1) == 2 * 13 * 17);
+    REQUIRE(faces.size(2, 0) + faces.size(2, 1) == 0);
+
+    for (integer s = 0; s < faces.size(); ++s) {
+        const auto [dir, ijk] = faces.point(s);
+        const int side = ijk[dir] != 0;
+        REQUIRE(faces.slot(dir, side, ijk) == s);
+    }
+
+    // edges where x and y faces meet carry du/dx in their x slot and du/dy in their
+    // y slot
+    auto u = eval_at_mesh(m, f2);
+    const auto dx = eval_at_mesh(m, f2_dx);
+    const auto dy = eval_at_mesh(m, f2_dy);
+    std::vector<real> nu(faces.size());
+    for (integer s = 0; s < faces.size(); ++s) {
+        const auto [dir, ijk] = faces.point(s);
+        nu[s] = (dir == 0 ? dx : dy).d_vec[m.extents()(ijk)];
+    }
+
+    std::array<owned_scalar, 2> dd{eval_at_mesh(m, f2_ddx), eval_at_mesh(m, f2_ddy)};
+    for (int i = 0; i < 2; ++i) {
+        auto du = make_scalar(m);
+        auto d = derivative{i, m, stencils::second::E2, gridBcs, objectBcs};
+        d(u, nu, du);
+
+        auto& ex = dd[i];
+        zero_grid_dirichlet(m, gridBcs, ex);
+        approx_D(du, ex);
+    }
+}
+
 TEST_CASE("Identity FFFFFF")
 {
     const auto extents = int3{5, 7, 6};
@@ -280,7 +339,7 @@ TEST_CASE("Identity Mixed")
         const auto gridBcs = bcs::Grid{bcs::dd, bcs::fn, bcs::fd};
         // set the exact du we expect based on zeros assigned to dirichlet locations
         auto du_exact = copy_scalar(u);
-        auto nu = copy_scalar(u);
+        const auto nu = on_faces(m, gridBcs, u);
 
         // set zeros for dirichlet at xmin/xmax
         zero_grid_dirichlet(m, gridBcs, du_exact);
@@ -303,7 +362,7 @@ TEST_CASE("Identity Mixed")
         const auto gridBcs = bcs::Grid{bcs::nn, bcs::dd, bcs::df};
         // set the exact du we expect based on zeros assigned to dirichlet locations
         auto du_exact = copy_scalar(u);
-        auto nu = copy_scalar(u);
+        const auto nu = on_faces(m, gridBcs, u);
 
         // set zeros for dirichlet at xmin/xmax
         zero_grid_dirichlet(m, gridBcs, du_exact);
@@ -362,7 +421,7 @@ TEST_CASE("E2 Mixed")
 
         const auto gridBcs = bcs::Grid{bcs::fn, bcs::dd, bcs::df};
         // set the exact du we expect based on zeros assigned to dirichlet locations
-        auto nu = eval_at_mesh(m, f2_dx);
+        const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dx));
         std::array<owned_scalar, 3> dd{
             eval_at_mesh(m, f2_ddx), eval_at_mesh(m, f2_ddy), eval_at_mesh(m, f2_ddz)};
 
@@ -496,7 +555,7 @@ TEST_CASE("graph matches eager with Neumann")
     const auto gridBcs = bcs::Grid{bcs::dd, bcs::ff, bcs::nn};
 
     auto u = eval_at_mesh(m, f2);
-    auto nu = eval_at_mesh(m, f2_dz);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dz));
 
     auto d = derivative(2, m, stencils::second::E2, gridBcs, objectBcs);
 
@@ -527,7 +586,7 @@ TEST_CASE("E2 with Objects")
     auto u = eval_at_mesh(m, f2);
     REQUIRE(u.rx_vec.size() == m.Rx().size());
 
-    auto nu = eval_at_mesh(m, f2_dx);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dx));
 
     auto du_x = make_scalar(m);
     auto du_y = make_scalar(m);
@@ -566,3 +625,209 @@ TEST_CASE("E2 with Objects")
     dz(u, du);
     approx_all(du, du_z);
 }
+
+TEST_CASE("sell layout with Objects")
+{
+    const auto extents = int3{25, 26, 27};
+
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.45, 1.011, 1.31}, 0.25)}};
+
+    const auto gridBcs = bcs::Grid{bcs::nn, bcs::dd, bcs::ff};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+
+    auto u = eval_at_mesh(m, f2);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dx));
+
+    for (int i = 0; i < 3; i++) {
+        auto d = derivative{i, m, stencils::second::E2, gridBcs, objectBcs};
+        REQUIRE(d.sparse_size() > 0);
+
+        auto du_csr = make_scalar(m);
+        d(u, nu, du_csr);
+
+        d.sparse_layout(matrix::csr_layout::sell, 4, 64);
+        auto du_sell = make_scalar(m);
+        d(u, nu, du_sell);
+        approx_all(du_sell, du_csr);
+
+        auto du_graph = make_scalar(m);
+        d.build_graph(u, nu, du_graph);
+        d.submit_graph();
+        approx_all(du_graph, du_csr);
+    }
+}
+
+TEST_CASE("multi-vector with Objects")
+{
+    const auto extents = int3{15, 16, 17};
+
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 1.25}, 0.25)}};
+
+    const auto gridBcs = bcs::Grid{bcs::dd, bcs::dd, bcs::ff};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+
+    randomize();
+    auto random_scalar = [&m]() {
+        auto s = make_scalar(m);
+        for (auto* v : {&s.d_vec, &s.rx_vec, &s.ry_vec, &s.rz_vec})
+            std::ranges::generate(*v, [] { return pick(); });
+        return s;
+    };
+
+    // more fields than matrix::max_vectors so the eager path runs several groups
+    const int k = matrix::max_vectors + 2;
+    std::vector<owned_scalar> u, du_single, du_multi, du_graph;
+    for (int f = 0; f < k; ++f) {
+        u.push_back(random_scalar());
+        du_single.push_back(make_scalar(m));
+        du_multi.push_back(make_scalar(m));
+        du_graph.push_back(make_scalar(m));
+    }
+    std::vector<scalar_view> u_v(u.begin(), u.end());
+    std::vector<scalar_span> du_multi_sp(du_multi.begin(), du_multi.end());
+    std::vector<scalar_span> du_graph_sp(du_graph.begin(), du_graph.end());
+
+    for (int i = 0; i < 3; i++) {
+        auto d = derivative{i, m, stencils::second::E2, gridBcs, objectBcs};
+
+        for (int f = 0; f < k; ++f) d(u[f], du_single[f]);
+        d(u_v, du_multi_sp);
+        for (int f = 0; f < k; ++f) approx_all(du_multi[f], du_single[f]);
+
+        const auto n = (std::size_t)matrix::max_vectors;
+        auto graph = Kokkos::Experimental::create_graph<execution_space>([&](auto root) {
+            d.add_graph_nodes(root,
+                              std::span<const scalar_view>{u_v}.first(n),
+                              std::span<const scalar_span>{du_graph_sp}.first(n));
+        });
+        graph.instantiate();
+        graph.submit();
+        Kokkos::fence();
+        for (std::size_t f = 0; f < n; ++f) approx_all(du_graph[f], du_single[f]);
+    }
+}
+
+TEST_CASE("pencil mode matches strided")
+{
+    const auto extents = int3{15, 16, 17};
+
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 1.25}, 0.25)}};
+
+    const auto gridBcs = bcs::Grid{bcs::nn, bcs::dd, bcs::ff};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+
+    randomize();
+    auto u = eval_at_mesh(m, std::views::transform([](auto&&) { return pick(); }));
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dx));
+
+    REQUIRE(derivative::preferred_mode(2, m.extents()) == derivative_mode::strided);
+    REQUIRE(derivative::preferred_mode(0, m.extents()) == derivative_mode::strided);
+    REQUIRE(derivative::preferred_mode(0, index_extents{int3{128, 64, 64}}) ==
+            derivative_mode::pencil);
+
+    // construction stays strided even where pencils are preferred
+    {
+        auto big = mesh{index_extents{int3{80, 64, 64}},
+                        domain_extents{.min = {0, 0, 0}, .max = {1, 1, 1}}};
+        REQUIRE(derivative{0, big, stencils::second::E2, gridBcs, bcs::Object{}}.mode() ==
+                derivative_mode::strided);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        auto d = derivative{i, m, stencils::second::E2, gridBcs, objectBcs};
+        REQUIRE(d.mode() == derivative_mode::strided);
+
+        auto du_strided = make_scalar(m);
+        d(u, nu, du_strided);
+        auto du_strided_plus = eval_at_mesh(m, f2);
+        d(u, nu, du_strided_plus, plus_eq);
+
+        d.mode(derivative_mode::pencil);
+        REQUIRE(d.mode() == (i == 2 ? derivative_mode::strided : derivative_mode::pencil));
+
+        auto du = make_scalar(m);
+        d(u, nu, du);
+        approx_all(du, du_strided);
+
+        du = eval_at_mesh(m, f2);
+        d(u, nu, du, plus_eq);
+        approx_all(du, du_strided_plus);
+
+        auto du_graph = eval_at_mesh(m, f2);
+        d.build_graph(u, nu, du_graph, plus_eq);
+        d.submit_graph();
+        approx_all(du_graph, du_strided_plus);
+
+        // stay transposed: block in pencils, corrections in the natural ordering
+        const auto n = d.pencils().size();
+        std::vector<real> u_p(n), du_p(n);
+        auto du_t = make_scalar(m);
+        d.to_pencils(u.d_vec, u_p);
+        d.pencil_block(u_p, du_p);
+        d.from_pencils(du_p, du_t.d_vec);
+        d.apply_corrections(u, nu, du_t);
+        Kokkos::fence();
+        approx_all(du_t, du_strided);
+    }
+}
+
+TEST_CASE("xyz matches separate construction")
+{
+    // more lines and cut points than one assembly chunk, so several chunks are merged
+    const auto extents = int3{25, 26, 27};
+
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.45, 1.011, 1.31}, 0.25)}};
+
+    const auto gridBcs = bcs::Grid{bcs::nn, bcs::dd, bcs::ff};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+
+    randomize();
+    auto u = make_scalar(m);
+    for (auto* v : {&u.d_vec, &u.rx_vec, &u.ry_vec, &u.rz_vec})
+        std::ranges::generate(*v, [] { return pick(); });
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dx));
+
+    auto same_csr = [](const matrix::csr& a, const matrix::csr& b) {
+        REQUIRE(a.rows() == b.rows());
+        REQUIRE(a.size() == b.size());
+        REQUIRE(a.flags() == b.flags());
+        for (integer r = 0; r < a.rows(); ++r) {
+            REQUIRE(std::ranges::equal(a.column_indices(r), b.column_indices(r)));
+            REQUIRE(
+                std::ranges::equal(a.column_coefficients(r), b.column_coefficients(r)));
+        }
+    };
+
+    auto xyz = derivative::xyz(m, stencils::second::E2, gridBcs, objectBcs);
+    for (int i = 0; i < 3; i++) {
+        const auto d = derivative{i, m, stencils::second::E2, gridBcs, objectBcs};
+        const auto& e = xyz[i];
+        REQUIRE(d.sparse_size() > 0);
+        REQUIRE(e.sparse_size() == d.sparse_size());
+
+        same_csr(e.boundary_matrix(), d.boundary_matrix());
+        same_csr(e.neumann_matrix(), d.neumann_matrix());
+        for (int r = 0; r < 3; ++r) {
+            same_csr(*e.cut_matrices(r)[0], *d.cut_matrices(r)[0]);
+            same_csr(*e.cut_matrices(r)[1], *d.cut_matrices(r)[1]);
+        }
+
+        // bitwise identical results
+        auto du_d = make_scalar(m);
+        auto du_e = make_scalar(m);
+        d(u, nu, du_d);
+        e(u, nu, du_e);
+        REQUIRE(du_e.d_vec == du_d.d_vec);
+        REQUIRE(du_e.rx_vec == du_d.rx_vec);
+        REQUIRE(du_e.ry_vec == du_d.ry_vec);
+        REQUIRE(du_e.rz_vec == du_d.rz_vec);
+    }
+}
@@ -0,0 +1,77 @@
+#include "divergence.hpp"
+
+#include "io/logging.hpp"
+
+#include <Kokkos_Profiling_ScopedRegion.hpp>
+
+#include <fmt/ranges.h>
+#include <string>
+#include <vector>
+
+namespace ccs
+{
+divergence::divergence(const mesh& m,
+                       const stencil& st,
+                       const bcs::Grid& grid_bcs,
+                       const bcs::Object& obj_bcs,
+                       const logs& build_logger,
+                       int3 tile,
+                       const operator_cache& cache)
+{
+    logs logger{build_logger, "divergence", "divergence.csv"};
+    logger.set_pattern("%v");
+    auto st_info = st.query_max();
+    std::vector<std::string> hdr(st_info.t - 1, "wall,psi");
+    logger(spdlog::level::info,
+           "timestamp,deriv,interp_dir,ic,y,psi,{}",
+           fmt::join(hdr, ","));
+    logger.set_pattern("%Y-%m-%d %H:%M:%S.%f,%v");
+
+    auto dxyz = derivative::xyz(m, st, grid_bcs, obj_bcs, logger, cache);
+    dx = MOVE(dxyz[0]);
+    dy = MOVE(dxyz[1]);
+    dz = MOVE(dxyz[2]);
+    ex = m.extents();
+
+    const auto blocks = std::array<const matrix::block*, 3>{
+        &dx.block_matrix(), &dy.block_matrix(), &dz.block_matrix()};
+    tiles = matrix::tiled_blocks{blocks, ex, tile};
+
+    // Source ids follow the comment on corr_D and corr_R.
+    corr_D = matrix::csr::merge(std::array{
+        &dx.boundary_matrix(), &dy.boundary_matrix(), &dz.boundary_matrix()});
+    for (int r = 0; r < 3; ++r) {
+        const auto [fx, bx] = dx.cut_matrices(r);
+        const auto [fy, by] = dy.cut_matrices(r);
+        const auto [fz, bz] = dz.cut_matrices(r);
+        corr_R[r] = matrix::csr::merge(std::array{fx, bx, fy, by, fz, bz});
+    }
+}
+
+std::function<void(scalar_span)> divergence::operator()(const vector_view& F) const
+{
+    return [this, F](scalar_span du) {
+        Kokkos::Profiling::ScopedRegion region("divergence::operator()");
+        const auto f = R_functor(F, du);
+        tiles({F[0].D.data(), F[1].D.data(), F[2].D.data()}, du.D, corr_D, D_sources(F));
+        Kokkos::parallel_for(Kokkos::RangePolicy<execution_space>(0, f.size()), f);
+        Kokkos::fence("divergence::operator() complete");
+    };
+}
+
+void divergence::build_graph(const vector_view& F, scalar_span du)
+{
+    graph_ = Kokkos::Experimental::create_graph<execution_space>(
+        [&](auto root) { add_graph_nodes(root, F, du); });
+
+    graph_->instantiate();
+}
+
+void divergence::submit_graph()
+{
+    Kokkos::Profiling::ScopedRegion region("divergence::submit_graph()");
+    graph_->submit();
+    Kokkos::fence("divergence::submit_graph() complete");
+}
+
+} // namespace ccs
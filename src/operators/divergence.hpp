@@ -0,0 +1,105 @@
+#pragma once
+
+#include "derivative.hpp"
+#include "fields/scalar.hpp"
+#include "fused_corrections.hpp"
+#include "matrices/tiled_blocks.hpp"
+
+#include <Kokkos_Graph.hpp>
+#include <array>
+#include <optional>
+
+namespace ccs
+{
+
+// du = dF_x/dx + dF_y/dy + dF_z/dz for a vector field F = {F_x, F_y, F_z}, e.g. the
+// components of extract_vector_view.  Evaluated like laplacian_kernel::fused: one
+// tiled pass applies the block rows of direction d to F_d and adds the merged B
+// corrections, and a second pass assigns Rx, Ry and Rz from the merged Bf/Br
+// matrices.  Every entry of du is written.
+class divergence
+{
+    derivative dx;
+    derivative dy;
+    derivative dz;
+    index_extents ex;
+    matrix::tiled_blocks tiles;
+    // B of each direction, reading {F_x.Rx, F_y.Ry, F_z.Rz}, and for each R space r
+    // the Bf/Br pairs of all directions, reading
+    // {F_x.D, F_x.R<r>, F_y.D, F_y.R<r>, F_z.D, F_z.R<r>}
+    matrix::csr corr_D;
+    matrix::csr corr_R[3];
+
+    // Pre-built graph for submit_graph().
+    std::optional<Kokkos::Experimental::Graph<execution_space>> graph_;
+
+    using vector_view = std::array<scalar_view, 3>;
+
+    static matrix::csr::sources D_sources(const vector_view& F)
+    {
+        return {F[0].Rx.data(), F[1].Ry.data(), F[2].Rz.data()};
+    }
+
+    fused_R_functor R_functor(const vector_view& F, scalar_span du) const
+    {
+        const matrix::csr::sources x[3]{
+            {F[0].D.data(),
+             F[0].Rx.data(),
+             F[1].D.data(),
+             F[1].Rx.data(),
+             F[2].D.data(),
+             F[2].Rx.data()},
+            {F[0].D.data(),
+             F[0].Ry.data(),
+             F[1].D.data(),
+             F[1].Ry.data(),
+             F[2].D.data(),
+             F[2].Ry.data()},
+            {F[0].D.data(),
+             F[0].Rz.data(),
+             F[1].D.data(),
+             F[1].Rz.data(),
+             F[2].D.data(),
+             F[2].Rz.data()}};
+        return fused_R(corr_R, x, du);
+    }
+
+public:
+    divergence() = default;
+
+    // `tile` is the tile extent of the D-space pass, see laplacian::kernel.  The
+    // derivatives are read from `cache` when it holds them.
+    divergence(const mesh&,
+               const stencil&,
+               const bcs::Grid&,
+               const bcs::Object&,
+               const logs& = {},
+               int3 tile = {8, 8, 64},
+               const operator_cache& = {});
+
+    std::function<void(scalar_span)> operator()(const vector_view& F) const;
+
+    // Build a pre-instantiated graph.
+    void build_graph(const vector_view& F, scalar_span du);
+
+    // Submit the pre-built graph.
+    void submit_graph();
+
+    // Add divergence nodes to an existing graph: one tiled node writing du.D and one
+    // node writing du.Rx, du.Ry and du.Rz, both children of parent.  Returns a
+    // when_all of the two.
+    template <typename NodeT>
+    auto add_graph_nodes(NodeT parent, const vector_view& F, scalar_span du) const
+    {
+        const auto f = R_functor(F, du);
+        auto d = tiles.graph_node(parent,
+                                  {F[0].D.data(), F[1].D.data(), F[2].D.data()},
+                                  du.D.data(),
+                                  corr_D,
+                                  D_sources(F));
+        auto r = parent.then_parallel_for(
+            "div_fused_R", Kokkos::RangePolicy<execution_space>(0, f.size()), f);
+        return Kokkos::Experimental::when_all(d, r);
+    }
+};
+} // namespace ccs
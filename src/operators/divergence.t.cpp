@@ -0,0 +1,179 @@
+#include "divergence.hpp"
+#include "gradient.hpp"
+
+#include "fields/field_registry.hpp"
+#include "fields/scalar.hpp"
+#include "stencils/stencil.hpp"
+
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include <algorithm>
+#include <ranges>
+
+#include <Kokkos_Core.hpp>
+
+// Custom main: Kokkos must be initialized before parallel_for calls.
+int main(int argc, char* argv[])
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    return Catch::Session().run(argc, argv);
+}
+
+using namespace ccs;
+using Catch::Matchers::Approx;
+
+const std::vector<real> alpha{
+    -1.47956280234494, 0.261900367793859, -0.145072532538541, -0.224665713988644};
+
+// flux components
+constexpr auto fx = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return 1 + x * y - z;
+});
+
+constexpr auto fy = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return -0.5 + x * z;
+});
+
+constexpr auto fz = std::views::transform([](auto&& loc) {
+    auto&& [x, y, z] = loc;
+    return 2 - y;
+});
+
+// Owning scalar: 4 vectors with implicit conversion to scalar_view/scalar_span.
+struct owned_scalar {
+    std::vector<real> d_vec, rx_vec, ry_vec, rz_vec;
+
+    operator scalar_view() const { return {d_vec, rx_vec, ry_vec, rz_vec}; }
+    operator scalar_span() { return {d_vec, rx_vec, ry_vec, rz_vec}; }
+};
+
+owned_scalar make_scalar(const mesh& m, real val = 0)
+{
+    return {std::vector<real>(m.size(), val),
+            std::vector<real>(m.Rx().size(), val),
+            std::vector<real>(m.Ry().size(), val),
+            std::vector<real>(m.Rz().size(), val)};
+}
+
+// Evaluate a view adaptor at all mesh locations, producing an owned_scalar.
+owned_scalar eval_at_mesh(const mesh& m, auto va)
+{
+    auto result = make_scalar(m);
+    auto pos = std::views::transform(&mesh_object_info::position);
+    std::ranges::copy(ccs::cartesian_product(m.x(), m.y(), m.z()) | va,
+                      result.d_vec.begin());
+    std::ranges::copy(m.Rx() | pos | va, result.rx_vec.begin());
+    std::ranges::copy(m.Ry() | pos | va, result.ry_vec.begin());
+    std::ranges::copy(m.Rz() | pos | va, result.rz_vec.begin());
+    return result;
+}
+
+void require_same(const owned_scalar& a, const owned_scalar& b)
+{
+    REQUIRE_THAT(a.d_vec, Approx(b.d_vec));
+    REQUIRE_THAT(a.rx_vec, Approx(b.rx_vec));
+    REQUIRE_THAT(a.ry_vec, Approx(b.ry_vec));
+    REQUIRE_THAT(a.rz_vec, Approx(b.rz_vec));
+}
+
+// d(F_x)/dx + d(F_y)/dy + d(F_z)/dz from three gradients
+owned_scalar divergence_from_gradient(const mesh& m,
+                                      const gradient& grad,
+                                      const std::array<owned_scalar, 3>& F)
+{
+    auto res = make_scalar(m);
+    for (int c = 0; c < 3; ++c) {
+        std::array du{make_scalar(m), make_scalar(m), make_scalar(m)};
+        grad(F[c])(du[0], du[1], du[2]);
+        for (auto v : {&owned_scalar::d_vec,
+                       &owned_scalar::rx_vec,
+                       &owned_scalar::ry_vec,
+                       &owned_scalar::rz_vec})
+            for (std::size_t i = 0; i < (res.*v).size(); ++i)
+                (res.*v)[i] += (du[c].*v)[i];
+    }
+    return res;
+}
+
+// divergence must agree with the sum of the gradient components, writing every entry
+// of du.  The sphere leaves enough points between it and the walls that the E2_1
+// boundary closures of a line do not overlap.
+void check_against_gradient(const mesh& m, const bcs::Grid& gridBcs, int3 tile)
+{
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto st = stencils::make_E2_1(alpha);
+
+    const std::array F{eval_at_mesh(m, fx), eval_at_mesh(m, fy), eval_at_mesh(m, fz)};
+    const std::array<scalar_view, 3> F_v{F[0], F[1], F[2]};
+
+    const auto expected =
+        divergence_from_gradient(m, gradient{m, st, gridBcs, objectBcs}, F);
+
+    auto div = divergence{m, st, gridBcs, objectBcs, {}, tile};
+
+    auto out = make_scalar(m, 7.0);
+    scalar_span out_sp = out;
+    out_sp = div(F_v);
+    require_same(out, expected);
+
+    auto out_graph = make_scalar(m, 7.0);
+    scalar_span out_graph_sp = out_graph;
+    div.build_graph(F_v, out_graph_sp);
+    div.submit_graph();
+    require_same(out_graph, expected);
+}
+
+TEST_CASE("matches gradient")
+{
+    auto m = mesh{index_extents{int3{25, 25, 25}},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 1.25}, 0.15)}};
+
+    for (auto tile : {int3{8, 8, 64}, int3{4, 5, 6}})
+        check_against_gradient(m, bcs::Grid{bcs::dd, bcs::ff, bcs::fd}, tile);
+}
+
+TEST_CASE("2D matches gradient")
+{
+    auto m = mesh{index_extents{int3{25, 26, 1}},
+                  domain_extents{.min = {0.1, 0.2, 0}, .max = {1, 2, 0}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 0}, 0.15)}};
+
+    check_against_gradient(m, bcs::Grid{bcs::dd, bcs::fd, bcs::ff}, {8, 8, 1});
+}
+
+TEST_CASE("registry vector field")
+{
+    auto m = mesh{index_extents{int3{25, 25, 25}},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.55, 1.1, 1.25}, 0.15)}};
+    const auto gridBcs = bcs::Grid{bcs::dd, bcs::ff, bcs::fd};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto st = stencils::make_E2_1(alpha);
+
+    const std::array F{eval_at_mesh(m, fx), eval_at_mesh(m, fy), eval_at_mesh(m, fz)};
+
+    sim_registry reg;
+    const auto vh = vector_handle{field_layout<8, 4>::vector_base};
+    const auto ref =
+        reg.allocate_vector(0, 0, m.size(), m.Rx().size(), m.Ry().size(), m.Rz().size());
+    const auto comps = vh.components();
+    for (int c = 0; c < 3; ++c) {
+        std::ranges::copy(F[c].d_vec, reg.data(ref, comps[c].D()));
+        std::ranges::copy(F[c].rx_vec, reg.data(ref, comps[c].Rx()));
+        std::ranges::copy(F[c].ry_vec, reg.data(ref, comps[c].Ry()));
+        std::ranges::copy(F[c].rz_vec, reg.data(ref, comps[c].Rz()));
+    }
+
+    auto div = divergence{m, st, gridBcs, objectBcs};
+    auto out = make_scalar(m);
+    scalar_span out_sp = out;
+    out_sp = div(extract_vector_view(std::as_const(reg), ref, vh));
+
+    require_same(out,
+                 divergence_from_gradient(m, gradient{m, st, gridBcs, objectBcs}, F));
+}
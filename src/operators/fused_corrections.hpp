@@ -0,0 +1,48 @@
+#pragma once
+
+#include "fields/scalar.hpp"
+#include "matrices/csr.hpp"
+
+namespace ccs
+{
+// Named functor for the R-space kernel of the fused operators: du.R<r> = C[r] applied
+// to x[r] (e.g. {u.D, u.R<r>}) for all three R spaces in one range.  The R spaces are laid end to
+// end: index i of the range is row i - offset[r] of R space r, for
+// offset[r] <= i < offset[r + 1], and every row is assigned so no zero pass is needed.
+struct fused_R_functor {
+    matrix::csr::row_view rows[3];
+    matrix::csr::sources x[3];
+    real* b[3];
+    integer offset[4];
+
+    KOKKOS_INLINE_FUNCTION void operator()(integer i) const
+    {
+        const int r = i < offset[1] ? 0 : i < offset[2] ? 1 : 2;
+        const integer row = i - offset[r];
+        b[r][row] = rows[r].dot(row, x[r]);
+    }
+
+    integer size() const { return offset[3]; }
+};
+
+inline fused_R_functor fused_R(const matrix::csr (&C)[3],
+                               const matrix::csr::sources (&x)[3],
+                               scalar_span du)
+{
+    const integer nx = du.Rx.size(), ny = du.Ry.size(), nz = du.Rz.size();
+    return {{C[0].rows_view(), C[1].rows_view(), C[2].rows_view()},
+            {x[0], x[1], x[2]},
+            {du.Rx.data(), du.Ry.data(), du.Rz.data()},
+            {0, nx, nx + ny, nx + ny + nz}};
+}
+
+// C[r] reading {u.D, u.R<r>}
+inline fused_R_functor
+fused_R(const matrix::csr (&C)[3], scalar_view u, scalar_span du)
+{
+    const real* u_D = u.D.data();
+    const matrix::csr::sources x[3]{
+        {u_D, u.Rx.data()}, {u_D, u.Ry.data()}, {u_D, u.Rz.data()}};
+    return fused_R(C, x, du);
+}
+} // namespace ccs
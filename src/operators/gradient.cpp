@@ -14,7 +14,8 @@ gradient::gradient(const mesh& m,
                    const stencil& st,
                    const bcs::Grid& grid_bcs,
                    const bcs::Object& obj_bcs,
-                   const logs& build_logger)
+                   const logs& build_logger,
+                   const operator_cache& cache)
 {
     logs logger{build_logger, "gradient", "gradient.csv"};
     logger.set_pattern("%v");
@@ -25,9 +26,10 @@ gradient::gradient(const mesh& m,
            fmt::join(hdr, ","));
     logger.set_pattern("%Y-%m-%d %H:%M:%S.%f,%v");
 
-    dx = derivative{0, m, st, grid_bcs, obj_bcs, logger};
-    dy = derivative{1, m, st, grid_bcs, obj_bcs, logger};
-    dz = derivative{2, m, st, grid_bcs, obj_bcs, logger};
+    auto dxyz = derivative::xyz(m, st, grid_bcs, obj_bcs, logger, cache);
+    dx = MOVE(dxyz[0]);
+    dy = MOVE(dxyz[1]);
+    dz = MOVE(dxyz[2]);
     ex = m.extents();
 }
 
@@ -44,4 +46,14 @@ gradient::operator()(scalar_view u) const
         if (ex[2] > 1) dz(u, du_z);
     };
 }
+
+void gradient::tune(matrix::tuning_cache& cache, int reps)
+{
+    for (auto* d : {&dx, &dy, &dz}) d->tune(cache, reps);
+}
+
+void gradient::precision(matrix::storage_precision p)
+{
+    for (auto* d : {&dx, &dy, &dz}) d->precision(p);
+}
 } // namespace ccs
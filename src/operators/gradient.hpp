@@ -19,16 +19,24 @@ class gradient
 public:
     gradient() = default;
 
+    // The derivatives are read from `cache` when it holds them.
     gradient(const mesh&,
              const stencil&,
              const bcs::Grid&,
              const bcs::Object&,
-             const logs& = {});
+             const logs& = {},
+             const operator_cache& = {});
 
     std::function<void(scalar_span, scalar_span, scalar_span)> operator()(scalar_view) const;
 
     void visit(operator_visitor& v) const { return v.visit(dx); }
 
+    // Tune the block matvec of each direction, see derivative::tune.
+    void tune(matrix::tuning_cache& cache, int reps = 3);
+
+    // Storage precision of the block coefficients, see derivative::precision.
+    void precision(matrix::storage_precision p);
+
     // Add gradient nodes to an existing graph. Zeros du_x/du_y/du_z, then
     // chains dx/dy/dz in parallel (independent outputs), returns when_all.
     template <typename NodeT>
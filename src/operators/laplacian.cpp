@@ -5,17 +5,32 @@
 #include <Kokkos_Profiling_ScopedRegion.hpp>
 
 #include <fmt/ranges.h>
+#include <array>
 #include <string>
 #include <vector>
 
 namespace ccs
 {
+namespace
+{
+// zero the boundary components of du, leaving D alone
+void zero_R(scalar_span du)
+{
+    for (auto r : {du.Rx, du.Ry, du.Rz}) {
+        real* ptr = r.data();
+        Kokkos::parallel_for(
+            Kokkos::RangePolicy<execution_space>(0, static_cast<int>(r.size())),
+            KOKKOS_LAMBDA(int i) { ptr[i] = 0; });
+    }
+}
+} // namespace
 
 laplacian::laplacian(const mesh& m,
                      const stencil& st,
                      const bcs::Grid& grid_bcs,
                      const bcs::Object& obj_bcs,
-                     const logs& build_logger)
+                     const logs& build_logger,
+                     const operator_cache& cache)
 
 {
     logs logger{build_logger, "laplacian", "laplacian.csv"};
@@ -27,9 +42,10 @@ laplacian::laplacian(const mesh& m,
            fmt::join(hdr, ","));
     logger.set_pattern("%Y-%m-%d %H:%M:%S.%f,%v");
 
-    dx = derivative{0, m, st, grid_bcs, obj_bcs, logger};
-    dy = derivative{1, m, st, grid_bcs, obj_bcs, logger};
-    dz = derivative{2, m, st, grid_bcs, obj_bcs, logger};
+    auto dxyz = derivative::xyz(m, st, grid_bcs, obj_bcs, logger, cache);
+    dx = MOVE(dxyz[0]);
+    dy = MOVE(dxyz[1]);
+    dz = MOVE(dxyz[2]);
     ex = m.extents();
 }
 
@@ -38,6 +54,20 @@ std::function<void(scalar_span)> laplacian::operator()(scalar_view u) const
 {
     return [this, u](scalar_span du) {
         Kokkos::Profiling::ScopedRegion region("laplacian::operator()");
+        if (kernel_ == laplacian_kernel::fused) {
+            apply_fused(u, du, corr_D, {u.Rx.data(), u.Ry.data(), u.Rz.data()});
+            Kokkos::fence("laplacian::operator() complete");
+            return;
+        }
+        if (kernel_ == laplacian_kernel::tiled) {
+            zero_R(du);
+            tiles(u.D, du.D);
+            if (ex[0] > 1) dx.apply_corrections(u, du);
+            if (ex[1] > 1) dy.apply_corrections(u, du);
+            if (ex[2] > 1) dz.apply_corrections(u, du);
+            Kokkos::fence("laplacian::operator() complete");
+            return;
+        }
         du = 0;
         if (ex[0] > 1) dx(u, du, plus_eq);
         if (ex[1] > 1) dy(u, du, plus_eq);
@@ -46,10 +76,27 @@ std::function<void(scalar_span)> laplacian::operator()(scalar_view u) const
 }
 
 std::function<void(scalar_span)> laplacian::operator()(scalar_view u,
-                                                       scalar_view nu) const
+                                                       std::span<const real> nu) const
 {
     return [this, u, nu](scalar_span du) {
         Kokkos::Profiling::ScopedRegion region("laplacian::operator()");
+        if (kernel_ == laplacian_kernel::fused) {
+            apply_fused(u,
+                        du,
+                        corr_DN,
+                        {u.Rx.data(), u.Ry.data(), u.Rz.data(), nu.data()});
+            Kokkos::fence("laplacian::operator() with Neumann complete");
+            return;
+        }
+        if (kernel_ == laplacian_kernel::tiled) {
+            zero_R(du);
+            tiles(u.D, du.D);
+            if (ex[0] > 1) dx.apply_corrections(u, nu, du);
+            if (ex[1] > 1) dy.apply_corrections(u, nu, du);
+            if (ex[2] > 1) dz.apply_corrections(u, nu, du);
+            Kokkos::fence("laplacian::operator() with Neumann complete");
+            return;
+        }
         du = 0;
         // accumulate results into du
         if (ex[0] > 1) dx(u, nu, du, plus_eq);
@@ -59,20 +106,91 @@ std::function<void(scalar_span)> laplacian::operator()(scalar_view u,
 }
 void laplacian::build_graph(scalar_view u, scalar_span du)
 {
-    graph_ = Kokkos::Experimental::create_graph<execution_space>(
-        [&](auto root) { add_graph_nodes(root, u, du); });
+    graph_ = Kokkos::Experimental::create_graph<execution_space>([&](auto root) {
+        if (kernel_ == laplacian_kernel::fused)
+            add_fused_graph_nodes(root, u, du);
+        else
+            add_graph_nodes(root, u, du);
+    });
 
     graph_->instantiate();
 }
 
-void laplacian::build_graph(scalar_view u, scalar_view nu, scalar_span du)
+void laplacian::build_graph(scalar_view u, std::span<const real> nu, scalar_span du)
 {
-    graph_ = Kokkos::Experimental::create_graph<execution_space>(
-        [&](auto root) { add_graph_nodes(root, u, nu, du); });
+    graph_ = Kokkos::Experimental::create_graph<execution_space>([&](auto root) {
+        if (kernel_ == laplacian_kernel::fused)
+            add_fused_graph_nodes(root, u, nu, du);
+        else
+            add_graph_nodes(root, u, nu, du);
+    });
 
     graph_->instantiate();
 }
 
+void laplacian::kernel(laplacian_kernel k, int3 tile)
+{
+    auto ds = std::array{&dx, &dy, &dz};
+    if (k == laplacian_kernel::sweep) {
+        if (kernel_ != laplacian_kernel::sweep)
+            for (int i = 0; i < 3; ++i) ds[i]->mode(sweep_modes[i]);
+        kernel_ = k;
+        return;
+    }
+
+    // tiled_blocks applies the strided blocks itself, so pencil scratch would be unused
+    if (kernel_ == laplacian_kernel::sweep)
+        for (int i = 0; i < 3; ++i) sweep_modes[i] = ds[i]->mode();
+    for (auto* d : ds) d->mode(derivative_mode::strided);
+    kernel_ = k;
+
+    const auto blocks = std::array<const matrix::block*, 3>{
+        &dx.block_matrix(), &dy.block_matrix(), &dz.block_matrix()};
+    tiles = matrix::tiled_blocks{blocks, ex, tile};
+    if (k != laplacian_kernel::fused) return;
+
+    // Source ids follow the comments on corr_D, corr_DN and corr_R
+    using parts3 = std::array<const matrix::csr*, 3>;
+    using parts6 = std::array<const matrix::csr*, 6>;
+    corr_D = matrix::csr::merge(
+        parts3{&dx.boundary_matrix(), &dy.boundary_matrix(), &dz.boundary_matrix()});
+    corr_DN = matrix::csr::merge(parts6{&dx.boundary_matrix(),
+                                        &dy.boundary_matrix(),
+                                        &dz.boundary_matrix(),
+                                        &dx.neumann_matrix(),
+                                        &dy.neumann_matrix(),
+                                        &dz.neumann_matrix()},
+                                 std::array{0, 1, 2, 3, 3, 3});
+    for (int r = 0; r < 3; ++r) {
+        const auto [fx, rx] = dx.cut_matrices(r);
+        const auto [fy, ry] = dy.cut_matrices(r);
+        const auto [fz, rz] = dz.cut_matrices(r);
+        corr_R[r] = matrix::csr::merge(parts6{fx, rx, fy, ry, fz, rz},
+                                       std::array{0, 1, 0, 1, 0, 1});
+    }
+}
+
+void laplacian::apply_fused(scalar_view u,
+                            scalar_span du,
+                            const matrix::csr& C,
+                            matrix::csr::sources x) const
+{
+    assert(kernel_ == laplacian_kernel::fused);
+    const auto f = fused_R(corr_R, u, du);
+    tiles(u.D, du.D, C, x);
+    Kokkos::parallel_for(Kokkos::RangePolicy<execution_space>(0, f.size()), f);
+}
+
+void laplacian::tune(matrix::tuning_cache& cache, int reps)
+{
+    for (auto* d : {&dx, &dy, &dz}) d->tune(cache, reps);
+}
+
+void laplacian::precision(matrix::storage_precision p)
+{
+    for (auto* d : {&dx, &dy, &dz}) d->precision(p);
+}
+
 void laplacian::submit_graph()
 {
     Kokkos::Profiling::ScopedRegion region("laplacian::submit_graph()");
@@ -1,49 +1,115 @@
 #pragma once
 
 #include "derivative.hpp"
+#include "fused_corrections.hpp"
+#include "matrices/tiled_blocks.hpp"
 
 #include <Kokkos_Graph.hpp>
+#include <array>
+#include <cassert>
 #include <optional>
 
 namespace ccs
 {
+// How the block rows of the three derivatives are applied.
+//   sweep - zero du, then one full sweep per direction
+//   tiled - x, y and z block rows applied tile by tile (matrix::tiled_blocks), with
+//           du written while the tile is cache resident and no separate zero pass
+//   fused - as tiled, with the cut-cell corrections of all three directions merged
+//           into the tiled pass over D and a single assigning pass over Rx, Ry and Rz
+enum class laplacian_kernel { sweep, tiled, fused };
+
 class laplacian
 {
     derivative dx;
     derivative dy;
     derivative dz;
     index_extents ex;
+    matrix::tiled_blocks tiles;
+    laplacian_kernel kernel_ = laplacian_kernel::sweep;
+    // modes of dx, dy and dz under laplacian_kernel::sweep, restored when switching
+    // back from tiled or fused (which run the derivatives strided)
+    std::array<derivative_mode, 3> sweep_modes{};
+    // laplacian_kernel::fused: the B matrices of dx, dy and dz merged to read
+    // {u.Rx, u.Ry, u.Rz}, the same with the N matrices reading nu as a fourth
+    // source, and for each R space the Bf/Br pairs of all directions reading
+    // {u.D, u.R*}
+    matrix::csr corr_D, corr_DN;
+    matrix::csr corr_R[3];
 
     // Pre-built graph for submit_graph().
     std::optional<Kokkos::Experimental::Graph<execution_space>> graph_;
 
+    // laplacian_kernel::fused applied eagerly with C as the D-space correction
+    void apply_fused(scalar_view u,
+                     scalar_span du,
+                     const matrix::csr& C,
+                     matrix::csr::sources x) const;
+
+    template <typename NodeT>
+    auto fused_nodes(NodeT parent,
+                     scalar_view u,
+                     scalar_span du,
+                     const matrix::csr& C,
+                     matrix::csr::sources x) const
+    {
+        assert(kernel_ == laplacian_kernel::fused);
+        const auto f = fused_R(corr_R, u, du);
+        auto d = tiles.graph_node(parent, u.D.data(), du.D.data(), C, x);
+        auto r = parent.then_parallel_for(
+            "lap_fused_R", Kokkos::RangePolicy<execution_space>(0, f.size()), f);
+        return Kokkos::Experimental::when_all(d, r);
+    }
+
 public:
     laplacian() = default;
 
+    // The derivatives are read from `cache` when it holds them.
     laplacian(const mesh&,
               const stencil&,
               const bcs::Grid&,
               const bcs::Object&,
-              const logs& logger = {});
+              const logs& logger = {},
+              const operator_cache& = {});
 
     // when there are no neumann conditions in the problem
     std::function<void(scalar_span)> operator()(scalar_view) const;
 
-    std::function<void(scalar_span)> operator()(scalar_view field_values,
-                                                scalar_view derivative_values) const;
+    // Neumann data is laid out by neumann_faces{m.extents(), grid_bcs}, one normal
+    // derivative for each point of every Neumann face.
+    std::function<void(scalar_span)>
+    operator()(scalar_view field_values, std::span<const real> derivative_values) const;
 
     // Build a pre-instantiated graph for the non-Neumann overload.
     void build_graph(scalar_view u, scalar_span du);
 
     // Build a pre-instantiated graph for the Neumann overload.
-    void build_graph(scalar_view u, scalar_view nu, scalar_span du);
+    void build_graph(scalar_view u, std::span<const real> nu, scalar_span du);
 
     // Submit the pre-built graph.
     void submit_graph();
 
+    // Select how the block rows are applied.  `tile` is the tile extent used by
+    // laplacian_kernel::tiled and fused; the default keeps u and du for a tile, with
+    // stencil halos, within a typical L2.  Graphs capture the choice when they are
+    // built.
+    void kernel(laplacian_kernel k, int3 tile = {8, 8, 64});
+    laplacian_kernel kernel() const { return kernel_; }
+
+    // Tune the block matvec of each direction, see derivative::tune.  This only affects
+    // laplacian_kernel::sweep.
+    void tune(matrix::tuning_cache& cache, int reps = 3);
+
+    // Storage precision of the block coefficients, see derivative::precision.  Like
+    // tune, this only affects laplacian_kernel::sweep.
+    void precision(matrix::storage_precision p);
+
     // Add laplacian nodes to an existing graph, chaining from parent.
-    // Zeros du, then chains dx → dy → dz (all accumulate with plus_eq).
-    // Returns the final node so the caller can chain further.
+    // Zeros du, then chains dx → dy → dz (all accumulate with plus_eq).  For the
+    // tiled kernel the D zero fill and the per-direction block nodes execute nothing
+    // and a single tiled node applies all block rows before the corrections.
+    // Returns the final node so the caller can chain further.  Use
+    // add_fused_graph_nodes for laplacian_kernel::fused.
     template <typename NodeT>
     auto add_graph_nodes(NodeT parent, scalar_view u, scalar_span du) const
     {
@@ -53,7 +119,8 @@ public:
         real* rx_ptr = du.Rx.data();
         real* ry_ptr = du.Ry.data();
         real* rz_ptr = du.Rz.data();
-        const int n_d = static_cast<int>(du.D.size());
+        const bool tiled = kernel_ == laplacian_kernel::tiled;
+        const int n_d = tiled ? 0 : static_cast<int>(du.D.size());
         const int n_rx = static_cast<int>(du.Rx.size());
         const int n_ry = static_cast<int>(du.Ry.size());
         const int n_rz = static_cast<int>(du.Rz.size());
@@ -73,16 +140,17 @@ public:
             KOKKOS_LAMBDA(int i) { rz_ptr[i] = 0; });
 
         auto zeroed = Kokkos::Experimental::when_all(z_d, z_rx, z_ry, z_rz);
+        auto blocks = tiles.graph_node(zeroed, u.D.data(), d_ptr, tiled);
 
         // Chain derivatives sequentially (all accumulate into du)
-        auto d0 = dx.add_graph_nodes(zeroed, u, du, plus_eq);
-        auto d1 = dy.add_graph_nodes(d0, u, du, plus_eq);
-        return dz.add_graph_nodes(d1, u, du, plus_eq);
+        auto d0 = dx.add_graph_nodes(blocks, u, du, plus_eq, !tiled);
+        auto d1 = dy.add_graph_nodes(d0, u, du, plus_eq, !tiled);
+        return dz.add_graph_nodes(d1, u, du, plus_eq, !tiled);
     }
 
     // Neumann overload: adds Neumann nodes at end of each derivative's D-space chain.
     template <typename NodeT>
-    auto add_graph_nodes(NodeT parent, scalar_view u, scalar_view nu,
+    auto add_graph_nodes(NodeT parent, scalar_view u, std::span<const real> nu,
                          scalar_span du) const
     {
         using rp_t = Kokkos::RangePolicy<execution_space>;
@@ -91,7 +159,8 @@ public:
         real* rx_ptr = du.Rx.data();
         real* ry_ptr = du.Ry.data();
         real* rz_ptr = du.Rz.data();
-        const int n_d = static_cast<int>(du.D.size());
+        const bool tiled = kernel_ == laplacian_kernel::tiled;
+        const int n_d = tiled ? 0 : static_cast<int>(du.D.size());
         const int n_rx = static_cast<int>(du.Rx.size());
         const int n_ry = static_cast<int>(du.Ry.size());
         const int n_rz = static_cast<int>(du.Rz.size());
@@ -110,11 +179,32 @@ public:
             KOKKOS_LAMBDA(int i) { rz_ptr[i] = 0; });
 
         auto zeroed = Kokkos::Experimental::when_all(z_d, z_rx, z_ry, z_rz);
+        auto blocks = tiles.graph_node(zeroed, u.D.data(), d_ptr, tiled);
 
         // Chain derivatives sequentially with Neumann
-        auto d0 = dx.add_graph_nodes(zeroed, u, nu, du, plus_eq);
-        auto d1 = dy.add_graph_nodes(d0, u, nu, du, plus_eq);
-        return dz.add_graph_nodes(d1, u, nu, du, plus_eq);
+        auto d0 = dx.add_graph_nodes(blocks, u, nu, du, plus_eq, !tiled);
+        auto d1 = dy.add_graph_nodes(d0, u, nu, du, plus_eq, !tiled);
+        return dz.add_graph_nodes(d1, u, nu, du, plus_eq, !tiled);
+    }
+
+    // Graph form of laplacian_kernel::fused: one tiled node writing du.D and one node
+    // writing du.Rx, du.Ry and du.Rz, both children of parent.  Requires
+    // kernel() == laplacian_kernel::fused.  Returns a when_all of the two.
+    template <typename NodeT>
+    auto add_fused_graph_nodes(NodeT parent, scalar_view u, scalar_span du) const
+    {
+        return fused_nodes(
+            parent, u, du, corr_D, {u.Rx.data(), u.Ry.data(), u.Rz.data()});
+    }
+
+    template <typename NodeT>
+    auto add_fused_graph_nodes(NodeT parent,
+                               scalar_view u,
+                               std::span<const real> nu,
+                               scalar_span du) const
+    {
+        return fused_nodes(
+            parent, u, du, corr_DN, {u.Rx.data(), u.Ry.data(), u.Rz.data(), nu.data()});
     }
 };
 } // namespace ccs
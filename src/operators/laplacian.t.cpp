@@ -11,9 +11,13 @@
 #include "fields/scalar.hpp"
 #include "fields/selection_desc.hpp"
 #include "identity_stencil.hpp"
+#include "mms/gauss.hpp"
+#include "mms/manufactured_solutions.hpp"
 #include "random/random.hpp"
 #include "stencils/stencil.hpp"
 
+#include <cmath>
+#include <limits>
 #include <ranges>
 
 #include <Kokkos_Core.hpp>
@@ -127,6 +131,17 @@ owned_scalar eval_at_mesh(const mesh& m, auto va)
     return result;
 }
 
+// The values of nu.D at the points of the Neumann faces of grid_bcs
+std::vector<real>
+on_faces(const mesh& m, const bcs::Grid& grid_bcs, const owned_scalar& nu)
+{
+    const auto faces = neumann_faces{m.extents(), grid_bcs};
+    std::vector<real> v(faces.size());
+    for (integer s = 0; s < faces.size(); ++s)
+        v[s] = nu.d_vec[m.extents()(faces.point(s).second)];
+    return v;
+}
+
 void add_offset(owned_scalar& s, real val)
 {
     for (auto& v : s.d_vec) v += val;
@@ -249,7 +264,7 @@ TEST_CASE("E2_2 Domain")
         zero_grid_dirichlet(m, gridBcs, ex);
 
         // neumann
-        auto nu = eval_at_mesh(m, f2_dz);
+        const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dz));
 
         auto du = make_scalar(m);
         REQUIRE((integer)du.d_vec.size() == m.size());
@@ -293,7 +308,7 @@ TEST_CASE("laplacian graph matches eager")
     SECTION("Neumann DDFFND")
     {
         const auto gridBcs = bcs::Grid{bcs::dd, bcs::ff, bcs::nd};
-        auto nu = eval_at_mesh(m, f2_dz);
+        const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dz));
 
         auto lap = laplacian{m, stencils::second::E2, gridBcs, objectBcs};
 
@@ -397,7 +412,7 @@ TEST_CASE("E2 with Dirichlet Objects")
     zero_grid_dirichlet(m, gridBcs, ex);
 
     // neumann conditions
-    auto nu = eval_at_mesh(m, f2_dy);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dy));
 
     auto du = make_scalar(m);
 
@@ -471,7 +486,7 @@ TEST_CASE("E2 with Floating Objects")
     zero_dirichlet(m, gridBcs, objectBcs, ex);
 
     // neumann conditions
-    auto nu = eval_at_mesh(m, f2_dy);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dy));
 
     auto du = make_scalar(m);
 
@@ -548,7 +563,7 @@ TEST_CASE("2D E2 with Floating Objects")
     zero_dirichlet(m, gridBcs, objectBcs, ex);
 
     // neumann conditions
-    auto nu = eval_at_mesh(m, g2_dy);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, g2_dy));
 
     auto du = make_scalar(m);
 
@@ -563,3 +578,247 @@ TEST_CASE("2D E2 with Floating Objects")
     REQUIRE_THAT(ex.rx_vec, Approx(du.rx_vec));
     REQUIRE_THAT(ex.ry_vec, Approx(du.ry_vec));
 }
+
+TEST_CASE("tiled kernel matches sweep")
+{
+    const auto extents = int3{25, 26, 27};
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.45, 1.011, 1.31}, 0.25)}};
+
+    const auto gridBcs = bcs::Grid{bcs::dn, bcs::nn, bcs::fd};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto& st = stencils::second::E2;
+
+    auto u = eval_at_mesh(m, f2);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dy));
+
+    auto lap = laplacian{m, st, gridBcs, objectBcs};
+
+    auto expected = make_scalar(m);
+    {
+        scalar_span sp = expected;
+        sp = lap(u, nu);
+    }
+    auto expected_no_nu = make_scalar(m);
+    {
+        scalar_span sp = expected_no_nu;
+        sp = lap(u);
+    }
+
+    auto require_same = [](const owned_scalar& a, const owned_scalar& b) {
+        REQUIRE_THAT(a.d_vec, Approx(b.d_vec));
+        REQUIRE_THAT(a.rx_vec, Approx(b.rx_vec));
+        REQUIRE_THAT(a.ry_vec, Approx(b.ry_vec));
+        REQUIRE_THAT(a.rz_vec, Approx(b.rz_vec));
+    };
+
+    // stale data in du must be overwritten without a separate zero pass
+    auto stale = [&m]() {
+        auto s = make_scalar(m);
+        add_offset(s, 7.0);
+        return s;
+    };
+
+    // default tiles, tiles that do not divide the extents, one tile, one point tiles
+    const std::vector<int3> tiles{{8, 8, 64}, {4, 5, 6}, {25, 26, 27}, {1, 1, 1}};
+    for (auto tile : tiles) {
+        lap.kernel(laplacian_kernel::tiled, tile);
+        REQUIRE(lap.kernel() == laplacian_kernel::tiled);
+
+        auto du = stale();
+        scalar_span du_sp = du;
+        du_sp = lap(u, nu);
+        require_same(du, expected);
+
+        auto du_no_nu = stale();
+        scalar_span du_no_nu_sp = du_no_nu;
+        du_no_nu_sp = lap(u);
+        require_same(du_no_nu, expected_no_nu);
+
+        auto du_graph = stale();
+        scalar_span du_graph_sp = du_graph;
+        lap.build_graph(u, nu, du_graph_sp);
+        lap.submit_graph();
+        require_same(du_graph, expected);
+
+        auto du_graph_no_nu = stale();
+        scalar_span du_graph_no_nu_sp = du_graph_no_nu;
+        lap.build_graph(u, du_graph_no_nu_sp);
+        lap.submit_graph();
+        require_same(du_graph_no_nu, expected_no_nu);
+    }
+
+    // switching back restores the sweep
+    lap.kernel(laplacian_kernel::sweep);
+    auto du = make_scalar(m);
+    scalar_span du_sp = du;
+    du_sp = lap(u, nu);
+    require_same(du, expected);
+}
+
+TEST_CASE("fused kernel matches sweep")
+{
+    const auto extents = int3{25, 26, 27};
+    auto m = mesh{index_extents{extents},
+                  domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                  std::vector<shape>{make_sphere(0, real3{0.45, 1.011, 1.31}, 0.25)}};
+
+    const auto gridBcs = bcs::Grid{bcs::dn, bcs::nn, bcs::fd};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto& st = stencils::second::E2;
+
+    auto u = eval_at_mesh(m, f2);
+    const auto nu = on_faces(m, gridBcs, eval_at_mesh(m, f2_dy));
+
+    auto lap = laplacian{m, st, gridBcs, objectBcs};
+
+    auto expected = make_scalar(m);
+    {
+        scalar_span sp = expected;
+        sp = lap(u, nu);
+    }
+    auto expected_no_nu = make_scalar(m);
+    {
+        scalar_span sp = expected_no_nu;
+        sp = lap(u);
+    }
+
+    auto require_same = [](const owned_scalar& a, const owned_scalar& b) {
+        REQUIRE_THAT(a.d_vec, Approx(b.d_vec));
+        REQUIRE_THAT(a.rx_vec, Approx(b.rx_vec));
+        REQUIRE_THAT(a.ry_vec, Approx(b.ry_vec));
+        REQUIRE_THAT(a.rz_vec, Approx(b.rz_vec));
+    };
+
+    // every entry of du, D and R, is assigned
+    auto stale = [&m]() {
+        auto s = make_scalar(m);
+        add_offset(s, 7.0);
+        return s;
+    };
+
+    const std::vector<int3> tiles{{8, 8, 64}, {4, 5, 6}, {1, 1, 1}};
+    for (auto tile : tiles) {
+        lap.kernel(laplacian_kernel::fused, tile);
+        REQUIRE(lap.kernel() == laplacian_kernel::fused);
+
+        auto du = stale();
+        scalar_span du_sp = du;
+        du_sp = lap(u, nu);
+        require_same(du, expected);
+
+        auto du_no_nu = stale();
+        scalar_span du_no_nu_sp = du_no_nu;
+        du_no_nu_sp = lap(u);
+        require_same(du_no_nu, expected_no_nu);
+
+        auto du_graph = stale();
+        scalar_span du_graph_sp = du_graph;
+        lap.build_graph(u, nu, du_graph_sp);
+        lap.submit_graph();
+        require_same(du_graph, expected);
+
+        auto du_graph_no_nu = stale();
+        scalar_span du_graph_no_nu_sp = du_graph_no_nu;
+        lap.build_graph(u, du_graph_no_nu_sp);
+        lap.submit_graph();
+        require_same(du_graph_no_nu, expected_no_nu);
+    }
+
+    // a 2D mesh has no z derivative
+    auto m2 = mesh{index_extents{int3{25, 26, 1}},
+                   domain_extents{.min = {0.1, 0.2, 0}, .max = {1, 2, 0}},
+                   std::vector<shape>{make_sphere(0, real3{0.45, 1.011, 0}, 0.25)}};
+    auto u2 = eval_at_mesh(m2, f2);
+    auto lap2 = laplacian{m2, st, bcs::Grid{bcs::dd, bcs::dd, bcs::dd}, objectBcs};
+    auto expected2 = make_scalar(m2);
+    {
+        scalar_span sp = expected2;
+        sp = lap2(u2);
+    }
+    lap2.kernel(laplacian_kernel::fused, {4, 4, 1});
+    auto du2 = make_scalar(m2);
+    add_offset(du2, 7.0);
+    scalar_span du2_sp = du2;
+    lap2.build_graph(u2, du2_sp);
+    lap2.submit_graph();
+    require_same(du2, expected2);
+}
+
+// Accuracy harness for fp32 coefficient storage: the MMS convergence check of the E2
+// and E4 laplacians on a gaussian, repeated with fp32 coefficients.  Rounding the
+// coefficients perturbs each row by about eps_f * |u| * sum|c|, which grows like
+// 1 / h^2 while the truncation error shrinks, so fp32 storage is safe while the fp64
+// error stays well above that floor.  The table printed here shows where that holds.
+TEST_CASE("fp32 coefficient accuracy")
+{
+    const real3 center{0.5, 0.45, 0.55};
+    const real3 variance{0.2, 0.25, 0.3};
+    const real amplitude = 1.0, frequency = 0.0;
+    const auto ms = build_ms_gauss3d(
+        std::span{&center, 1}, std::span{&variance, 1}, {&amplitude, 1}, {&frequency, 1});
+
+    const auto gridBcs = bcs::Grid{bcs::ff, bcs::ff, bcs::ff};
+    const auto objectBcs = bcs::Object{};
+    constexpr real eps_f = std::numeric_limits<float>::epsilon();
+
+    struct scheme {
+        const char* name;
+        const stencil& st;
+    };
+    const scheme schemes[] = {{"E2", stencils::second::E2}, {"E4", stencils::second::E4}};
+
+    for (auto&& [name, st] : schemes) {
+        real prev = 0.0;
+        for (int n : {11, 21, 41}) {
+            auto m = mesh{index_extents{int3{n, n, n}},
+                          domain_extents{.min = {0, 0, 0}, .max = {1, 1, 1}}};
+            auto at = [&ms](auto f) {
+                return std::views::transform([&ms, f](auto&& loc) {
+                    auto&& [x, y, z] = loc;
+                    return f(ms, real3{x, y, z});
+                });
+            };
+            auto u = eval_at_mesh(m, at([](auto& s, const real3& l) { return s(0, l); }));
+            auto ex = eval_at_mesh(
+                m, at([](auto& s, const real3& l) { return s.laplacian(0, l); }));
+
+            auto lap = laplacian{m, st, gridBcs, objectBcs};
+            auto max_error = [&]() {
+                auto du = make_scalar(m);
+                scalar_span du_sp = du;
+                du_sp = lap(u);
+                // interior points only: the one-sided closures converge more slowly
+                // and would hide the interior scheme's error
+                real e = 0;
+                for (int i = 4; i < n - 4; ++i)
+                    for (int j = 4; j < n - 4; ++j)
+                        for (int k = 4; k < n - 4; ++k) {
+                            const auto ic = (i * n + j) * n + k;
+                            e = std::max(e, std::abs(du.d_vec[ic] - ex.d_vec[ic]));
+                        }
+                return e;
+            };
+
+            const real e64 = max_error();
+            lap.precision(matrix::storage_precision::fp32);
+            const real e32 = max_error();
+
+            // |u| <= 1 and each direction's coefficients sum to about 4 / h^2 in
+            // magnitude
+            const real h = 1.0 / (n - 1);
+            const real floor = eps_f * 3 * 4 / (h * h);
+            CAPTURE(name, n, e64, e32, floor);
+
+            // the fp64 error converges under refinement
+            if (prev > 0) REQUIRE(e64 < prev);
+            prev = e64;
+
+            // fp32 coefficients never do better than the rounding floor allows, and
+            // match fp64 wherever the truncation error dominates that floor
+            REQUIRE(std::abs(e32 - e64) <= floor);
+            if (e64 > 100 * floor) REQUIRE(std::abs(e32 - e64) <= 0.01 * e64);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "types.hpp"
+
+#include "boundaries.hpp"
+#include "index_extents.hpp"
+
+#include <array>
+#include <utility>
+
+namespace ccs
+{
+
+// Compact layout of Neumann boundary data: one plane of values for every grid face
+// with a Neumann condition, in the order x min, x max, y min, y max, z min, z max.  A
+// face holds the derivative normal to it, so a point on an edge where two Neumann
+// faces meet has a slot in each.  Within a face the points keep the mesh ordering of
+// the two remaining indices.  The N matrices of derivative read this layout.
+class neumann_faces
+{
+    int3 ext{};
+    // offsets[2 * dir + side] is the first slot of a face and offsets[6] the total
+    std::array<integer, 7> offsets{};
+
+    // the indices spanning the faces normal to dir, slowest first
+    static constexpr std::pair<int, int> plane(int dir)
+    {
+        return {dir == 0 ? 1 : 0, dir == 2 ? 1 : 2};
+    }
+
+public:
+    neumann_faces() = default;
+
+    neumann_faces(const index_extents& extents, const bcs::Grid& grid_bcs)
+        : ext{extents.extents}
+    {
+        for (int dir = 0; dir < 3; ++dir) {
+            const auto [a, b] = plane(dir);
+            const integer n = (integer)ext[a] * ext[b];
+            const auto [left, right] = grid_bcs[dir];
+            offsets[2 * dir + 1] = offsets[2 * dir] + (left == bcs::Neumann ? n : 0);
+            offsets[2 * dir + 2] = offsets[2 * dir + 1] + (right == bcs::Neumann ? n : 0);
+        }
+    }
+
+    integer size() const { return offsets[6]; }
+
+    // first slot and number of slots of a face.  side is 0 for the min face and 1 for
+    // the max face.
+    integer offset(int dir, int side) const { return offsets[2 * dir + side]; }
+    integer size(int dir, int side) const
+    {
+        return offsets[2 * dir + side + 1] - offsets[2 * dir + side];
+    }
+
+    // slot of mesh point ijk on a face
+    integer slot(int dir, int side, const int3& ijk) const
+    {
+        const auto [a, b] = plane(dir);
+        return offset(dir, side) + (integer)ijk[a] * ext[b] + ijk[b];
+    }
+
+    // the direction of the face holding a slot and its mesh point
+    std::pair<int, int3> point(integer s) const
+    {
+        int f = 0;
+        while (s >= offsets[f + 1]) ++f;
+        const int dir = f / 2;
+        const auto [a, b] = plane(dir);
+        const integer k = s - offsets[f];
+
+        int3 ijk{};
+        ijk[dir] = f % 2 ? ext[dir] - 1 : 0;
+        ijk[a] = static_cast<int>(k / ext[b]);
+        ijk[b] = static_cast<int>(k % ext[b]);
+        return {dir, ijk};
+    }
+};
+
+} // namespace ccs
@@ -0,0 +1,211 @@
+#include "operator_cache.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <utility>
+
+#include <fmt/core.h>
+
+namespace ccs
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+// Written at the start of every entry.  Bump the version whenever the layout of an
+// entry changes.
+constexpr std::uint64_t magic = 0x31706f63636f6873; // "shoccop1"
+constexpr std::uint32_t version = 2;
+
+// The stencil is fingerprinted at the cut-cell distances of `m`: every distinct
+// (psi, ray_outside) of its intersections plus the grid boundaries at psi = 1.  The
+// interpolation coefficients use the signed offsets y = +-psi of the same points.
+void add_stencil(cache_key& k, const mesh& m, const stencil& st,
+                 const bcs::Grid& grid_bcs, const bcs::Object& obj_bcs)
+{
+    auto [p, rmax, tmax, ex_max] = st.query_max();
+    k.add(p);
+    k.add(rmax);
+    k.add(tmax);
+    k.add(ex_max);
+
+    std::vector<real> c(rmax * tmax);
+    std::vector<real> ex(ex_max);
+    auto add_coefficients = [&](std::span<const real> v) {
+        k.add(v);
+        k.add(std::span<const real>{ex});
+    };
+
+    std::vector<real> interior(2 * p + 1);
+    k.add(st.interior(1.0, interior));
+
+    // Boundary closures of every condition in use.  Conditions a stencil does not
+    // support may return the buffer untouched, hence the zero fill.
+    std::vector<bcs::type> types;
+    for (auto&& l : grid_bcs) types.insert(types.end(), {l.left, l.right});
+    types.insert(types.end(), obj_bcs.begin(), obj_bcs.end());
+    std::ranges::sort(types);
+    const auto [first, last] = std::ranges::unique(types);
+    types.erase(first, last);
+
+    std::vector<std::pair<real, bool>> walls{{1.0, false}, {1.0, true}};
+    for (int r = 0; r < 3; ++r)
+        for (const auto& info : m.R(r)) walls.emplace_back(info.psi, info.ray_outside);
+    std::ranges::sort(walls);
+    const auto [wfirst, wlast] = std::ranges::unique(walls);
+    walls.erase(wfirst, wlast);
+
+    for (auto b : types) {
+        auto [bp, br, bt, bx] = st.query(b);
+        k.add(b);
+        k.add(bp);
+        k.add(br);
+        k.add(bt);
+        k.add(bx);
+        for (auto [psi, right] : walls) {
+            std::ranges::fill(c, 0.0);
+            std::ranges::fill(ex, 0.0);
+            add_coefficients(st.nbs(1.0, b, psi, right, c, ex));
+        }
+    }
+
+    auto [ip, it] = st.query_interp();
+    k.add(ip);
+    k.add(it);
+    if (it == 0) return;
+
+    std::vector<real> ic(tmax + it);
+    for (auto [psi, right] : walls) {
+        const real y = right ? psi : -psi;
+        std::ranges::fill(ic, 0.0);
+        k.add(st.interp_interior(y, ic));
+        std::ranges::fill(ic, 0.0);
+        k.add(st.interp_wall(0, y, psi, ic, right));
+    }
+}
+} // namespace
+
+void cache_key::add_bytes(const void* p, std::size_t n)
+{
+    const auto* b = static_cast<const unsigned char*>(p);
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= b[i];
+        h *= 0x100000001b3;
+    }
+}
+
+cache_writer::cache_writer(const std::string& path) : out(path, std::ios::binary) {}
+
+cache_reader::cache_reader(const std::string& path)
+    : in(path, std::ios::binary | std::ios::ate)
+{
+    if (in) {
+        remaining = static_cast<std::uint64_t>(in.tellg());
+        in.seekg(0);
+    }
+}
+
+bool cache_reader::read_bytes(void* p, std::uint64_t n)
+{
+    if (n > remaining) return false;
+    in.read(static_cast<char*>(p), n);
+    remaining -= n;
+    return static_cast<bool>(in);
+}
+
+bool cache_reader::read(std::string& s)
+{
+    std::vector<char> v;
+    if (!read(v)) return false;
+    s.assign(v.begin(), v.end());
+    return true;
+}
+
+operator_cache::operator_cache(std::string dir) : dir_{MOVE(dir)} {}
+
+cache_key operator_cache::key(const mesh& m,
+                              const stencil& st,
+                              const bcs::Grid& grid_bcs,
+                              const bcs::Object& obj_bcs)
+{
+    cache_key k;
+    k.add(m.extents().extents);
+    k.add(m.x());
+    k.add(m.y());
+    k.add(m.z());
+
+    for (int r = 0; r < 3; ++r) {
+        const auto R = m.R(r);
+        k.add(static_cast<integer>(R.size()));
+        for (const auto& info : R) {
+            k.add(info.psi);
+            k.add(info.position);
+            k.add(info.normal);
+            k.add(info.ray_outside);
+            k.add(info.solid_coord);
+            k.add(info.shape_id);
+        }
+    }
+
+    for (auto&& l : grid_bcs) {
+        k.add(l.left);
+        k.add(l.right);
+    }
+    k.add(std::span<const bcs::type>{obj_bcs});
+
+    add_stencil(k, m, st, grid_bcs, obj_bcs);
+    return k;
+}
+
+bool operator_cache::load(std::uint64_t key,
+                          const std::function<bool(cache_reader&)>& read) const
+{
+    if (dir_.empty()) return false;
+
+    cache_reader in{(fs::path{dir_} / fmt::format("{:016x}.bin", key)).string()};
+    if (!in) return false;
+
+    std::uint64_t m, k;
+    std::uint32_t v;
+    if (!in.read(m) || !in.read(v) || !in.read(k)) return false;
+    if (m != magic || v != version || k != key) return false;
+
+    return read(in) && in.done();
+}
+
+bool operator_cache::store(std::uint64_t key,
+                           const std::function<void(cache_writer&)>& write) const
+{
+    if (dir_.empty()) return false;
+
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) return false;
+
+    // write a uniquely named sibling and rename it over the entry so neither a
+    // concurrent reader nor a concurrent writer sees a partial file
+    const auto path = fs::path{dir_} / fmt::format("{:016x}.bin", key);
+    const auto tmp =
+        fs::path{dir_} / fmt::format("{:016x}.{:08x}.tmp", key, std::random_device{}());
+    {
+        cache_writer out{tmp.string()};
+        if (!out) return false;
+        out.write(magic);
+        out.write(version);
+        out.write(key);
+        write(out);
+        if (!out) {
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, path, ec);
+    if (!ec) return true;
+    fs::remove(tmp, ec);
+    return false;
+}
+
+} // namespace ccs
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "types.hpp"
+
+#include "boundaries.hpp"
+#include "mesh/mesh.hpp"
+#include "stencils/stencil.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ccs
+{
+
+// 64 bit FNV-1a hash of the inputs an assembled operator depends on.  Values are
+// hashed by their object representation, so structs with padding must be added member
+// by member.
+class cache_key
+{
+    std::uint64_t h = 0xcbf29ce484222325;
+
+public:
+    void add_bytes(const void* p, std::size_t n);
+
+    template <typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void add(T v)
+    {
+        add_bytes(&v, sizeof(T));
+    }
+
+    template <typename T, std::size_t N>
+    void add(const std::array<T, N>& a)
+    {
+        for (const auto& v : a) add(v);
+    }
+
+    template <typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void add(std::span<const T> s)
+    {
+        add(static_cast<integer>(s.size()));
+        add_bytes(s.data(), s.size_bytes());
+    }
+
+    std::uint64_t value() const { return h; }
+};
+
+// Sequential binary output of one cache entry
+class cache_writer
+{
+    std::ofstream out;
+
+public:
+    explicit cache_writer(const std::string& path);
+
+    explicit operator bool() const { return static_cast<bool>(out); }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void write(const T& v)
+    {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    // the size followed by the elements
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void write(std::span<const T> s)
+    {
+        write(static_cast<integer>(s.size()));
+        out.write(reinterpret_cast<const char*>(s.data()), s.size_bytes());
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void write(const std::vector<T>& v)
+    {
+        write(std::span<const T>{v});
+    }
+
+    void write(const std::string& s) { write(std::span{s.data(), s.size()}); }
+};
+
+// Sequential binary input of one cache entry.  Every read returns false once the entry
+// is exhausted or a size runs past its end, so a truncated file reads as a miss.
+class cache_reader
+{
+    std::ifstream in;
+    std::uint64_t remaining = 0;
+
+    bool read_bytes(void* p, std::uint64_t n);
+
+public:
+    explicit cache_reader(const std::string& path);
+
+    explicit operator bool() const { return static_cast<bool>(in); }
+
+    // true when the whole entry has been read
+    bool done() const { return remaining == 0; }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool read(T& v)
+    {
+        return read_bytes(&v, sizeof(T));
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool read(std::vector<T>& v)
+    {
+        integer n;
+        if (!read(n) || n < 0 || static_cast<std::uint64_t>(n) > remaining / sizeof(T))
+            return false;
+        v.resize(n);
+        return read_bytes(v.data(), n * sizeof(T));
+    }
+
+    bool read(std::string& s);
+};
+
+// A directory of assembled operators, one file per key.  Entries are written to a
+// sibling file and renamed into place, so concurrent runs sharing a directory never
+// read a partial entry, and an entry that fails to read is treated as missing.
+class operator_cache
+{
+    std::string dir_;
+
+public:
+    operator_cache() = default;
+
+    // Entries live in `dir`, which is created when the first entry is stored.
+    explicit operator_cache(std::string dir);
+
+    const std::string& dir() const { return dir_; }
+    explicit operator bool() const { return !dir_.empty(); }
+
+    // Everything an assembled derivative depends on apart from its direction: the
+    // mesh points, the cut-cell intersections (which stand in for the shapes), the
+    // boundary conditions and the stencil.  Stencils are type erased so they are
+    // identified by their coefficients at the distinct psi of the mesh's intersections
+    // (and the matching interpolation offsets).
+    static cache_key
+    key(const mesh&, const stencil&, const bcs::Grid&, const bcs::Object&);
+
+    // Call `read` on the entry stored under `key`.  Returns false if there is no such
+    // entry or `read` fails.
+    bool load(std::uint64_t key, const std::function<bool(cache_reader&)>& read) const;
+
+    // Store the output of `write` under `key`, replacing any existing entry.  Returns
+    // false if the entry could not be written.
+    bool store(std::uint64_t key, const std::function<void(cache_writer&)>& write) const;
+};
+
+} // namespace ccs
@@ -0,0 +1,182 @@
+#include "operator_cache.hpp"
+#include "derivative.hpp"
+
+#include "fields/scalar.hpp"
+#include "random/random.hpp"
+#include "stencils/stencil.hpp"
+
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+// Custom main: Kokkos must be initialized before parallel_for calls.
+int main(int argc, char* argv[])
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    return Catch::Session().run(argc, argv);
+}
+
+using namespace ccs;
+namespace fs = std::filesystem;
+
+namespace
+{
+struct owned_scalar {
+    std::vector<real> d_vec, rx_vec, ry_vec, rz_vec;
+
+    operator scalar_view() const { return {d_vec, rx_vec, ry_vec, rz_vec}; }
+    operator scalar_span() { return {d_vec, rx_vec, ry_vec, rz_vec}; }
+};
+
+owned_scalar make_scalar(const mesh& m)
+{
+    return {std::vector<real>(m.size()),
+            std::vector<real>(m.Rx().size()),
+            std::vector<real>(m.Ry().size()),
+            std::vector<real>(m.Rz().size())};
+}
+
+mesh make_mesh(real radius)
+{
+    return mesh{index_extents{int3{25, 26, 27}},
+                domain_extents{.min = {0.1, 0.2, 0.3}, .max = {1, 2, 2.2}},
+                std::vector<shape>{make_sphere(0, real3{0.45, 1.011, 1.31}, radius)}};
+}
+
+// the entries of a cache directory and their modification times
+std::map<fs::path, fs::file_time_type> entries(const fs::path& dir)
+{
+    std::map<fs::path, fs::file_time_type> e;
+    for (auto&& f : fs::directory_iterator(dir)) e[f.path()] = f.last_write_time();
+    return e;
+}
+} // namespace
+
+TEST_CASE("key")
+{
+    const auto m = make_mesh(0.25);
+    const auto gridBcs = bcs::Grid{bcs::nn, bcs::dd, bcs::ff};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto& st = stencils::second::E2;
+
+    const auto k = operator_cache::key(m, st, gridBcs, objectBcs).value();
+    REQUIRE(operator_cache::key(m, st, gridBcs, objectBcs).value() == k);
+    REQUIRE(operator_cache::key(make_mesh(0.25), st, gridBcs, objectBcs).value() == k);
+
+    REQUIRE(operator_cache::key(make_mesh(0.24), st, gridBcs, objectBcs).value() != k);
+    REQUIRE(operator_cache::key(m, stencils::second::E4, gridBcs, objectBcs).value() !=
+            k);
+    REQUIRE(operator_cache::key(m, st, bcs::Grid{bcs::dd, bcs::dd, bcs::ff}, objectBcs)
+                .value() != k);
+    REQUIRE(operator_cache::key(m, st, gridBcs, bcs::Object{bcs::Dirichlet}).value() !=
+            k);
+
+    // stencil parameters are part of the key
+    const std::vector<real> a{-1.47956280234494, 0.261900367793859};
+    const std::vector<real> b{-1.47956280234494, 0.261900367793860};
+    const auto fb = bcs::Grid{bcs::ff, bcs::ff, bcs::ff};
+    REQUIRE(operator_cache::key(m, stencils::make_E2_1(a), fb, objectBcs).value() ==
+            operator_cache::key(m, stencils::make_E2_1(a), fb, objectBcs).value());
+    REQUIRE(operator_cache::key(m, stencils::make_E2_1(a), fb, objectBcs).value() !=
+            operator_cache::key(m, stencils::make_E2_1(b), fb, objectBcs).value());
+}
+
+TEST_CASE("cached derivatives match assembly")
+{
+    const auto dir = fs::temp_directory_path() / "shoccs_operator_cache.t";
+    fs::remove_all(dir);
+    const auto cache = operator_cache{dir.string()};
+
+    const auto m = make_mesh(0.25);
+    const auto gridBcs = bcs::Grid{bcs::nn, bcs::dd, bcs::ff};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto& st = stencils::second::E2;
+
+    randomize();
+    auto u = make_scalar(m);
+    std::vector<real> nu(neumann_faces{m.extents(), gridBcs}.size());
+    for (auto* v : {&u.d_vec, &u.rx_vec, &u.ry_vec, &u.rz_vec, &nu})
+        std::ranges::generate(*v, [] { return pick(); });
+
+    auto same = [&](const derivative& d, const derivative& e) {
+        REQUIRE(d.sparse_size() > 0);
+        REQUIRE(e.sparse_size() == d.sparse_size());
+
+        auto du_d = make_scalar(m);
+        auto du_e = make_scalar(m);
+        d(u, nu, du_d);
+        e(u, nu, du_e);
+        REQUIRE(du_e.d_vec == du_d.d_vec);
+        REQUIRE(du_e.rx_vec == du_d.rx_vec);
+        REQUIRE(du_e.ry_vec == du_d.ry_vec);
+        REQUIRE(du_e.rz_vec == du_d.rz_vec);
+    };
+
+    const auto expected = derivative::xyz(m, st, gridBcs, objectBcs);
+
+    // a miss assembles and stores one entry per direction
+    const auto stored = derivative::xyz(m, st, gridBcs, objectBcs, {}, cache);
+    const auto e = entries(dir);
+    REQUIRE(e.size() == 3u);
+    for (int i = 0; i < 3; ++i) same(expected[i], stored[i]);
+
+    // a hit reads the entries without rewriting them, whether the directions are
+    // built together or one at a time
+    const auto loaded = derivative::xyz(m, st, gridBcs, objectBcs, {}, cache);
+    for (int i = 0; i < 3; ++i) {
+        same(expected[i], loaded[i]);
+        same(expected[i], derivative{i, m, st, gridBcs, objectBcs, {}, cache});
+    }
+    REQUIRE(entries(dir) == e);
+
+    // other inputs get their own entries
+    derivative::xyz(m, st, bcs::Grid{bcs::dd, bcs::dd, bcs::ff}, objectBcs, {}, cache);
+    REQUIRE(entries(dir).size() == 6u);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("damaged entries are misses")
+{
+    const auto dir = fs::temp_directory_path() / "shoccs_operator_cache_damaged.t";
+    fs::remove_all(dir);
+    const auto cache = operator_cache{dir.string()};
+
+    const auto m = make_mesh(0.25);
+    const auto gridBcs = bcs::Grid{bcs::ff, bcs::dd, bcs::nn};
+    const auto objectBcs = bcs::Object{bcs::Floating};
+    const auto& st = stencils::second::E2;
+
+    const auto d = derivative{0, m, st, gridBcs, objectBcs, {}, cache};
+    const auto e = entries(dir);
+    REQUIRE(e.size() == 1u);
+    const auto path = e.begin()->first;
+    const auto size = fs::file_size(path);
+
+    auto u = make_scalar(m);
+    std::ranges::generate(u.d_vec, [] { return pick(); });
+    std::ranges::generate(u.rx_vec, [] { return pick(); });
+    auto expected = make_scalar(m);
+    d(u, expected);
+
+    for (auto damaged : {size / 2, size + 8}) {
+        fs::resize_file(path, damaged);
+
+        const auto r = derivative{0, m, st, gridBcs, objectBcs, {}, cache};
+        auto du = make_scalar(m);
+        r(u, du);
+        REQUIRE(du.d_vec == expected.d_vec);
+        REQUIRE(du.rx_vec == expected.rx_vec);
+
+        // and are replaced
+        REQUIRE(fs::file_size(path) == size);
+    }
+
+    fs::remove_all(dir);
+}
@@ -6,8 +6,10 @@
 #include <Kokkos_Timer.hpp>
 #include <sol/sol.hpp>
 
+#include <array>
 #include <cassert>
 #include <iostream>
+#include <span>
 #include <string>
 
 using namespace std::string_literals;
@@ -19,12 +21,14 @@ simulation_cycle::simulation_cycle(system&& sys,
                                    step_controller&& controller,
                                    integrator&& integrate,
                                    field_io&& io,
-                                   bool enable_logging)
+                                   bool enable_logging,
+                                   arena_options arena)
     : sys{MOVE(sys)},
       controller{MOVE(controller)},
       integrate{MOVE(integrate)},
       io{MOVE(io)},
-      logger{enable_logging, "cycle"}
+      logger{enable_logging, "cycle"},
+      arena{arena}
 {
 }
 
@@ -33,32 +37,25 @@ real3 simulation_cycle::run()
     Kokkos::Profiling::ScopedRegion run_region("simulation_cycle::run");
     logger(spdlog::level::info, "begin time stepping");
 
-    // Registry-based field allocation (9.5a)
+    // Registry-based field allocation (9.5a).  Only the slots the integrator steps
+    // with are allocated, all from one arena first touched in parallel.  An in-place
+    // integrator writes the new solution over u0, so u1 is u0.  Without an accumulator
+    // rk_ref is the empty field_ref{} (slot -1), which such integrators never read.
     sim_registry reg;
     auto sz = sys.size();
-    int d_sz  = sz.d_size;
-    int rx_sz = sz.rx_size;
-    int ry_sz = sz.ry_size;
-    int rz_sz = sz.rz_size;
-
-    field_ref u0_ref{0}, u1_ref{1}, rk_ref{2}, srhs_ref{3};
-    for (int s = 0; s < sz.nscalars; ++s) {
-        u0_ref   = reg.allocate_scalar(0, s, d_sz, rx_sz, ry_sz, rz_sz);
-        u1_ref   = reg.allocate_scalar(1, s, d_sz, rx_sz, ry_sz, rz_sz);
-        rk_ref   = reg.allocate_scalar(2, s, d_sz, rx_sz, ry_sz, rz_sz);
-        srhs_ref = reg.allocate_scalar(3, s, d_sz, rx_sz, ry_sz, rz_sz);
-    }
-    for (int v = 0; v < sz.nvectors; ++v) {
-        u0_ref   = reg.allocate_vector(0, v, d_sz, rx_sz, ry_sz, rz_sz);
-        u1_ref   = reg.allocate_vector(1, v, d_sz, rx_sz, ry_sz, rz_sz);
-        rk_ref   = reg.allocate_vector(2, v, d_sz, rx_sz, ry_sz, rz_sz);
-        srhs_ref = reg.allocate_vector(3, v, d_sz, rx_sz, ry_sz, rz_sz);
-    }
-    // For zero-field systems (nscalars==0, nvectors==0), refs retain their
-    // initial {slot, 0, 0} state — slot_ops correctly no-op.
+    const auto needs = integrate.slots();
+    constexpr std::array slots{0, 1, 2, 3};
+    reg.allocate_arena(std::span{slots}.first(needs.count()), sz, arena);
+    int next = 1;
+    const field_ref u0_ref = reg.ref(0);
+    const field_ref u1_ref = needs.in_place ? u0_ref : reg.ref(next++);
+    const field_ref rk_ref = needs.accumulator ? reg.ref(next++) : field_ref{};
+    const field_ref srhs_ref = reg.ref(next++);
+    // For zero-field systems (nscalars==0, nvectors==0), the refs come back as
+    // {slot, 0, 0} — slot_ops correctly no-op.
     assert(u0_ref.n_scalars == sz.nscalars && u0_ref.n_vectors == sz.nvectors);
     sys.initialize(reg, u0_ref, controller);
-    reg.deep_copy_slot(u1_ref.slot, u0_ref.slot);
+    if (u1_ref.slot != u0_ref.slot) reg.deep_copy_slot(u1_ref.slot, u0_ref.slot);
 
     sys.update_boundary(reg, u0_ref, controller);
 
@@ -69,10 +66,12 @@ real3 simulation_cycle::run()
     // initial write
     sys.write(io, reg, u0_ref, controller, .0);
 
-    // Build RHS graph once for graph-capable systems (heat, scalar_wave).
-    // Uses u1_ref as the RHS input slot and srhs_ref as the RHS output slot,
-    // matching the rk4 integrator's convention.
-    sys.build_rhs_graph(reg, u1_ref, reg, srhs_ref);
+    // Build the RHS graphs once for graph-capable systems (heat, scalar_wave).  The
+    // integrators evaluate the rhs of u0 and of stages in u1 into srhs, and the two
+    // slots swap every step, so one graph per input buffer covers the whole run.
+    // In-place integrators only ever read u0.
+    sys.build_rhs_graph(reg, u0_ref, reg, srhs_ref);
+    if (u1_ref.slot != u0_ref.slot) sys.build_rhs_graph(reg, u1_ref, reg, srhs_ref);
 
     Kokkos::Timer cumulative_timer;
 
@@ -119,10 +118,9 @@ real3 simulation_cycle::run()
                *dt,
                stats.stats[0],
                step_wall_ms);
-        // Copy latest solution to u0 for next iteration.
-        // Uses deep_copy (not swap_slots) to preserve stable data pointers
-        // required by the pre-built RHS graph.
-        reg.deep_copy_slot(u0_ref.slot, u1_ref.slot);
+        // The latest solution becomes u0 for the next iteration.  Swapping moves
+        // no data; each rhs graph stays bound to its buffer whichever slot holds it.
+        if (u1_ref.slot != u0_ref.slot) reg.swap_slots(u0_ref.slot, u1_ref.slot);
     }
 
     logger(spdlog::level::info,
@@ -152,10 +150,13 @@ std::optional<simulation_cycle> simulation_cycle::from_lua(const sol::table& tbl
     auto it_opt = integrator::from_lua(tbl, l);
     auto st_opt = step_controller::from_lua(tbl, l);
     auto io_opt = field_io::from_lua(tbl, l);
+    // simulation.memory.huge_pages backs the field arena with transparent huge pages
+    auto huge_pages = tbl["memory"]["huge_pages"].get<std::optional<bool>>();
+    auto arena = arena_options{.huge_pages = huge_pages.value_or(false)};
 
     if (sys_opt && it_opt && st_opt && io_opt) {
         return simulation_cycle{
-            MOVE(*sys_opt), MOVE(*st_opt), MOVE(*it_opt), MOVE(*io_opt), l};
+            MOVE(*sys_opt), MOVE(*st_opt), MOVE(*it_opt), MOVE(*io_opt), l, arena};
     } else {
         return std::nullopt;
     }
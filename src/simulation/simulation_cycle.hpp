@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 
+#include "fields/field_registry.hpp"
 #include "io/field_io.hpp"
 #include "systems/system.hpp"
 #include "temporal/integrator.hpp"
@@ -18,6 +19,7 @@ class simulation_cycle
     integrator integrate;
     field_io io;
     logs logger;
+    arena_options arena;
 
 public:
     simulation_cycle() = default;
@@ -26,7 +28,8 @@ public:
                      step_controller&&,
                      integrator&&,
                      field_io&&,
-                     bool enable_logging = false);
+                     bool enable_logging = false,
+                     arena_options arena = {});
 
     static std::optional<simulation_cycle> from_lua(const sol::table&);
 
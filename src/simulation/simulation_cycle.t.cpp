@@ -2,11 +2,14 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_session.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
 #include <sol/sol.hpp>
 #include <spdlog/spdlog.h>
 
+#include <string>
+
 #include "simulation_builder.hpp"
 #include "systems/system.hpp"
 
@@ -174,3 +177,83 @@ TEST_CASE("cycle - 2D euler")
     // tolerance as the RK4 2D test.
     REQUIRE(res[1] < 0.05);
 }
+
+TEST_CASE("cycle - 2D low-storage rk")
+{
+    // the solution is advanced in place: three slots instead of rk4's four
+    const std::string type = GENERATE("lsrk3", "lsrk54");
+
+    sol::state lua;
+    lua.open_libraries(sol::lib::base, sol::lib::math);
+    lua["integrator_type"] = type;
+    lua.script(R"(
+        simulation = {
+            mesh = {
+                index_extents = {21, 22},
+                domain_bounds = {
+                    min = {1, 1.1},
+                    max = {3, 3.3}
+                }
+            },
+            domain_boundaries = {
+                xmin = "dirichlet",
+                ymin = "neumann",
+                ymax = "neumann",
+            },
+            shapes = {
+                {
+                    type = "sphere",
+                    center = {2.0001, 2.5656565},
+                    radius = 0.25,
+                    boundary_condition = "floating"
+                }
+            },
+            scheme = {
+                order = 2,
+                type = "E2"
+            },
+            system = {
+                type = "heat",
+                diffusivity = 1.0
+            },
+            integrator = {
+                type = integrator_type,
+            },
+            step_controller = {
+                max_step = 5,
+            },
+            manufactured_solution = {
+                type = "lua",
+                call = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return (time +
+                        x * x * y + y * y * x + 3 * x * y + x + y)
+                end,
+                ddt = function(time, loc)
+                    return 1.0
+                end,
+                grad = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return 2. * x * y + y * y + 3. * y + 1,
+                            x * x + 2. * y * x + 3. * x + 1,
+                            0
+                end,
+                lap = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return 2. * y + 2. * x
+                end,
+                div = function(time, loc)
+                    return 0.0
+                end
+            }
+        }
+    )");
+
+    auto cycle_opt = simulation_cycle::from_lua(lua["simulation"]);
+    REQUIRE(!!cycle_opt);
+
+    auto res = cycle_opt->run();
+    // Same final time and error bound as the RK4 2D test.
+    REQUIRE_THAT(res[0], Catch::Matchers::WithinAbs(0.0125, 1e-10));
+    REQUIRE(res[1] < 0.05);
+}
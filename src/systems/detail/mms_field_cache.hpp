@@ -0,0 +1,49 @@
+#pragma once
+
+#include "fields/scalar.hpp"
+#include "mesh/mesh.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace ccs::systems::detail
+{
+
+// The exact solution of a system at one time, over every mesh location.  stats, write
+// and initialize all compare against the exact solution at the current simulation
+// time, so holding on to the last evaluation saves a whole-mesh evaluation (and the
+// buffer allocations) for every caller after the first in a step.  The cached field is
+// only valid while the solution it was filled from stays the same.
+class mms_field_cache
+{
+    std::vector<real> d, rx, ry, rz;
+    std::optional<real> time_;
+
+public:
+    mms_field_cache() = default;
+
+    explicit mms_field_cache(const mesh& m)
+        : d(m.size()), rx(m.Rx().size()), ry(m.Ry().size()), rz(m.Rz().size())
+    {
+    }
+
+    // The field at `time`.  fill(scalar_span) is called to evaluate it unless the
+    // cache already holds that time.
+    template <typename Fill>
+    scalar_view at(real time, Fill&& fill)
+    {
+        if (time_ != time) {
+            time_.reset();
+            fill(scalar_span{d, rx, ry, rz});
+            time_ = time;
+        }
+        return {d, rx, ry, rz};
+    }
+
+    // the time of the cached field, if there is one
+    std::optional<real> time() const { return time_; }
+
+    void invalidate() { time_.reset(); }
+};
+
+} // namespace ccs::systems::detail
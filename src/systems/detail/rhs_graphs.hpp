@@ -0,0 +1,190 @@
+#pragma once
+
+#include "fields/scalar.hpp"
+#include "kokkos_types.hpp"
+
+#include <Kokkos_Graph.hpp>
+
+#include <array>
+#include <cassert>
+#include <optional>
+#include <span>
+
+namespace ccs::systems::detail
+{
+
+// How an rk stage combines the rhs du it just computed with the other registers.
+// With c the stage coefficients:
+//   first:   acc  = c[0] du,        out = base + c[1] du
+//   middle:  acc += c[0] du,        out = base + c[1] du
+//   last:                           out = base + acc + c[0] du
+enum class stage_kind { first, middle, last };
+
+// An rk stage update appended to an rhs graph so that a whole stage is one graph
+// submission.  The buffers are part of the graph's binding; the coefficients are not
+// and are read when the graph runs.
+struct stage_update {
+    scalar_span acc;
+    scalar_view base;
+    scalar_span out;
+    stage_kind kind = stage_kind::first;
+    std::array<real, 2> c{};
+};
+
+// Add one node per buffer after `parent` applying s to du, with the coefficients read
+// from `c` when the graph runs.
+template <typename NodeT>
+void add_stage_nodes(NodeT parent,
+                     scalar_view du,
+                     const stage_update& s,
+                     Kokkos::View<real*, memory_space> c)
+{
+    using rp_t = Kokkos::RangePolicy<execution_space>;
+    const auto kind = s.kind;
+
+    auto node = [&](const char* name,
+                    std::span<const real> r_buf,
+                    std::span<real> a_buf,
+                    std::span<const real> x_buf,
+                    std::span<real> o_buf) {
+        const real* r = r_buf.data();
+        real* a = a_buf.data();
+        const real* x = x_buf.data();
+        real* o = o_buf.data();
+        parent.then_parallel_for(
+            name, rp_t(0, static_cast<int>(o_buf.size())), KOKKOS_LAMBDA(int i) {
+                switch (kind) {
+                case stage_kind::first:
+                    a[i] = c(0) * r[i];
+                    o[i] = x[i] + c(1) * r[i];
+                    break;
+                case stage_kind::middle:
+                    a[i] += c(0) * r[i];
+                    o[i] = x[i] + c(1) * r[i];
+                    break;
+                case stage_kind::last:
+                    o[i] = x[i] + a[i] + c(0) * r[i];
+                    break;
+                }
+            });
+    };
+
+    node("rk_stage_D", du.D, s.acc.D, s.base.D, s.out.D);
+    node("rk_stage_Rx", du.Rx, s.acc.Rx, s.base.Rx, s.out.Rx);
+    node("rk_stage_Ry", du.Ry, s.acc.Ry, s.base.Ry, s.out.Ry);
+    node("rk_stage_Rz", du.Rz, s.acc.Rz, s.base.Rz, s.out.Rz);
+}
+
+// Instantiated rhs graphs, one per binding of the input and output buffers.  Graph
+// nodes capture raw data pointers, so a graph only ever reads and writes the buffers it
+// was built on.  Holding a graph for each of the two slots that take turns as the input
+// lets the time loop swap the slots of the old and new solution (ping-pong) rather
+// than copy one into the other.  A graph may end in a stage_update, which is part of
+// its binding; rk4 with fused stages needs three of those per input slot (first,
+// middle and last).  Past `capacity` bindings the oldest graph is dropped.
+class rhs_graphs
+{
+public:
+    using graph = Kokkos::Experimental::Graph<execution_space>;
+    static constexpr int capacity = 8;
+
+private:
+    // data pointers of u, du and the stage buffers, and the stage kind (-1 for none)
+    struct binding {
+        std::array<const real*, 20> ptrs{};
+        int kind = -1;
+        bool operator==(const binding&) const = default;
+    };
+
+    static binding bind(scalar_view u, scalar_span du, const stage_update* s)
+    {
+        binding b{{u.D.data(),
+                   u.Rx.data(),
+                   u.Ry.data(),
+                   u.Rz.data(),
+                   du.D.data(),
+                   du.Rx.data(),
+                   du.Ry.data(),
+                   du.Rz.data()}};
+        if (s) {
+            int i = 8;
+            for (auto p : {s->acc.D.data(), s->acc.Rx.data(), s->acc.Ry.data(),
+                           s->acc.Rz.data(), s->out.D.data(), s->out.Rx.data(),
+                           s->out.Ry.data(), s->out.Rz.data()})
+                b.ptrs[i++] = p;
+            for (auto p : {s->base.D.data(), s->base.Rx.data(), s->base.Ry.data(),
+                           s->base.Rz.data()})
+                b.ptrs[i++] = p;
+            b.kind = static_cast<int>(s->kind);
+        }
+        return b;
+    }
+
+    int index(const binding& b) const
+    {
+        for (int i = 0; i < capacity; ++i)
+            if (graphs[i] && bindings[i] == b) return i;
+        return -1;
+    }
+
+    std::array<binding, capacity> bindings{};
+    std::array<std::optional<graph>, capacity> graphs{};
+    // stage coefficients read by each graph's stage nodes
+    std::array<Kokkos::View<real*, memory_space>, capacity> coefs{};
+    int next = 0;
+
+public:
+    // the graph built for (u, du) and stage s, or nullptr
+    graph* find(scalar_view u, scalar_span du, const stage_update* s = nullptr)
+    {
+        const int i = index(bind(u, du, s));
+        return i < 0 ? nullptr : &*graphs[i];
+    }
+
+    // Create and instantiate the graph for (u, du) and stage s, replacing any graph
+    // already bound to them.  add_nodes(root, tail) adds the rhs nodes and passes a
+    // node that follows all of them to tail, which appends the stage nodes if there
+    // is a stage.
+    template <typename AddNodes>
+    graph& add(scalar_view u, scalar_span du, const stage_update* s, AddNodes&& add_nodes)
+    {
+        const auto b = bind(u, du, s);
+        int i = index(b);
+        if (i < 0) {
+            i = next;
+            next = (next + 1) % capacity;
+        }
+
+        bindings[i] = b;
+        coefs[i] = Kokkos::View<real*, memory_space>("rk_stage_coefficients", 2);
+        auto tail = [&, c = coefs[i]](auto done) {
+            if (s) add_stage_nodes(done, du, *s, c);
+        };
+        graphs[i] = Kokkos::Experimental::create_graph<execution_space>(
+            [&](auto root) { add_nodes(root, tail); });
+        graphs[i]->instantiate();
+        return *graphs[i];
+    }
+
+    // Set the stage coefficients of the graph for (u, du, s) and submit it.  The
+    // graph must have been added.
+    void submit(scalar_view u, scalar_span du, const stage_update* s = nullptr)
+    {
+        const int i = index(bind(u, du, s));
+        assert(i >= 0);
+        if (s) {
+            coefs[i](0) = s->c[0];
+            coefs[i](1) = s->c[1];
+        }
+        graphs[i]->submit();
+    }
+
+    int size() const
+    {
+        int n = 0;
+        for (auto&& g : graphs) n += g.has_value();
+        return n;
+    }
+};
+
+} // namespace ccs::systems::detail
@@ -4,9 +4,21 @@
 #include "fields/scalar.hpp"
 #include "fields/selection_desc.hpp"
 #include "io/field_io.hpp"
+#include "io/logging.hpp"
+#include "matrices/block_tuner.hpp"
 #include "mesh/mesh.hpp"
+#include "operators/neumann_faces.hpp"
+#include "operators/operator_cache.hpp"
 #include "temporal/step_controller.hpp"
 
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <sol/sol.hpp>
+
 namespace ccs::systems::detail
 {
 
@@ -72,6 +84,151 @@ inline void eval_at_locations(const mesh& m, auto&& func, scalar_span out,
     }
 }
 
+// Evaluate func(loc) at the D points selected by desc, storing the value for
+// desc.element(i) in out[i].  Boundary data needs only the O(N^2) selected points
+// rather than the whole mesh.  parallel as for eval_at_locations.
+template <typename Desc>
+void eval_at_selected(const mesh& m,
+                      auto&& func,
+                      const Desc& desc,
+                      std::span<real> out,
+                      bool parallel = true)
+{
+    const auto* xv = m.x().data();
+    const auto* yv = m.y().data();
+    const auto* zv = m.z().data();
+    const int ny = (int)m.y().size(), nz = (int)m.z().size();
+    auto* o = out.data();
+
+    auto eval = [=, &func](int i) {
+        const int idx = desc.element(i);
+        o[i] = func(real3{xv[idx / (ny * nz)], yv[(idx / nz) % ny], zv[idx % nz]});
+    };
+
+    if (parallel) {
+        Kokkos::parallel_for(Kokkos::RangePolicy<execution_space>(0, desc.count()), eval);
+        Kokkos::fence();
+    } else {
+        for (int i = 0; i < desc.count(); ++i) eval(i);
+    }
+}
+
+// The same for the points of an R space, with desc indexing R
+inline void eval_at_selected(std::span<const mesh_object_info> R,
+                             auto&& func,
+                             const gather_selection& desc,
+                             std::span<real> out,
+                             bool parallel = true)
+{
+    const auto* r = R.data();
+    auto* o = out.data();
+
+    auto eval = [=, &func](int i) { o[i] = func(r[desc.element(i)].position); };
+
+    if (parallel) {
+        Kokkos::parallel_for(Kokkos::RangePolicy<execution_space>(0, desc.count()), eval);
+        Kokkos::fence();
+    } else {
+        for (int i = 0; i < desc.count(); ++i) eval(i);
+    }
+}
+
+// Evaluate func(dir, loc) at every slot of `faces`, where dir is the direction normal
+// to the slot's face, storing results in out.  parallel as for eval_at_locations.
+inline void eval_on_faces(const mesh& m,
+                          const neumann_faces& faces,
+                          auto&& func,
+                          std::span<real> out,
+                          bool parallel = true)
+{
+    const auto* xv = m.x().data();
+    const auto* yv = m.y().data();
+    const auto* zv = m.z().data();
+    auto* o = out.data();
+
+    auto eval = [=, &func](integer s) {
+        const auto [dir, ijk] = faces.point(s);
+        o[s] = func(dir, real3{xv[ijk[0]], yv[ijk[1]], zv[ijk[2]]});
+    };
+
+    if (parallel) {
+        Kokkos::parallel_for(
+            Kokkos::RangePolicy<execution_space>(0, faces.size()), eval);
+        Kokkos::fence();
+    } else {
+        for (integer s = 0; s < faces.size(); ++s) eval(s);
+    }
+}
+
+// The most Dirichlet values a system sets at once: one Dirichlet grid plane or the
+// Dirichlet intersections of one R space.  Sizes the buffer update_boundary reuses.
+inline integer max_dirichlet_count(const mesh& m,
+                                   const bcs::Grid& grid_bcs,
+                                   const bcs::Object& object_bcs)
+{
+    integer n = 0;
+    for_each_grid_bc_desc<bcs::Dirichlet>(grid_bcs, m.extents(), [&](auto desc) {
+        n = std::max<integer>(n, desc.count());
+    });
+    for (int dir = 0; dir < 3; ++dir)
+        n = std::max<integer>(n, m.dirichlet_object_desc(dir, object_bcs).count());
+    return n;
+}
+
+// Tune the block matvecs of `op` (see derivative::tune) when simulation.tuning.cache
+// names a tuning cache file, then write any newly measured entries back to it.
+template <typename Op>
+void tune_from_lua(Op& op, const sol::table& tbl, const logs& logger)
+{
+    auto path = tbl["tuning"]["cache"].get<std::optional<std::string>>();
+    if (!path) return;
+
+    matrix::tuning_cache cache{*path};
+    op.tune(cache);
+    if (!cache.save())
+        logger(spdlog::level::warn, "unable to write tuning cache {}", *path);
+}
+
+// The operator cache in the directory named by simulation.operators.cache, or no cache
+// when it is not given.
+inline operator_cache operator_cache_from_lua(const sol::table& tbl)
+{
+    auto dir = tbl["operators"]["cache"].get<std::optional<std::string>>();
+    return dir ? operator_cache{*dir} : operator_cache{};
+}
+
+// Store the block coefficients of `op` in float when simulation.precision.coefficients
+// is "fp32" (see matrix::storage_precision).  "fp64" is the default.
+template <typename Op>
+void precision_from_lua(Op& op, const sol::table& tbl, const logs& logger)
+{
+    auto p = tbl["precision"]["coefficients"].get<std::optional<std::string>>();
+    if (!p || *p == "fp64") return;
+
+    if (*p == "fp32")
+        op.precision(matrix::storage_precision::fp32);
+    else
+        logger(spdlog::level::warn,
+               "unknown simulation.precision.coefficients '{}', using fp64",
+               *p);
+}
+
+// Warn that simulation.precision.coefficients and simulation.tuning.cache are set but
+// ignored by `user`, whose blocks keep fp64 coefficients and their default launch.
+inline void warn_unused_block_options(const sol::table& tbl,
+                                      const logs& logger,
+                                      std::string_view user)
+{
+    auto p = tbl["precision"]["coefficients"].get<std::optional<std::string>>();
+    if (p && *p != "fp64")
+        logger(spdlog::level::warn,
+               "simulation.precision.coefficients '{}' is not supported by {}, using fp64",
+               *p,
+               user);
+    if (tbl["tuning"]["cache"].get<std::optional<std::string>>())
+        logger(spdlog::level::warn, "simulation.tuning.cache is not used by {}", user);
+}
+
 // Compute Linf error, min/max, and per-component stats for a scalar field
 // against an exact solution. Used by both heat::stats() and scalar_wave::stats().
 inline system_stats compute_scalar_stats(const mesh& m,
@@ -183,7 +340,7 @@ inline system_stats compute_scalar_stats(const mesh& m,
 // Initialize a scalar field from an evaluated solution: zero D, assign fluid
 // indices from sol, copy R buffers. Used by heat::initialize() and
 // scalar_wave::initialize().
-inline void initialize_scalar_field(const mesh& m, scalar_span u, scalar_span sol)
+inline void initialize_scalar_field(const mesh& m, scalar_span u, scalar_view sol)
 {
     // Fill D with zeros via parallel_for
     real* u_D = u.D.data();
@@ -194,7 +351,8 @@ inline void initialize_scalar_field(const mesh& m, scalar_span u, scalar_span so
 
     // Copy sol at fluid indices
     const auto fd = m.fluid_desc();
-    assign_selected(u_D, fd, handle_expr{sol.D.data()});
+    // handle_expr only reads through its pointer
+    assign_selected(u_D, fd, handle_expr{const_cast<real*>(sol.D.data())});
 
     // Copy sol's R components to u's R components via parallel_for
     real* u_Rx = u.Rx.data();
@@ -3,9 +3,12 @@
 #include "fields/expr.hpp"
 #include "fields/selection_desc.hpp"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <limits>
 #include <numbers>
+#include <span>
+#include <string>
 
 #include <fmt/ranges.h>
 #include <sol/sol.hpp>
@@ -18,6 +21,28 @@ namespace ccs::systems
 {
 
 using detail::eval_at_locations;
+using detail::eval_at_selected;
+using detail::eval_on_faces;
+
+namespace
+{
+// Select the laplacian kernel from simulation.laplacian.kernel ("sweep", "tiled" or
+// "fused").  "sweep" is the default.
+void kernel_from_lua(laplacian& lap, const sol::table& tbl, const logs& logger)
+{
+    auto k = tbl["laplacian"]["kernel"].get<std::optional<std::string>>();
+    if (!k || *k == "sweep") return;
+
+    if (*k == "tiled")
+        lap.kernel(laplacian_kernel::tiled);
+    else if (*k == "fused")
+        lap.kernel(laplacian_kernel::fused);
+    else
+        logger(spdlog::level::warn,
+               "unknown simulation.laplacian.kernel '{}', using sweep",
+               *k);
+}
+} // namespace
 
 heat::heat(mesh&& m,
            bcs::Grid&& grid_bcs,
@@ -25,19 +50,22 @@ heat::heat(mesh&& m,
            manufactured_solution&& m_sol,
            stencil st,
            real diffusivity,
-           const logs& build_logger)
+           const logs& build_logger,
+           const operator_cache& cache)
     : m{MOVE(m)},
       grid_bcs{MOVE(grid_bcs)},
       object_bcs{MOVE(object_bcs)},
       m_sol{MOVE(m_sol)},
-      lap{this->m, st, this->grid_bcs, this->object_bcs, build_logger},
+      lap{this->m, st, this->grid_bcs, this->object_bcs, build_logger, cache},
       diffusivity{diffusivity},
-      neumann_d(this->m.size()), neumann_rx(this->m.Rx().size()),
-      neumann_ry(this->m.Ry().size()), neumann_rz(this->m.Rz().size()),
+      faces{this->m.extents(), this->grid_bcs},
+      neumann(faces.size()),
+      dirichlet(detail::max_dirichlet_count(this->m, this->grid_bcs, this->object_bcs)),
       src_d(this->m.size()), src_rx(this->m.Rx().size()),
       src_ry(this->m.Ry().size()), src_rz(this->m.Rz().size()),
       error_d(this->m.size()), error_rx(this->m.Rx().size()),
       error_ry(this->m.Ry().size()), error_rz(this->m.Rz().size()),
+      exact{this->m},
       logger{build_logger, "system", "system.csv"}
 {
     assert(!!(this->m_sol));
@@ -48,6 +76,36 @@ heat::heat(mesh&& m,
            "Linf,Ry_ic,Rz_Linf,Rz_ic,Wall_ms");
 
     logger.set_pattern("%Y-%m-%d %H:%M:%S.%f,%v");
+
+    // Tabulate the spatial factors of a separable solution so that fill_source only
+    // evaluates the time factors
+    sep_terms = this->m_sol.separable_terms();
+    if (sep_terms > 0) {
+        const std::array<integer, 4> n{this->m.size(),
+                                       (integer)this->m.Rx().size(),
+                                       (integer)this->m.Ry().size(),
+                                       (integer)this->m.Rz().size()};
+        const std::array tables{&sep_d, &sep_rx, &sep_ry, &sep_rz};
+        for (int b = 0; b < 4; ++b) tables[b]->resize(2 * sep_terms * n[b]);
+
+        // the j'th table of every buffer
+        auto table = [&](int j) {
+            return scalar_span{std::span{sep_d}.subspan(j * n[0], n[0]),
+                               std::span{sep_rx}.subspan(j * n[1], n[1]),
+                               std::span{sep_ry}.subspan(j * n[2], n[2]),
+                               std::span{sep_rz}.subspan(j * n[3], n[3])};
+        };
+
+        for (int k = 0; k < sep_terms; ++k) {
+            eval_at_locations(this->m, [&](const real3& loc) {
+                return this->m_sol.space_factor(k, loc);
+            }, table(2 * k), this->m_sol.is_thread_safe());
+            eval_at_locations(this->m, [&](const real3& loc) {
+                return this->m_sol.space_factor_laplacian(k, loc);
+            }, table(2 * k + 1), this->m_sol.is_thread_safe());
+        }
+        sep_coef.resize(2 * sep_terms);
+    }
 }
 
 
@@ -91,13 +149,24 @@ std::optional<heat> heat::from_lua(const sol::table& tbl, const logs& logger)
         auto ms_opt = manufactured_solution::from_lua(tbl, mesh_opt->dims(), logger);
         auto t = ms_opt ? MOVE(*ms_opt) : manufactured_solution{};
 
-        return heat{MOVE(*mesh_opt),
-                    MOVE(bc_opt->first),
-                    MOVE(bc_opt->second),
-                    MOVE(t),
-                    *st_opt,
-                    diff,
-                    logger};
+        auto sys = heat{MOVE(*mesh_opt),
+                        MOVE(bc_opt->first),
+                        MOVE(bc_opt->second),
+                        MOVE(t),
+                        *st_opt,
+                        diff,
+                        logger,
+                        detail::operator_cache_from_lua(tbl)};
+        kernel_from_lua(sys.lap, tbl, logger);
+        if (sys.lap.kernel() == laplacian_kernel::sweep) {
+            detail::precision_from_lua(sys.lap, tbl, logger);
+            detail::tune_from_lua(sys.lap, tbl, logger);
+        } else {
+            // tiled_blocks reads the fp64 coefficients with its own launch
+            detail::warn_unused_block_options(
+                tbl, logger, "the tiled and fused laplacian kernels");
+        }
+        return sys;
     }
 
     return std::nullopt;
@@ -110,10 +179,38 @@ system_size heat::size() const
 
 void heat::fill_source(real time)
 {
-    scalar_span src{src_d, src_rx, src_ry, src_rz};
-    eval_at_locations(m, [&](const real3& loc) {
-        return m_sol.ddt(time, loc) - diffusivity * m_sol.laplacian(time, loc);
-    }, src, m_sol.is_thread_safe());
+    if (sep_terms == 0) {
+        scalar_span src{src_d, src_rx, src_ry, src_rz};
+        eval_at_locations(m, [&](const real3& loc) {
+            return m_sol.ddt(time, loc) - diffusivity * m_sol.laplacian(time, loc);
+        }, src, m_sol.is_thread_safe());
+        return;
+    }
+
+    // source = sum_k f'_k(t) g_k - diffusivity f_k(t) lap g_k
+    for (int k = 0; k < sep_terms; ++k) {
+        sep_coef[2 * k] = m_sol.time_factor_ddt(k, time);
+        sep_coef[2 * k + 1] = -diffusivity * m_sol.time_factor(k, time);
+    }
+
+    const int nc = 2 * sep_terms;
+    const real* c = sep_coef.data();
+    auto combine = [=](std::vector<real>& src, const std::vector<real>& tables) {
+        real* s = src.data();
+        const real* t = tables.data();
+        const integer n = src.size();
+        Kokkos::parallel_for(
+            Kokkos::RangePolicy<execution_space>(0, (int)n), KOKKOS_LAMBDA(int i) {
+                real v = 0;
+                for (int j = 0; j < nc; ++j) v += c[j] * t[j * n + i];
+                s[i] = v;
+            });
+    };
+    combine(src_d, sep_d);
+    combine(src_rx, sep_rx);
+    combine(src_ry, sep_ry);
+    combine(src_rz, sep_rz);
+    Kokkos::fence("heat::fill_source complete");
 }
 
 void heat::rhs(const sim_registry& reg, field_ref input,
@@ -125,7 +222,7 @@ void heat::rhs(const sim_registry& reg, field_ref input,
     auto u_rhs = extract_scalar_span(out_reg, output, sh);
 
     // rhs = diffusivity * lap(u) + (dS/dt - diffusivity * lap(S))
-    u_rhs = lap(u, scalar_view{neumann_d, neumann_rx, neumann_ry, neumann_rz});
+    u_rhs = lap(u, neumann);
     times_assign_scalar(out_reg, output, sh, diffusivity);
 
     if (m_sol) {
@@ -161,9 +258,13 @@ void heat::rhs(const sim_registry& reg, field_ref input,
     }
 }
 
-void heat::build_rhs_graph(scalar_view u, scalar_span du)
+void heat::build_rhs_graph(scalar_view u,
+                           scalar_span du,
+                           const detail::stage_update* stage)
 {
-    scalar_view nu{neumann_d, neumann_rx, neumann_ry, neumann_rz};
+    if (rhs_graphs_.find(u, du, stage)) return;
+
+    std::span<const real> nu{neumann};
     const real k = diffusivity;
 
     // Extract du pointers and sizes for graph node lambdas
@@ -210,13 +311,14 @@ void heat::build_rhs_graph(scalar_view u, scalar_span du)
 
     bool has_sol = !!m_sol;
 
-    rhs_graph_ = Kokkos::Experimental::create_graph<execution_space>(
-        [&](auto root) {
-            using rp_t = Kokkos::RangePolicy<execution_space>;
-
-            // 1. Laplacian: zeros du, then accumulates dx + dy + dz with Neumann
-            auto lap_done = lap.add_graph_nodes(root, u, nu, du);
+    rhs_graphs_.add(u, du, stage, [&](auto root, auto tail) {
+        using rp_t = Kokkos::RangePolicy<execution_space>;
 
+        // 1. Laplacian: zeros du, then accumulates dx + dy + dz with Neumann, or
+        // the two nodes of the fused kernel.  The rest of the graph is built by
+        // finish so it can follow either.  tail appends the stage update, if any,
+        // after the last node of every buffer.
+        auto finish = [&](auto lap_done) {
             // 2. Scale all 4 buffers by diffusivity
             auto s_d = lap_done.then_parallel_for(
                 "heat_scale_D", rp_t(0, n_d),
@@ -231,7 +333,10 @@ void heat::build_rhs_graph(scalar_view u, scalar_span du)
                 "heat_scale_Rz", rp_t(0, n_rz),
                 KOKKOS_LAMBDA(int i) { rz_ptr[i] *= k; });
 
-            if (!has_sol) return;
+            if (!has_sol) {
+                tail(Kokkos::Experimental::when_all(s_d, s_rx, s_ry, s_rz));
+                return;
+            }
 
             // 3. Source scatter: plus_assign at selected indices
             auto src_d_node = s_d.then_parallel_for(
@@ -259,37 +364,39 @@ void heat::build_rhs_graph(scalar_view u, scalar_span du)
                     rz_ptr[idx] += src_rz_ptr[idx];
                 });
 
-            // 4. BC fill: zero Dirichlet indices
+            // 4. BC fill: zero Dirichlet indices.  The nodes are added even when
+            // there are no such points, so the stage update can follow all four.
             // D: grid Dirichlet faces
-            if (dir_d.count() > 0) {
-                src_d_node.then_parallel_for(
-                    "heat_fill_dir_D", rp_t(0, dir_d.count()),
-                    KOKKOS_LAMBDA(int i) { d_ptr[dir_d.element(i)] = 0; });
-            }
+            auto f_d = src_d_node.then_parallel_for(
+                "heat_fill_dir_D", rp_t(0, dir_d.count()),
+                KOKKOS_LAMBDA(int i) { d_ptr[dir_d.element(i)] = 0; });
             // Rx/Ry/Rz: object Dirichlet
-            if (dir_rx.count() > 0) {
-                src_rx_node.then_parallel_for(
-                    "heat_fill_dir_Rx", rp_t(0, dir_rx.count()),
-                    KOKKOS_LAMBDA(int i) { rx_ptr[dir_rx.element(i)] = 0; });
-            }
-            if (dir_ry.count() > 0) {
-                src_ry_node.then_parallel_for(
-                    "heat_fill_dir_Ry", rp_t(0, dir_ry.count()),
-                    KOKKOS_LAMBDA(int i) { ry_ptr[dir_ry.element(i)] = 0; });
-            }
-            if (dir_rz.count() > 0) {
-                src_rz_node.then_parallel_for(
-                    "heat_fill_dir_Rz", rp_t(0, dir_rz.count()),
-                    KOKKOS_LAMBDA(int i) { rz_ptr[dir_rz.element(i)] = 0; });
-            }
-        });
+            auto f_rx = src_rx_node.then_parallel_for(
+                "heat_fill_dir_Rx", rp_t(0, dir_rx.count()),
+                KOKKOS_LAMBDA(int i) { rx_ptr[dir_rx.element(i)] = 0; });
+            auto f_ry = src_ry_node.then_parallel_for(
+                "heat_fill_dir_Ry", rp_t(0, dir_ry.count()),
+                KOKKOS_LAMBDA(int i) { ry_ptr[dir_ry.element(i)] = 0; });
+            auto f_rz = src_rz_node.then_parallel_for(
+                "heat_fill_dir_Rz", rp_t(0, dir_rz.count()),
+                KOKKOS_LAMBDA(int i) { rz_ptr[dir_rz.element(i)] = 0; });
+
+            tail(Kokkos::Experimental::when_all(f_d, f_rx, f_ry, f_rz));
+        };
 
-    rhs_graph_->instantiate();
+        if (lap.kernel() == laplacian_kernel::fused)
+            finish(lap.add_fused_graph_nodes(root, u, nu, du));
+        else
+            finish(lap.add_graph_nodes(root, u, nu, du));
+    });
 }
 
-void heat::submit_rhs_graph()
+void heat::submit_rhs_graph(scalar_view u,
+                            scalar_span du,
+                            const detail::stage_update* stage)
 {
-    rhs_graph_->submit();
+    build_rhs_graph(u, du, stage);
+    rhs_graphs_.submit(u, du, stage);
     Kokkos::fence("heat::submit_rhs_graph() complete");
 }
 
@@ -297,60 +404,30 @@ void heat::update_boundary(sim_registry& reg, field_ref ref, real time)
 {
     Kokkos::Profiling::ScopedRegion region("heat::update_boundary");
     constexpr auto sh = scalar_handle{0};
-    // Evaluate manufactured solution at all mesh locations
-    std::vector<real> sol_d(m.size());
-    std::vector<real> sol_rx(m.Rx().size());
-    std::vector<real> sol_ry(m.Ry().size());
-    std::vector<real> sol_rz(m.Rz().size());
-    scalar_span sol{sol_d, sol_rx, sol_ry, sol_rz};
-    eval_at_locations(m, [&](const real3& loc) {
-        return m_sol(time, loc);
-    }, sol, m_sol.is_thread_safe());
-
-    // Grid Dirichlet: assign plane subsets of D buffer
+    // Evaluate the manufactured solution at the Dirichlet points only
+    auto sol = [&](const real3& loc) { return m_sol(time, loc); };
+    const bool parallel = m_sol.is_thread_safe();
+    const auto vals = [&](integer n) { return std::span{dirichlet}.first(n); };
+
+    // Grid Dirichlet: plane subsets of D buffer
     real* u_D = reg.data(ref, sh.D());
     for_each_grid_bc_desc<bcs::Dirichlet>(grid_bcs, m.extents(), [&](auto desc) {
-        assign_selected(u_D, desc, handle_expr{sol.D.data()});
+        eval_at_selected(m, sol, desc, vals(desc.count()), parallel);
+        scatter_selected(u_D, desc, dirichlet.data());
     });
 
-    // Object Dirichlet: assign predicate subsets of Rx/Ry/Rz buffers
+    // Object Dirichlet: predicate subsets of Rx/Ry/Rz buffers
     auto R = sh.R();
-    real* sol_R[] = {sol.Rx.data(), sol.Ry.data(), sol.Rz.data()};
     for (int dir = 0; dir < 3; ++dir) {
         auto gd = m.dirichlet_object_desc(dir, object_bcs);
-        assign_selected(reg.data(ref, R[dir]), gd, handle_expr{sol_R[dir]});
+        eval_at_selected(m.R(dir), sol, gd, vals(gd.count()), parallel);
+        scatter_selected(reg.data(ref, R[dir]), gd, dirichlet.data());
     }
 
-    // Set Neumann BCs: evaluate gradient component at domain locations, assign at faces
-    scalar_span neu{neumann_d, neumann_rx, neumann_ry, neumann_rz};
-    auto ext = m.extents();
-    for (int dir = 0; dir < 3; ++dir) {
-        bool need_left = grid_bcs[dir].left == bcs::Neumann;
-        bool need_right = grid_bcs[dir].right == bcs::Neumann;
-        if (!need_left && !need_right) continue;
-
-        std::vector<real> grad_d(m.size());
-        std::vector<real> grad_rx(m.Rx().size());
-        std::vector<real> grad_ry(m.Ry().size());
-        std::vector<real> grad_rz(m.Rz().size());
-        scalar_span grad{grad_d, grad_rx, grad_ry, grad_rz};
-        eval_at_locations(m, [&](const real3& loc) {
-            return m_sol.gradient(time, loc)[dir];
-        }, grad, m_sol.is_thread_safe());
-        auto src = handle_expr{grad_d.data()};
-
-        auto assign_face = [&](int face_idx) {
-            if (dir == 0)
-                assign_selected(neu.D.data(), make_x_plane_desc(ext, face_idx), src);
-            else if (dir == 1)
-                assign_selected(neu.D.data(), make_y_plane_desc(ext, face_idx), src);
-            else
-                assign_selected(neu.D.data(), make_z_plane_desc(ext, face_idx), src);
-        };
-
-        if (need_left) assign_face(0);
-        if (need_right) assign_face(ext[dir] - 1);
-    }
+    // Set Neumann BCs: the gradient component normal to each face, at the face points
+    eval_on_faces(m, faces, [&](int dir, const real3& loc) {
+        return m_sol.gradient(time, loc)[dir];
+    }, neumann, m_sol.is_thread_safe());
 }
 
 real heat::timestep_size(const sim_registry&, field_ref,
@@ -360,6 +437,15 @@ real heat::timestep_size(const sim_registry&, field_ref,
     return step.parabolic_cfl() * h_min * h_min / (4 * diffusivity);
 }
 
+scalar_view heat::exact_at(real time) const
+{
+    return exact.at(time, [&](scalar_span sol) {
+        eval_at_locations(m, [&](const real3& loc) {
+            return m_sol(time, loc);
+        }, sol, m_sol.is_thread_safe());
+    });
+}
+
 system_stats heat::stats(const sim_registry& reg, field_ref /*u0*/,
                           field_ref u1, const step_controller& step) const
 {
@@ -367,18 +453,8 @@ system_stats heat::stats(const sim_registry& reg, field_ref /*u0*/,
     constexpr auto sh = scalar_handle{0};
     auto u = extract_scalar_view(reg, u1, sh);
 
-    // Evaluate manufactured solution at all mesh locations
-    std::vector<real> sol_d(m.size());
-    std::vector<real> sol_rx(m.Rx().size());
-    std::vector<real> sol_ry(m.Ry().size());
-    std::vector<real> sol_rz(m.Rz().size());
-    scalar_span sol{sol_d, sol_rx, sol_ry, sol_rz};
-    eval_at_locations(m, [&](const real3& loc) {
-        return m_sol(step.simulation_time(), loc);
-    }, sol, m_sol.is_thread_safe());
-
     return detail::compute_scalar_stats(m, object_bcs, u,
-        scalar_view{sol_d, sol_rx, sol_ry, sol_rz});
+                                        exact_at(step.simulation_time()));
 }
 
 void heat::initialize(sim_registry& reg, field_ref ref, const step_controller& c)
@@ -388,17 +464,7 @@ void heat::initialize(sim_registry& reg, field_ref ref, const step_controller& c
     constexpr auto sh = scalar_handle{0};
     auto u = extract_scalar_span(reg, ref, sh);
 
-    // Evaluate manufactured solution at all mesh locations
-    std::vector<real> sol_d(m.size());
-    std::vector<real> sol_rx(m.Rx().size());
-    std::vector<real> sol_ry(m.Ry().size());
-    std::vector<real> sol_rz(m.Rz().size());
-    scalar_span sol{sol_d, sol_rx, sol_ry, sol_rz};
-    eval_at_locations(m, [&](const real3& loc) {
-        return m_sol(c.simulation_time(), loc);
-    }, sol, m_sol.is_thread_safe());
-
-    detail::initialize_scalar_field(m, u, sol);
+    detail::initialize_scalar_field(m, u, exact_at(c.simulation_time()));
 }
 
 bool heat::write(field_io& io, const sim_registry& reg, field_ref ref,
@@ -407,19 +473,9 @@ bool heat::write(field_io& io, const sim_registry& reg, field_ref ref,
     constexpr auto sh = scalar_handle{0};
     auto u = extract_scalar_view(reg, ref, sh);
 
-    // Evaluate manufactured solution at all mesh locations
-    std::vector<real> sol_d(m.size());
-    std::vector<real> sol_rx(m.Rx().size());
-    std::vector<real> sol_ry(m.Ry().size());
-    std::vector<real> sol_rz(m.Rz().size());
-    scalar_span sol{sol_d, sol_rx, sol_ry, sol_rz};
-    eval_at_locations(m, [&](const real3& loc) {
-        return m_sol(c.simulation_time(), loc);
-    }, sol, m_sol.is_thread_safe());
-
     scalar_span error{error_d, error_rx, error_ry, error_rz};
     return detail::write_scalar_error(m, object_bcs, grid_bcs, u,
-        scalar_view{sol_d, sol_rx, sol_ry, sol_rz}, error,
+        exact_at(c.simulation_time()), error,
         io, io_names, c, dt);
 }
 
@@ -5,6 +5,8 @@
 #include "mesh/mesh.hpp"
 #include "mms/manufactured_solutions.hpp"
 #include "operators/laplacian.hpp"
+#include "systems/detail/mms_field_cache.hpp"
+#include "systems/detail/rhs_graphs.hpp"
 #include "temporal/step_controller.hpp"
 #include <Kokkos_Graph.hpp>
 #include <optional>
@@ -26,16 +28,31 @@ class heat
     laplacian lap;
     real diffusivity;
 
-    std::vector<real> neumann_d, neumann_rx, neumann_ry, neumann_rz;
+    // normal derivatives on the Neumann faces, laid out by `faces`
+    neumann_faces faces;
+    std::vector<real> neumann;
+    // Dirichlet values of one plane or R space at a time, see update_boundary
+    std::vector<real> dirichlet;
     std::vector<real> src_d, src_rx, src_ry, src_rz;
+    // When m_sol is separable: g_k and lap g_k of every term, tabulated once per buffer
+    // (term k at [2k n, 2k n + n) and [2k n + n, 2k n + 2n)), and the time factors that
+    // combine them into the source.  See fill_source.
+    int sep_terms = 0;
+    std::vector<real> sep_d, sep_rx, sep_ry, sep_rz;
+    std::vector<real> sep_coef;
     std::vector<real> error_d, error_rx, error_ry, error_rz;
+    // m_sol at the last time stats, write or initialize asked for
+    mutable detail::mms_field_cache exact;
 
     logs logger;
 
     std::vector<std::string> io_names = {"U", "Error"};
 
-    // Pre-built graph for submit_rhs_graph().
-    std::optional<Kokkos::Experimental::Graph<execution_space>> rhs_graph_;
+    // Pre-built graphs for submit_rhs_graph(), one per (u, du) binding
+    detail::rhs_graphs rhs_graphs_;
+
+    // m_sol at `time` on every mesh location, evaluated through `exact`
+    scalar_view exact_at(real time) const;
 
 public:
     heat() = default;
@@ -46,7 +63,8 @@ public:
          manufactured_solution&& m_sol,
          stencil st,
          real diffusivity,
-         const logs& = {});
+         const logs& = {},
+         const operator_cache& = {});
 
     static std::optional<heat> from_lua(const sol::table&, const logs& = {});
 
@@ -62,8 +80,13 @@ public:
 
     void rhs(const sim_registry& reg, field_ref input,
              sim_registry& out_reg, field_ref output, real time);
-    void build_rhs_graph(scalar_view u, scalar_span du);
-    void submit_rhs_graph();
+    // With a stage, the graph also applies that rk stage update once du is done.
+    void build_rhs_graph(scalar_view u,
+                         scalar_span du,
+                         const detail::stage_update* stage = nullptr);
+    void submit_rhs_graph(scalar_view u,
+                          scalar_span du,
+                          const detail::stage_update* stage = nullptr);
     void update_boundary(sim_registry& reg, field_ref ref, real time);
     real timestep_size(const sim_registry& reg, field_ref ref,
                        const step_controller&) const;
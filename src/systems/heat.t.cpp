@@ -1,5 +1,10 @@
 #include "system.hpp"
+#include "detail/mms_field_cache.hpp"
+#include "mesh/shapes.hpp"
+#include "mms/gauss.hpp"
+#include "stencils/stencil.hpp"
 
+#include "fields/expr.hpp"
 #include "fields/field_registry.hpp"
 
 #include <Kokkos_Core.hpp>
@@ -733,6 +738,331 @@ TEST_CASE("heat - eval_at_locations parallel path (gaussian MMS)")
 // Uses the E2 setup with Dirichlet + Neumann grid BCs and a Dirichlet object,
 // exercising all graph branches: laplacian, diffusivity scaling, source scatter,
 // and BC fill (both grid Dirichlet and object Dirichlet).
+// update_boundary evaluates the solution at the Dirichlet points only and must leave
+// every other point untouched.
+TEST_CASE("heat - update_boundary writes only Dirichlet points")
+{
+    sol::state lua;
+    lua.open_libraries(sol::lib::base, sol::lib::math);
+    lua.script(R"(
+        simulation = {
+            mesh = {
+                index_extents = {8, 9, 10},
+                domain_bounds = {
+                    min = {0.0, 0.0, 0.0},
+                    max = {1.0, 1.0, 1.0}
+                }
+            },
+            domain_boundaries = {
+                xmin = "dirichlet",
+                xmax = "dirichlet",
+                zmax = "dirichlet"
+            },
+            shapes = {
+                {
+                    type = "sphere",
+                    center = {0.5, 0.5, 0.5},
+                    radius = 0.25,
+                    boundary_condition = "dirichlet"
+                }
+            },
+            scheme = {
+                order = 2,
+                type = "E2"
+            },
+            system = {
+                type = "heat",
+                diffusivity = 1.0
+            },
+            manufactured_solution = {
+                type = "lua",
+                call = function(time, loc)
+                    return loc[1] + loc[2] + loc[3] + time
+                end,
+                ddt = function(time, loc)
+                    return 1.0
+                end,
+                grad = function(time, loc)
+                    return 1.0, 1.0, 1.0
+                end,
+                lap = function(time, loc)
+                    return 0.0
+                end,
+                div = function(time, loc)
+                    return 0.0
+                end
+            }
+        }
+    )");
+
+    auto sys_opt = system::from_lua(lua["simulation"]);
+    REQUIRE(!!sys_opt);
+    auto& sys = *sys_opt;
+
+    sim_registry reg;
+    auto [u0_ref, rhs_ref] = setup_registry(reg, sys);
+
+    constexpr auto sh = scalar_handle{0};
+    auto u = extract_scalar_span(reg, u0_ref, sh);
+    u = -1.0;
+
+    const real time = 0.5;
+    sys.update_boundary(reg, u0_ref, time);
+
+    constexpr int nx = 8, ny = 9, nz = 10;
+    constexpr real dx = 1.0 / (nx - 1);
+    constexpr real dy = 1.0 / (ny - 1);
+    constexpr real dz = 1.0 / (nz - 1);
+
+    for (int i = 0; i < nx; ++i)
+        for (int j = 0; j < ny; ++j)
+            for (int k = 0; k < nz; ++k) {
+                const int flat = i * ny * nz + j * nz + k;
+                const bool dirichlet = i == 0 || i == nx - 1 || k == nz - 1;
+                const real expected = dirichlet ? i * dx + j * dy + k * dz + time : -1.0;
+                INFO("D[" << i << "," << j << "," << k << "]");
+                REQUIRE(u.D[flat] == Catch::Approx(expected).epsilon(1e-12));
+            }
+
+    // every cut point is on the Dirichlet sphere
+    for (auto r : {u.Rx, u.Ry, u.Rz}) {
+        REQUIRE(!r.empty());
+        for (auto v : r) {
+            REQUIRE(v >= time);
+            REQUIRE(v <= 3 + time);
+        }
+    }
+}
+
+TEST_CASE("heat - mms field cache")
+{
+    const auto m = mesh{index_extents{int3{6, 7, 8}},
+                        domain_extents{.min = {0.0, 0.0, 0.0}, .max = {1.0, 1.0, 1.0}},
+                        std::vector<shape>{make_sphere(0, real3{0.5, 0.5, 0.5}, 0.3)}};
+    auto cache = systems::detail::mms_field_cache{m};
+    REQUIRE(!cache.time());
+
+    int fills = 0;
+    auto fill = [&](real time) {
+        return [&fills, time](scalar_span s) {
+            ++fills;
+            for (auto r : {s.D, s.Rx, s.Ry, s.Rz}) std::ranges::fill(r, time);
+        };
+    };
+
+    auto v = cache.at(1.0, fill(1.0));
+    REQUIRE(fills == 1);
+    REQUIRE(v.D.size() == (std::size_t)m.size());
+    REQUIRE(v.Rx.size() == m.Rx().size());
+    REQUIRE(v.Rz[0] == 1.0);
+
+    // the same time reuses the field
+    v = cache.at(1.0, fill(1.0));
+    REQUIRE(fills == 1);
+    REQUIRE(*cache.time() == 1.0);
+
+    v = cache.at(2.0, fill(2.0));
+    REQUIRE(fills == 2);
+    REQUIRE(v.D[0] == 2.0);
+
+    cache.invalidate();
+    v = cache.at(2.0, fill(2.0));
+    REQUIRE(fills == 3);
+}
+
+TEST_CASE("heat - stats, write and initialize share one evaluation")
+{
+    sol::state lua;
+    lua.open_libraries(sol::lib::base, sol::lib::math);
+    lua.script(R"(
+        calls = 0
+        simulation = {
+            mesh = {
+                index_extents = {8, 9, 10},
+                domain_bounds = {
+                    min = {0.0, 0.0, 0.0},
+                    max = {1.0, 1.0, 1.0}
+                }
+            },
+            domain_boundaries = {
+                xmin = "dirichlet"
+            },
+            shapes = {
+                {
+                    type = "sphere",
+                    center = {0.5, 0.5, 0.5},
+                    radius = 0.25,
+                    boundary_condition = "dirichlet"
+                }
+            },
+            scheme = {
+                order = 2,
+                type = "E2"
+            },
+            system = {
+                type = "heat",
+                diffusivity = 1.0
+            },
+            manufactured_solution = {
+                type = "lua",
+                call = function(time, loc)
+                    calls = calls + 1
+                    return loc[1] + loc[2] + loc[3] + time
+                end,
+                ddt = function(time, loc)
+                    return 1.0
+                end,
+                grad = function(time, loc)
+                    return 1.0, 1.0, 1.0
+                end,
+                lap = function(time, loc)
+                    return 0.0
+                end,
+                div = function(time, loc)
+                    return 0.0
+                end
+            }
+        }
+    )");
+
+    auto sys_opt = system::from_lua(lua["simulation"]);
+    REQUIRE(!!sys_opt);
+    auto& sys = *sys_opt;
+
+    sim_registry reg;
+    auto [u0_ref, rhs_ref] = setup_registry(reg, sys);
+
+    const auto sz = sys.size();
+    const int points = sz.d_size + sz.rx_size + sz.ry_size + sz.rz_size;
+
+    step_controller step{};
+    lua["calls"] = 0;
+    sys.initialize(reg, u0_ref, step);
+    REQUIRE(lua["calls"].get<int>() == points);
+
+    // stats at the same time compare against the field initialize evaluated
+    auto st = sys.stats(reg, u0_ref, u0_ref, step);
+    REQUIRE(lua["calls"].get<int>() == points);
+    REQUIRE(st.stats[0] == Catch::Approx(0.0).margin(1e-14));
+
+    // a new time is evaluated once
+    step.advance(0.25);
+    sys.stats(reg, u0_ref, u0_ref, step);
+    sys.stats(reg, u0_ref, u0_ref, step);
+    REQUIRE(lua["calls"].get<int>() == 2 * points);
+}
+
+// Forwards a solution without advertising its separable form
+struct opaque_solution {
+    manufactured_solution ms;
+
+    real operator()(real time, const real3& loc) const { return ms(time, loc); }
+    real ddt(real time, const real3& loc) const { return ms.ddt(time, loc); }
+    real3 gradient(real time, const real3& loc) const { return ms.gradient(time, loc); }
+    real divergence(real time, const real3& loc) const { return ms.divergence(time, loc); }
+    real laplacian(real time, const real3& loc) const { return ms.laplacian(time, loc); }
+};
+
+// A two-term gaussian solution and a heat system for it on a small cut-cell mesh
+static manufactured_solution gauss_solution()
+{
+    const std::vector<real3> center{{0.3, 0.4, 0.5}, {0.7, 0.6, 0.4}};
+    const std::vector<real3> variance{{0.3, 0.4, 0.5}, {0.2, 0.3, 0.25}};
+    const std::vector<real> amplitude{1.0, 0.5};
+    const std::vector<real> frequency{2.0, 3.0};
+    return build_ms_gauss3d(center, variance, amplitude, frequency);
+}
+
+static systems::heat make_gauss_heat(manufactured_solution ms)
+{
+    return systems::heat{
+        mesh{index_extents{int3{12, 13, 14}},
+             domain_extents{.min = {0.0, 0.0, 0.0}, .max = {1.0, 1.0, 1.0}},
+             std::vector<shape>{make_sphere(0, real3{0.5, 0.5, 0.5}, 0.25)}},
+        bcs::Grid{bcs::dd, bcs::nn, bcs::fn},
+        bcs::Object{bcs::Floating},
+        MOVE(ms),
+        stencils::second::E2,
+        0.3};
+}
+
+TEST_CASE("heat - separable source matches direct evaluation")
+{
+    const auto gauss = gauss_solution();
+    REQUIRE(gauss.separable_terms() == 2);
+    REQUIRE(manufactured_solution{opaque_solution{gauss}}.separable_terms() == 0);
+
+    auto sep = make_gauss_heat(gauss);
+    auto direct = make_gauss_heat(opaque_solution{gauss});
+
+    auto sz = sep.size();
+    sim_registry reg;
+    field_ref u0_ref{0}, sep_ref{1}, direct_ref{2};
+    u0_ref = reg.allocate_scalar(0, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    sep_ref = reg.allocate_scalar(1, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    direct_ref = reg.allocate_scalar(2, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    sep.initialize(reg, u0_ref, step_controller{});
+
+    constexpr auto sh = scalar_handle{0};
+    for (real time : {0.0, 0.7}) {
+        sep.update_boundary(reg, u0_ref, time);
+        direct.update_boundary(reg, u0_ref, time);
+        sep.rhs(reg, u0_ref, reg, sep_ref, time);
+        direct.rhs(reg, u0_ref, reg, direct_ref, time);
+
+        auto a = extract_scalar_view(reg, sep_ref, sh);
+        auto b = extract_scalar_view(reg, direct_ref, sh);
+        for (auto [x, y] : {std::pair{a.D, b.D}, {a.Rx, b.Rx}, {a.Ry, b.Ry}, {a.Rz, b.Rz}}) {
+            REQUIRE(x.size() == y.size());
+            for (std::size_t i = 0; i < x.size(); ++i)
+                REQUIRE(x[i] == Catch::Approx(y[i]).margin(1e-12));
+        }
+    }
+}
+
+TEST_CASE("heat - rhs graphs follow swapped slots")
+{
+    auto h = make_gauss_heat(gauss_solution());
+
+    auto sz = h.size();
+    sim_registry reg;
+    field_ref a{0}, b{1}, graph_ref{2}, eager_ref{3};
+    a = reg.allocate_scalar(0, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    b = reg.allocate_scalar(1, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    graph_ref = reg.allocate_scalar(2, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    eager_ref = reg.allocate_scalar(3, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+
+    // different fields in the two input slots
+    constexpr auto sh = scalar_handle{0};
+    h.initialize(reg, a, step_controller{});
+    h.initialize(reg, b, step_controller{});
+    times_assign_scalar(reg, b, sh, 0.5);
+
+    // one graph per input buffer, as simulation_cycle builds them
+    auto du = extract_scalar_span(reg, graph_ref, sh);
+    h.build_rhs_graph(extract_scalar_view(reg, a, sh), du);
+    h.build_rhs_graph(extract_scalar_view(reg, b, sh), du);
+
+    const real time = 0.4;
+    for (int swaps = 0; swaps < 3; ++swaps) {
+        for (auto ref : {a, b}) {
+            h.rhs(reg, ref, reg, eager_ref, time);
+            h.fill_source(time);
+            h.submit_rhs_graph(extract_scalar_view(reg, ref, sh), du);
+
+            auto eager = extract_scalar_view(reg, eager_ref, sh);
+            for (auto [x, y] : {std::pair{du.D, eager.D},
+                                {du.Rx, eager.Rx},
+                                {du.Ry, eager.Ry},
+                                {du.Rz, eager.Rz}}) {
+                for (std::size_t i = 0; i < x.size(); ++i)
+                    REQUIRE(x[i] == Catch::Approx(y[i]));
+            }
+        }
+        reg.swap_slots(a.slot, b.slot);
+    }
+}
+
 TEST_CASE("heat - graph matches eager")
 {
     sol::state lua;
@@ -832,7 +1162,7 @@ TEST_CASE("heat - graph matches eager")
 
     h.fill_source((real)step);
     h.build_rhs_graph(u, du);
-    h.submit_rhs_graph();
+    h.submit_rhs_graph(u, du);
 
     // Compare all 4 buffers
     for (int i = 0; i < sz.d_size; ++i) {
@@ -860,7 +1190,7 @@ TEST_CASE("heat - graph matches eager")
         std::ranges::fill(du.Rz, 0.0);
 
         h.fill_source((real)step);
-        h.submit_rhs_graph();
+        h.submit_rhs_graph(u, du);
 
         for (int i = 0; i < sz.d_size; ++i) {
             INFO("D[" << i << "] resubmit");
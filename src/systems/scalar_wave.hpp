@@ -2,7 +2,9 @@
 
 #include "fields/field_registry.hpp"
 #include "io/field_io.hpp"
-#include "operators/gradient.hpp"
+#include "operators/advection.hpp"
+#include "systems/detail/mms_field_cache.hpp"
+#include "systems/detail/rhs_graphs.hpp"
 #include "temporal/step_controller.hpp"
 #include "types.hpp"
 
@@ -20,29 +22,28 @@ class scalar_wave
     bcs::Grid grid_bcs;
     bcs::Object object_bcs;
 
-    gradient grad;
-
     real3 center; // center of the circular wave
     real radius;
 
-    // Wave speed coefficients (3 spatial components x {D, Rx, Ry, Rz})
-    std::vector<real> gG_xd, gG_xrx, gG_xry, gG_xrz;
-    std::vector<real> gG_yd, gG_yrx, gG_yry, gG_yrz;
-    std::vector<real> gG_zd, gG_zrx, gG_zry, gG_zrz;
-    // Gradient scratch (3 spatial components x {D, Rx, Ry, Rz})
-    std::vector<real> du_xd, du_xrx, du_xry, du_xrz;
-    std::vector<real> du_yd, du_yrx, du_yry, du_yrz;
-    std::vector<real> du_zd, du_zrx, du_zry, du_zrz;
+    // rhs = gG . grad(u) with the wave speed coefficients gG folded in
+    advection adv;
+    // Dirichlet values of one plane or R space at a time, see update_boundary
+    std::vector<real> dirichlet;
 
     std::vector<real> error_d, error_rx, error_ry, error_rz;
+    // the exact solution at the last time stats, write or initialize asked for
+    mutable detail::mms_field_cache exact;
 
     real max_error;
 
     logs logger;
     std::vector<std::string> io_names = {"U", "Error"};
 
-    // Pre-built graph for submit_rhs_graph().
-    std::optional<Kokkos::Experimental::Graph<execution_space>> rhs_graph_;
+    // Pre-built graphs for submit_rhs_graph(), one per (u, du) binding
+    detail::rhs_graphs rhs_graphs_;
+
+    // the exact solution at `time` on every mesh location, evaluated through `exact`
+    scalar_view exact_at(real time) const;
 
 public:
     scalar_wave() = default;
@@ -54,7 +55,8 @@ public:
                 real3 center,
                 real radius,
                 real max_error = 100.0,
-                const logs& = {});
+                const logs& = {},
+                const operator_cache& = {});
 
     bool valid(const system_stats&) const;
 
@@ -68,8 +70,13 @@ public:
 
     void rhs(const sim_registry& reg, field_ref input,
              sim_registry& out_reg, field_ref output, real time);
-    void build_rhs_graph(scalar_view u, scalar_span du);
-    void submit_rhs_graph();
+    // With a stage, the graph also applies that rk stage update once du is done.
+    void build_rhs_graph(scalar_view u,
+                         scalar_span du,
+                         const detail::stage_update* stage = nullptr);
+    void submit_rhs_graph(scalar_view u,
+                          scalar_span du,
+                          const detail::stage_update* stage = nullptr);
     void update_boundary(sim_registry& reg, field_ref ref, real time);
     real timestep_size(const sim_registry& reg, field_ref ref,
                        const step_controller&) const;
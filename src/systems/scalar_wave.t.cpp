@@ -155,7 +155,7 @@ TEST_CASE("scalar_wave - update_boundary")
 }
 
 // Uses the E2 setup with Dirichlet + Neumann grid BCs and a Dirichlet object,
-// exercising all graph branches: gradient, dot product with wave speed coefficients.
+// exercising the fused advection nodes with the wave speed coefficients.
 TEST_CASE("scalar_wave - graph matches eager")
 {
     sol::state lua;
@@ -231,7 +231,7 @@ TEST_CASE("scalar_wave - graph matches eager")
     auto du = extract_scalar_span(reg, rhs2_ref, sh);
 
     sw.build_rhs_graph(u, du);
-    sw.submit_rhs_graph();
+    sw.submit_rhs_graph(u, du);
 
     // Compare all 4 buffers
     for (int i = 0; i < sz.d_size; ++i) {
@@ -259,7 +259,7 @@ TEST_CASE("scalar_wave - graph matches eager")
         std::ranges::fill(du.Ry, 0.0);
         std::ranges::fill(du.Rz, 0.0);
 
-        sw.submit_rhs_graph();
+        sw.submit_rhs_graph(u, du);
 
         for (int i = 0; i < sz.d_size; ++i) {
             INFO("D[" << i << "] resubmit");
@@ -3,6 +3,8 @@
 #include <sol/sol.hpp>
 #include <spdlog/spdlog.h>
 
+#include <cassert>
+
 namespace ccs
 {
 
@@ -58,16 +60,60 @@ void system::submit_rhs_graph(const sim_registry& creg, field_ref input,
                               sim_registry& reg, field_ref output, real time)
 {
     std::visit([&](auto&& s) {
-        if constexpr (requires { s.submit_rhs_graph(); }) {
+        if constexpr (requires {
+            s.submit_rhs_graph(std::declval<scalar_view>(),
+                               std::declval<scalar_span>());
+        }) {
+            constexpr auto sh = scalar_handle{0};
             if constexpr (requires { s.fill_source(time); })
                 s.fill_source(time);
-            s.submit_rhs_graph();
+            s.submit_rhs_graph(extract_scalar_view(creg, input, sh),
+                               extract_scalar_span(reg, output, sh));
         } else {
             s.rhs(creg, input, reg, output, time);
         }
     }, v);
 }
 
+bool system::has_rhs_graph() const
+{
+    return std::visit([](auto&& s) {
+        using S = std::remove_cvref_t<decltype(s)>;
+        return requires(S& m) {
+            m.submit_rhs_graph(std::declval<scalar_view>(),
+                               std::declval<scalar_span>());
+        };
+    }, v);
+}
+
+void system::submit_stage_graph(const sim_registry& creg, field_ref input,
+                                sim_registry& reg, field_ref output,
+                                const rk_stage& stage, real time)
+{
+    std::visit([&](auto&& s) {
+        if constexpr (requires {
+            s.submit_rhs_graph(std::declval<scalar_view>(),
+                               std::declval<scalar_span>(),
+                               std::declval<const systems::detail::stage_update*>());
+        }) {
+            constexpr auto sh = scalar_handle{0};
+            const auto update =
+                systems::detail::stage_update{extract_scalar_span(reg, stage.acc, sh),
+                                              extract_scalar_view(creg, stage.base, sh),
+                                              extract_scalar_span(reg, stage.out, sh),
+                                              stage.kind,
+                                              stage.c};
+            if constexpr (requires { s.fill_source(time); })
+                s.fill_source(time);
+            s.submit_rhs_graph(extract_scalar_view(creg, input, sh),
+                               extract_scalar_span(reg, output, sh),
+                               &update);
+        } else {
+            assert(false && "submit_stage_graph requires has_rhs_graph()");
+        }
+    }, v);
+}
+
 void system::update_boundary(sim_registry& reg, field_ref ref, real time)
 {
     std::visit([&](auto&& s) { s.update_boundary(reg, ref, time); }, v);
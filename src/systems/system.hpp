@@ -12,11 +12,22 @@
 #include "temporal/step_controller.hpp"
 #include "types.hpp"
 #include <sol/forward.hpp>
+#include <array>
 #include <variant>
 
 namespace ccs
 {
 
+// An rk stage update for submit_stage_graph, on registry slots: acc, base and out
+// are the slots of systems::detail::stage_update.
+struct rk_stage {
+    field_ref acc;
+    field_ref base;
+    field_ref out;
+    systems::detail::stage_kind kind;
+    std::array<real, 2> c;
+};
+
 // Variant wrapper over concrete PDE systems.
 // All field operations use sim_registry + field_ref (registry-based API).
 class system
@@ -50,10 +61,20 @@ public:
     // Registry-based dispatch methods
     void rhs(const sim_registry& creg, field_ref input,
              sim_registry& reg, field_ref output, real time);
+    // Graph-capable systems keep one rhs graph per (input, output) binding:
+    // build_rhs_graph builds it ahead of time and submit_rhs_graph builds it on first
+    // use.  Other systems build nothing and submit_rhs_graph calls rhs.
     void build_rhs_graph(const sim_registry& creg, field_ref input,
                          sim_registry& reg, field_ref output);
     void submit_rhs_graph(const sim_registry& creg, field_ref input,
                           sim_registry& reg, field_ref output, real time);
+    // true when submit_rhs_graph runs a graph, so submit_stage_graph is available
+    bool has_rhs_graph() const;
+    // The rhs graph for (input, output) extended by `stage`, built on first use.
+    // Requires has_rhs_graph().
+    void submit_stage_graph(const sim_registry& creg, field_ref input,
+                            sim_registry& reg, field_ref output,
+                            const rk_stage& stage, real time);
     void update_boundary(sim_registry& reg, field_ref ref, real time);
     system_stats stats(const sim_registry& reg, field_ref u0,
                        field_ref u1, const step_controller&) const;
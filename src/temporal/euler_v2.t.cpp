@@ -127,9 +127,9 @@ TEST_CASE("euler registry-based step")
     // Get timestep
     const real dt = *sys.timestep_size(reg, u0_ref, step);
 
-    // Build RHS graph: bind to (u1_ref, srhs_ref) matching the production
-    // convention in simulation_cycle. Euler deep-copies u0→u1 before submit.
-    sys.build_rhs_graph(reg, u1_ref, reg, srhs_ref);
+    // Build the RHS graph for (u0_ref, srhs_ref): euler evaluates the rhs of u0
+    // directly, as in simulation_cycle.
+    sys.build_rhs_graph(reg, u0_ref, reg, srhs_ref);
 
     // Perform one euler step using the registry-based interface
     integrators::euler euler_integrator;
@@ -18,12 +18,30 @@ void integrator::operator()(system& sys, sim_registry& reg,
                 integ(sys, reg, u0, output, scratch1, scratch2, ctrl, dt);
             } else if constexpr (std::is_same_v<T, integrators::euler>) {
                 integ(sys, reg, u0, output, scratch2, ctrl, dt);
+            } else if constexpr (std::is_same_v<T, integrators::lsrk>) {
+                if (output.slot != u0.slot) reg.deep_copy_slot(output.slot, u0.slot);
+                integ(sys, reg, output, scratch1, scratch2, ctrl, dt);
             }
             // integrators::empty: no-op
         },
         v);
 }
 
+integrator_slots integrator::slots() const
+{
+    return std::visit(
+        [](auto&& integ) {
+            using T = std::decay_t<decltype(integ)>;
+            if constexpr (std::is_same_v<T, integrators::rk4>)
+                return integrator_slots{.accumulator = true};
+            else if constexpr (std::is_same_v<T, integrators::lsrk>)
+                return integrator_slots{.in_place = true, .accumulator = true};
+            else
+                return integrator_slots{};
+        },
+        v);
+}
+
 std::optional<integrator> integrator::from_lua(const sol::table& tbl, const logs& logger)
 {
 
@@ -37,13 +55,23 @@ std::optional<integrator> integrator::from_lua(const sol::table& tbl, const logs
     auto type = m["type"].get_or(std::string{});
 
     if (type == "rk4") {
-        logger(spdlog::level::info, "building rk4 integrator");
-        return integrator{integrators::rk4{}};
+        // integrator.fused_stages runs each stage as a single graph submission
+        const bool fused = m["fused_stages"].get_or(false);
+        logger(spdlog::level::info, "building rk4 integrator (fused stages: {})", fused);
+        return integrator{integrators::rk4{fused}};
     } else if (type == "euler") {
         logger(spdlog::level::info, "building euler integrator");
         return integrator{integrators::euler{}};
+    } else if (type == "lsrk3") {
+        logger(spdlog::level::info, "building low-storage rk3 integrator");
+        return integrator{integrators::lsrk{integrators::lsrk::scheme::williamson3}};
+    } else if (type == "lsrk54") {
+        logger(spdlog::level::info, "building low-storage rk(5,4) integrator");
+        return integrator{
+            integrators::lsrk{integrators::lsrk::scheme::carpenter_kennedy54}};
     } else {
-        logger(spdlog::level::err, "integrator.type must be one of: [rk4, euler]");
+        logger(spdlog::level::err,
+               "integrator.type must be one of: [rk4, euler, lsrk3, lsrk54]");
         return std::nullopt;
     }
 }
@@ -7,6 +7,7 @@
 #include "empty_integrator.hpp"
 #include "euler.hpp"
 #include "io/logging.hpp"
+#include "lsrk.hpp"
 #include "rk4.hpp"
 #include "types.hpp"
 
@@ -15,9 +16,22 @@ namespace ccs
 // forward decl
 class system;
 
+// The registry slots an integrator steps with, besides u0 and the system rhs.
+// simulation_cycle allocates only these.
+struct integrator_slots {
+    // the new solution overwrites u0, so output is u0 and needs no slot of its own
+    bool in_place = false;
+    // a register accumulating across stages (rk4's rk_rhs, the 2N register du)
+    bool accumulator = false;
+
+    // total number of slots, u0 and the system rhs included
+    int count() const { return 2 + !in_place + accumulator; }
+};
+
 class integrator
 {
-    std::variant<integrators::empty, integrators::rk4, integrators::euler> v;
+    std::variant<integrators::empty, integrators::rk4, integrators::euler, integrators::lsrk>
+        v;
     using v_t = decltype(v);
 
 public:
@@ -27,11 +41,16 @@ public:
         requires(std::constructible_from<v_t, T>)
     integrator(T&& t) : v{FWD(t)} {}
 
+    // scratch1 is the accumulator, the empty field_ref{} when slots().accumulator is
+    // false, and scratch2 the system rhs.  In-place integrators copy u0 into output
+    // first unless output is u0.
     void operator()(system& sys, sim_registry& reg,
                     field_ref u0, field_ref output,
                     field_ref scratch1, field_ref scratch2,
                     const step_controller& ctrl, real dt);
 
+    integrator_slots slots() const;
+
     static std::optional<integrator> from_lua(const sol::table&, const logs& = {});
 };
 
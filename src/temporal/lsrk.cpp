@@ -0,0 +1,72 @@
+#include "lsrk.hpp"
+#include "slot_ops.hpp"
+#include "step_controller.hpp"
+#include "systems/system.hpp"
+
+#include <Kokkos_Profiling_ScopedRegion.hpp>
+
+#include <array>
+#include <span>
+
+namespace ccs::integrators
+{
+
+namespace
+{
+struct coefficients {
+    std::span<const real> a, b, c;
+};
+
+constexpr std::array w3_a{0.0, -5.0 / 9.0, -153.0 / 128.0};
+constexpr std::array w3_b{1.0 / 3.0, 15.0 / 16.0, 8.0 / 15.0};
+constexpr std::array w3_c{0.0, 1.0 / 3.0, 3.0 / 4.0};
+
+constexpr std::array ck54_a{0.0,
+                            -567301805773.0 / 1357537059087.0,
+                            -2404267990393.0 / 2016746695238.0,
+                            -3550918686646.0 / 2091501179385.0,
+                            -1275806237668.0 / 842570457699.0};
+constexpr std::array ck54_b{1432997174477.0 / 9575080441755.0,
+                            5161836677717.0 / 13612068292357.0,
+                            1720146321549.0 / 2090206949498.0,
+                            3134564353537.0 / 4481467310338.0,
+                            2277821191437.0 / 14882151754819.0};
+constexpr std::array ck54_c{0.0,
+                            1432997174477.0 / 9575080441755.0,
+                            2526269341429.0 / 6820363962896.0,
+                            2006345519317.0 / 3224310063776.0,
+                            2802321613138.0 / 2924317926251.0};
+
+coefficients table(lsrk::scheme s)
+{
+    switch (s) {
+    case lsrk::scheme::williamson3:
+        return {w3_a, w3_b, w3_c};
+    case lsrk::scheme::carpenter_kennedy54:
+        break;
+    }
+    return {ck54_a, ck54_b, ck54_c};
+}
+} // namespace
+
+void lsrk::operator()(system& sys, sim_registry& reg,
+                      field_ref u, field_ref du_ref, field_ref system_rhs_ref,
+                      const step_controller& ctrl, real dt)
+{
+    Kokkos::Profiling::ScopedRegion step_region("lsrk::step");
+    const auto [a, b, c] = table(s);
+    const real time = ctrl;
+    const auto stages = static_cast<int>(a.size());
+
+    // a[0] == 0, so the first stage assigns du and no zeroing is needed.  u is both
+    // the stage input and the solution, so the rhs graph of u serves every stage.
+    for (int i = 0; i < stages; ++i) {
+        sys.submit_rhs_graph(reg, u, reg, system_rhs_ref, time + dt * c[i]);
+        slot_scale_accumulate(reg, du_ref, a[i], dt, system_rhs_ref);
+        slot_accumulate(reg, u, b[i], du_ref);
+        sys.update_boundary(reg, u, i + 1 < stages ? time + dt * c[i + 1] : time + dt);
+    }
+    Kokkos::fence("lsrk::step complete");
+}
+
+} // namespace ccs::integrators
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "fields/field_registry.hpp"
+
+namespace ccs
+{
+// Forward decls
+class system;
+class step_controller;
+
+namespace integrators
+{
+
+// Low-storage (2N) explicit Runge-Kutta in Williamson's form.  Each stage is
+//     du = a[i] du + dt rhs(u, t + c[i] dt)
+//     u  = u + b[i] du
+// so the solution is advanced in place and du is the only other register besides
+// the system rhs.
+class lsrk
+{
+public:
+    enum class scheme {
+        williamson3,        // 3 stages, 3rd order (Williamson 1980)
+        carpenter_kennedy54 // 5 stages, 4th order (Carpenter & Kennedy 1994)
+    };
+
+private:
+    scheme s = scheme::carpenter_kennedy54;
+
+public:
+    lsrk() = default;
+    explicit lsrk(scheme s) : s{s} {}
+
+    void operator()(system& sys, sim_registry& reg,
+                    field_ref u, field_ref du_ref, field_ref system_rhs_ref,
+                    const step_controller& ctrl, real dt);
+};
+} // namespace integrators
+} // namespace ccs
@@ -0,0 +1,230 @@
+#include <Kokkos_Core.hpp>
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <sol/sol.hpp>
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+#include "integrator.hpp"
+#include "step_controller.hpp"
+#include "systems/system.hpp"
+
+using namespace ccs;
+
+// ---------------------------------------------------------------------------
+// Custom main: Kokkos must be initialized before any test allocates Views.
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    return Catch::Session().run(argc, argv);
+}
+
+// ---------------------------------------------------------------------------
+// Registry-based low-storage rk integration test using the heat system.
+// Mirrors rk4_v2.t.cpp with the solution advanced in place.
+// ---------------------------------------------------------------------------
+
+TEST_CASE("lsrk registry-based step")
+{
+    sol::state lua;
+    lua.open_libraries(sol::lib::base, sol::lib::math);
+    lua.script(R"(
+        simulation = {
+            mesh = {
+                index_extents = {21, 22, 23},
+                domain_bounds = {
+                    min = {1, 1.1, 0.3},
+                    max = {3, 3.3, 2.2}
+                }
+            },
+            domain_boundaries = {
+                xmin = "dirichlet",
+                ymin = "neumann",
+                ymax = "neumann",
+                zmax = "dirichlet"
+            },
+            shapes = {
+                {
+                    type = "sphere",
+                    center = {2.0001, 2.5656565, 1.313131311},
+                    radius = 0.25,
+                    boundary_condition = "dirichlet"
+                }
+            },
+            scheme = {
+                order = 2,
+                type = "E2"
+            },
+            system = {
+                type = "heat",
+                diffusivity = 1.0
+            },
+            integrator = {
+                type = "lsrk54",
+            },
+            step_controller = {
+                max_step = 1,
+            },
+            manufactured_solution = {
+                type = "lua",
+                call = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return (time +
+                        x * x * (y + z) + y * y * (x + z) + z * z * (x + y) +
+                        3 * x * y * z + x + y + z)
+                end,
+                ddt = function(time, loc)
+                    return 1.0
+                end,
+                grad = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return 2. * x * (y + z) + y * y + z * z + 3. * y * z + 1,
+                            x * x + 2. * y * (x + z) + z * z + 3. * x * z + 1,
+                            x * x + y * y + 2. * z * (x + y) + 3. * x * y + 1
+                end,
+                lap = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return 2. * (y + z) + 2. * (x + z) + 2. * (x + y)
+                end,
+                div = function(time, loc)
+                    return 0.0
+                end
+            }
+        }
+    )");
+
+    auto sys_opt = system::from_lua(lua["simulation"]);
+    REQUIRE(!!sys_opt);
+    auto& sys = *sys_opt;
+
+    auto st_opt = step_controller::from_lua(lua["simulation"]);
+    REQUIRE(!!st_opt);
+    auto& step = *st_opt;
+
+    // Set up registry with 3 slots: u(0), du(1), system_rhs(2)
+    sim_registry reg;
+    auto sz = sys.size();
+    auto [u_ref, du_ref, srhs_ref] = reg.allocate_arena(std::array{0, 1, 2}, sz);
+
+    // Initialize u with the system's initial condition
+    sys.initialize(reg, u_ref, step);
+    sys.update_boundary(reg, u_ref, step);
+
+    // Get timestep
+    const real dt = *sys.timestep_size(reg, u_ref, step);
+
+    // Every stage reads u, which is also the solution
+    sys.build_rhs_graph(reg, u_ref, reg, srhs_ref);
+
+    // Perform one step of each scheme in place
+    const auto scheme = GENERATE(integrators::lsrk::scheme::williamson3,
+                                 integrators::lsrk::scheme::carpenter_kennedy54);
+    integrators::lsrk lsrk_integrator{scheme};
+    lsrk_integrator(sys, reg, u_ref, du_ref, srhs_ref, step, dt);
+
+    step.advance(dt);
+
+    // At this point, all fluid points in u should match the manufactured solution
+    auto stats = sys.stats(reg, u_ref, u_ref, step);
+    REQUIRE_THAT(stats.stats[0], Catch::Matchers::WithinAbs(0.0, 1e-13));
+}
+
+// ---------------------------------------------------------------------------
+// Convergence order on a solution exponential in time.  u = exp(lambda t) g with g
+// quadratic, so the E2 laplacian is exact and the error is the time error alone.
+// The diffusion couples the stages (u' = D lap u + f(t)), so this checks the full
+// order conditions and not just the quadrature.  Floating boundaries leave no
+// boundary data to impose.
+// ---------------------------------------------------------------------------
+
+TEST_CASE("lsrk convergence order")
+{
+    sol::state lua;
+    lua.open_libraries(sol::lib::base, sol::lib::math);
+    lua.script(R"(
+        lambda = 2.0
+        simulation = {
+            mesh = {
+                index_extents = {11, 11, 11},
+                domain_bounds = {
+                    min = {0, 0, 0},
+                    max = {1, 1, 1}
+                }
+            },
+            scheme = {
+                order = 2,
+                type = "E2"
+            },
+            system = {
+                type = "heat",
+                diffusivity = 0.01
+            },
+            step_controller = {
+                max_time = 0.5,
+            },
+            manufactured_solution = {
+                type = "lua",
+                call = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return math.exp(lambda * time) * (1 + x * x + y * y + z * z)
+                end,
+                ddt = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    return lambda * math.exp(lambda * time) * (1 + x * x + y * y + z * z)
+                end,
+                grad = function(time, loc)
+                    local x, y, z = loc[1], loc[2], loc[3]
+                    local e = math.exp(lambda * time)
+                    return 2 * x * e, 2 * y * e, 2 * z * e
+                end,
+                lap = function(time, loc)
+                    return 6 * math.exp(lambda * time)
+                end,
+                div = function(time, loc)
+                    return 0.0
+                end
+            }
+        }
+    )");
+
+    auto sys_opt = system::from_lua(lua["simulation"]);
+    REQUIRE(!!sys_opt);
+    auto& sys = *sys_opt;
+
+    sim_registry reg;
+    auto [u_ref, du_ref, srhs_ref] = reg.allocate_arena(std::array{0, 1, 2}, sys.size());
+    sys.build_rhs_graph(reg, u_ref, reg, srhs_ref);
+
+    constexpr real t_end = 0.5;
+    const auto [scheme, order] =
+        GENERATE(std::pair{integrators::lsrk::scheme::williamson3, 3},
+                 std::pair{integrators::lsrk::scheme::carpenter_kennedy54, 4});
+    integrators::lsrk lsrk_integrator{scheme};
+
+    // Linf error against the exact solution at t_end
+    auto error = [&](int steps) {
+        auto step = *step_controller::from_lua(lua["simulation"]);
+        sys.initialize(reg, u_ref, step);
+        sys.update_boundary(reg, u_ref, step);
+
+        const real dt = t_end / steps;
+        for (int i = 0; i < steps; ++i) {
+            lsrk_integrator(sys, reg, u_ref, du_ref, srhs_ref, step, dt);
+            step.advance(dt);
+        }
+        return sys.stats(reg, u_ref, u_ref, step).stats[0];
+    };
+
+    const real coarse = error(10);
+    const real fine = error(20);
+    const real observed = std::log2(coarse / fine);
+    CAPTURE(order, coarse, fine, observed);
+    REQUIRE(observed > order - 0.2);
+}
@@ -13,8 +13,12 @@ namespace integrators
 
 class rk4
 {
+    // run each stage as one graph: the rhs followed by the stage update
+    bool fused_stages = false;
+
 public:
     rk4() = default;
+    explicit rk4(bool fused_stages) : fused_stages{fused_stages} {}
 
     void operator()(system& sys, sim_registry& reg,
                     field_ref u0, field_ref output,
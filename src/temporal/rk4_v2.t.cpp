@@ -1,6 +1,7 @@
 #include <Kokkos_Core.hpp>
 #include <catch2/catch_session.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
 #include <sol/sol.hpp>
@@ -128,11 +129,14 @@ TEST_CASE("rk4 registry-based step")
     // Get timestep
     const real dt = *sys.timestep_size(reg, u0_ref, step);
 
-    // Build RHS graph (u1 is the RHS input slot, srhs is the RHS output slot)
+    // Build the RHS graphs: the first stage reads u0 and the others u1, all into srhs
+    sys.build_rhs_graph(reg, u0_ref, reg, srhs_ref);
     sys.build_rhs_graph(reg, u1_ref, reg, srhs_ref);
 
-    // Perform one rk4 step using the registry-based interface
-    integrators::rk4 rk4_integrator;
+    // Perform one rk4 step using the registry-based interface, with the stage
+    // updates as separate kernels and fused into the rhs graphs
+    const bool fused_stages = GENERATE(false, true);
+    integrators::rk4 rk4_integrator{fused_stages};
     rk4_integrator(sys, reg, u0_ref, u1_ref, rk_ref, srhs_ref, step, dt);
 
     step.advance(dt);
@@ -2,60 +2,180 @@
 
 #include "fields/field_registry.hpp"
 
+#include <array>
 #include <cassert>
+#include <cstddef>
+
+//
+// Element-wise slot kernels for the integrators.
+//
+// Each operation is one parallel_for over every allocated buffer of the slots it
+// touches (all scalar and vector fields).  When all of them are arena slots of the
+// same layout the kernel sweeps the contiguous slot_arena ranges, padding included
+// (the padding is zero and stays zero).  Otherwise it walks a table of the slot's
+// buffers, split into fixed-size chunks of the concatenated index space.
+//
+// The kernels do not fence.  They run in order on execution_space, so later kernels
+// see their results; a caller that reads the data on the host, or hands it to code
+// that does, fences first.  The integrators fence once at the end of a step.
+//
 
 namespace ccs
 {
 
+namespace detail
+{
+
+// Data pointers of every allocated buffer of K slots of the same shape.  Buffer b
+// covers [offset[b], offset[b + 1]) of the concatenated index space.
+template <std::size_t K>
+struct slot_table {
+    static constexpr int capacity = sim_registry::buffers_per_slot;
+    // elements per parallel_for iteration on the table path
+    static constexpr integer chunk = 1024;
+
+    int n_buffers = 0;
+    std::array<integer, capacity + 1> offset{};
+    std::array<std::array<real*, capacity>, K> data{};
+
+    integer size() const { return offset[n_buffers]; }
+};
+
+template <std::size_t K>
+slot_table<K> make_slot_table(sim_registry& reg, const std::array<field_ref, K>& refs)
+{
+    using layout = sim_registry::layout_type;
+    const field_ref shape = refs[0];
+    slot_table<K> t{};
+
+    auto add = [&](buf_handle bh) {
+        const int n = reg.size(shape, bh);
+        for (std::size_t k = 0; k < K; ++k) {
+            assert(refs[k].n_scalars == shape.n_scalars &&
+                   refs[k].n_vectors == shape.n_vectors);
+            assert(reg.size(refs[k], bh) == n);
+            t.data[k][t.n_buffers] = reg.data(refs[k], bh);
+        }
+        t.offset[t.n_buffers + 1] = t.offset[t.n_buffers] + n;
+        ++t.n_buffers;
+    };
+
+    for (int s = 0; s < shape.n_scalars; ++s)
+        for (auto bh : scalar_handle{s * layout::scalar_stride}.all()) add(bh);
+    for (int v = 0; v < shape.n_vectors; ++v)
+        for (auto bh : vector_handle{layout::vector_base + v * layout::vector_stride}.all())
+            add(bh);
+
+    return t;
+}
+
+// Apply f(p, i) to every element i of every allocated buffer, where p holds the K
+// slots' pointers to the same buffer.  One kernel launch.
+template <std::size_t K, typename F>
+void for_each_slot_element(sim_registry& reg,
+                           const std::array<field_ref, K>& refs,
+                           const char* label,
+                           F f)
+{
+    if (refs[0].n_scalars == 0 && refs[0].n_vectors == 0) return;
+
+    // Arena fast path: identical contiguous layouts, one flat range.  Every field of
+    // an arena slot has the same buffer sizes, so comparing the first field's buffers
+    // and the slot extents is enough.
+    using layout = sim_registry::layout_type;
+    const auto first_field = refs[0].n_scalars > 0
+                           ? scalar_handle{0}
+                           : vector_handle{layout::vector_base}.x();
+    const integer n = reg.slot_arena(refs[0]).extent(0);
+    bool arenas = n > 0;
+    for (auto ref : refs) {
+        arenas = arenas && static_cast<integer>(reg.slot_arena(ref).extent(0)) == n &&
+                 ref.n_scalars == refs[0].n_scalars &&
+                 ref.n_vectors == refs[0].n_vectors;
+        for (auto bh : first_field.all())
+            arenas = arenas && reg.size(ref, bh) == reg.size(refs[0], bh);
+    }
+
+    if (arenas) {
+        std::array<real*, K> p;
+        for (std::size_t k = 0; k < K; ++k) p[k] = reg.slot_arena(refs[k]).data();
+        Kokkos::parallel_for(label,
+                             Kokkos::RangePolicy<execution_space>(0, n),
+                             KOKKOS_LAMBDA(integer i) { f(p, i); });
+        return;
+    }
+
+    // Table path: each iteration handles one chunk of the concatenated buffers,
+    // looking up its first buffer once and then running plain inner loops.
+    const auto t = make_slot_table(reg, refs);
+    constexpr integer chunk = slot_table<K>::chunk;
+    const integer total = t.size();
+    const integer n_chunks = (total + chunk - 1) / chunk;
+
+    Kokkos::parallel_for(
+        label,
+        Kokkos::RangePolicy<execution_space>(0, n_chunks),
+        KOKKOS_LAMBDA(integer c) {
+            integer lo = c * chunk;
+            const integer hi = lo + chunk < total ? lo + chunk : total;
+            int b = 0;
+            while (t.offset[b + 1] <= lo) ++b;
+            while (lo < hi) {
+                const integer first = t.offset[b];
+                const integer last = t.offset[b + 1] < hi ? t.offset[b + 1] : hi;
+                std::array<real*, K> p;
+                for (std::size_t k = 0; k < K; ++k) p[k] = t.data[k][b];
+                for (integer i = lo - first; i < last - first; ++i) f(p, i);
+                lo = last;
+                ++b;
+            }
+        });
+}
+
+} // namespace detail
+
 // Zero all allocated buffers in a slot.
 inline void slot_zero(sim_registry& reg, field_ref ref)
 {
-    assert(ref.n_vectors == 0 && "slot_ops: vector support not yet implemented");
-    for (int s = 0; s < ref.n_scalars; ++s) {
-        scalar_handle sh{s * sim_registry::layout_type::scalar_stride};
-        for (auto bh : sh.all())
-            Kokkos::deep_copy(reg.view(ref, bh), 0.0);
-    }
-    Kokkos::fence();
+    detail::for_each_slot_element(
+        reg, std::array{ref}, "slot_zero", [](const auto& p, integer i) {
+            p[0][i] = 0.0;
+        });
 }
 
 // dst[i] = src[i] + coeff * rhs[i]  for all allocated buffers.
 inline void slot_assign_lc(sim_registry& reg, field_ref dst,
                             field_ref src, real coeff, field_ref rhs)
 {
-    assert(dst.n_vectors == 0 && "slot_ops: vector support not yet implemented");
-    for (int s = 0; s < dst.n_scalars; ++s) {
-        scalar_handle sh{s * sim_registry::layout_type::scalar_stride};
-        for (auto bh : sh.all()) {
-            int n = reg.size(dst, bh);
-            real* d = reg.data(dst, bh);
-            const real* s0 = reg.data(src, bh);
-            const real* r = reg.data(rhs, bh);
-            Kokkos::parallel_for(
-                Kokkos::RangePolicy<execution_space>(0, n),
-                KOKKOS_LAMBDA(int i) { d[i] = s0[i] + coeff * r[i]; });
-        }
-    }
-    Kokkos::fence();
+    detail::for_each_slot_element(
+        reg, std::array{dst, src, rhs}, "slot_assign_lc",
+        [coeff](const auto& p, integer i) { p[0][i] = p[1][i] + coeff * p[2][i]; });
 }
 
 // dst[i] += coeff * src[i]  for all allocated buffers.
 inline void slot_accumulate(sim_registry& reg, field_ref dst,
                              real coeff, field_ref src)
 {
-    assert(dst.n_vectors == 0 && "slot_ops: vector support not yet implemented");
-    for (int s = 0; s < dst.n_scalars; ++s) {
-        scalar_handle sh{s * sim_registry::layout_type::scalar_stride};
-        for (auto bh : sh.all()) {
-            int n = reg.size(dst, bh);
-            real* d = reg.data(dst, bh);
-            const real* r = reg.data(src, bh);
-            Kokkos::parallel_for(
-                Kokkos::RangePolicy<execution_space>(0, n),
-                KOKKOS_LAMBDA(int i) { d[i] += coeff * r[i]; });
-        }
-    }
-    Kokkos::fence();
+    detail::for_each_slot_element(
+        reg, std::array{dst, src}, "slot_accumulate",
+        [coeff](const auto& p, integer i) { p[0][i] += coeff * p[1][i]; });
+}
+
+// dst[i] = a * dst[i] + coeff * src[i]  for all allocated buffers.  With a == 0 dst
+// is only written, as the first stage of a low-storage scheme needs.
+inline void slot_scale_accumulate(sim_registry& reg, field_ref dst, real a,
+                                  real coeff, field_ref src)
+{
+    if (a == 0.0)
+        detail::for_each_slot_element(
+            reg, std::array{dst, src}, "slot_scale_accumulate",
+            [coeff](const auto& p, integer i) { p[0][i] = coeff * p[1][i]; });
+    else
+        detail::for_each_slot_element(
+            reg, std::array{dst, src}, "slot_scale_accumulate",
+            [a, coeff](const auto& p, integer i) {
+                p[0][i] = a * p[0][i] + coeff * p[1][i];
+            });
 }
 
 } // namespace ccs
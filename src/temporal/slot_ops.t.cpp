@@ -0,0 +1,122 @@
+#include <Kokkos_Core.hpp>
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+
+#include "slot_ops.hpp"
+
+using namespace ccs;
+
+int main(int argc, char* argv[])
+{
+    Kokkos::ScopeGuard kokkos(argc, argv);
+    return Catch::Session().run(argc, argv);
+}
+
+using layout = sim_registry::layout_type;
+
+// sizes straddle the 1024-element chunks of the table path
+constexpr auto sz = system_size{.nscalars = 2,
+                                .nvectors = 1,
+                                .d_size = 1500,
+                                .rx_size = 7,
+                                .ry_size = 0,
+                                .rz_size = 1030};
+
+// every allocated buffer of a slot shaped like sz
+static std::array<buf_handle, 20> buffers()
+{
+    std::array<buf_handle, 20> h{};
+    int k = 0;
+    for (int s = 0; s < sz.nscalars; ++s)
+        for (auto bh : scalar_handle{s * layout::scalar_stride}.all()) h[k++] = bh;
+    for (auto bh : vector_handle{layout::vector_base}.all()) h[k++] = bh;
+    return h;
+}
+
+static void fill(sim_registry& reg, field_ref ref, real scale)
+{
+    for (auto bh : buffers()) {
+        auto* p = reg.data(ref, bh);
+        for (int i = 0; i < reg.size(ref, bh); ++i) p[i] = scale * (bh.id + 0.001 * i);
+    }
+}
+
+static void run_slot_ops(sim_registry& reg, std::array<field_ref, 3> refs)
+{
+    auto [dst, src, rhs] = refs;
+    fill(reg, dst, 5.0);
+    fill(reg, src, 1.0);
+    fill(reg, rhs, 2.0);
+
+    slot_assign_lc(reg, dst, src, 0.5, rhs);
+    Kokkos::fence();
+    for (auto bh : buffers())
+        for (int i = 0; i < reg.size(dst, bh); ++i)
+            REQUIRE(reg.data(dst, bh)[i] == 2.0 * (bh.id + 0.001 * i));
+
+    slot_accumulate(reg, dst, -1.0, rhs);
+    Kokkos::fence();
+    for (auto bh : buffers())
+        for (int i = 0; i < reg.size(dst, bh); ++i)
+            REQUIRE(reg.data(dst, bh)[i] == 0.0);
+
+    slot_scale_accumulate(reg, dst, 0.0, 3.0, src);
+    Kokkos::fence();
+    for (auto bh : buffers())
+        for (int i = 0; i < reg.size(dst, bh); ++i)
+            REQUIRE(reg.data(dst, bh)[i] == 3.0 * (bh.id + 0.001 * i));
+
+    slot_scale_accumulate(reg, dst, 2.0, -6.0, src);
+    Kokkos::fence();
+    for (auto bh : buffers())
+        for (int i = 0; i < reg.size(dst, bh); ++i)
+            REQUIRE(reg.data(dst, bh)[i] == 0.0);
+
+    fill(reg, dst, 3.0);
+    slot_zero(reg, dst);
+    Kokkos::fence();
+    for (auto bh : buffers())
+        for (int i = 0; i < reg.size(dst, bh); ++i)
+            REQUIRE(reg.data(dst, bh)[i] == 0.0);
+}
+
+TEST_CASE("slot ops cover scalar and vector buffers of arena slots")
+{
+    sim_registry reg;
+    auto [a, b, c] = reg.allocate_arena(std::array{0, 1, 2}, sz);
+    run_slot_ops(reg, {a, b, c});
+}
+
+TEST_CASE("slot ops cover scalar and vector buffers of per-buffer slots")
+{
+    sim_registry reg;
+    field_ref refs[3]{};
+    for (int slot = 0; slot < 3; ++slot) {
+        for (int s = 0; s < sz.nscalars; ++s)
+            refs[slot] =
+                reg.allocate_scalar(slot, s, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+        refs[slot] = reg.allocate_vector(slot, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    }
+    run_slot_ops(reg, {refs[0], refs[1], refs[2]});
+}
+
+TEST_CASE("slot ops mix arena and per-buffer slots")
+{
+    sim_registry reg;
+    auto [a, b] = reg.allocate_arena(std::array{0, 1}, sz);
+    field_ref c{2};
+    for (int s = 0; s < sz.nscalars; ++s)
+        c = reg.allocate_scalar(2, s, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    c = reg.allocate_vector(2, 0, sz.d_size, sz.rx_size, sz.ry_size, sz.rz_size);
+    run_slot_ops(reg, {a, b, c});
+}
+
+TEST_CASE("slot ops no-op on empty slots")
+{
+    sim_registry reg;
+    slot_zero(reg, field_ref{0});
+    slot_assign_lc(reg, field_ref{0}, field_ref{1}, 1.0, field_ref{2});
+    slot_accumulate(reg, field_ref{0}, 1.0, field_ref{1});
+}